@@ -0,0 +1,522 @@
+/*
+ * microbench.c -- EPCC-style synchronization overhead microbenchmarks.
+ */
+
+//===----------------------------------------------------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is dual licensed under the MIT and the University of Illinois Open
+// Source Licenses. See LICENSE.txt for details.
+//
+//===----------------------------------------------------------------------===//
+
+/*
+ * Every benchmark runs a construct inner_reps times around a short delay and
+ * subtracts the time the delays alone take on the critical path, so what is
+ * left is the overhead of one construct instance. This is repeated outer_reps
+ * times for each team size; the delays alone are timed again right before
+ * every sample and subtracted from that sample, so drifting clock rates do
+ * not show up as overhead. Each (benchmark, variant, team size) prints one
+ * CSV line with the overhead and, next to it, the raw time per instance and
+ * the reference time of its delays.
+ *
+ * Settings that the runtime only reads at initialization (barrier patterns,
+ * lock kind, forced reduction method, ...) are not varied here; the driver
+ * script run-microbench.py re-runs this binary under each of them.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+
+// Definitions copied from the OpenMP RTL.
+typedef struct {
+  int reserved_1;
+  int flags;
+  int reserved_2;
+  int reserved_3;
+  const char *psource;
+} ident_t;
+typedef int kmp_critical_name[8];
+
+#define KMP_IDENT_KMPC 0x02
+#define KMP_IDENT_ATOMIC_REDUCE 0x10
+
+enum sched_type {
+  kmp_sch_static_chunked = 33,
+  kmp_sch_static = 34,
+  kmp_sch_dynamic_chunked = 35,
+  kmp_sch_guided_chunked = 36,
+  kmp_sch_runtime = 37,
+  kmp_sch_auto = 38,
+  kmp_sch_trapezoidal = 39,
+  kmp_sch_static_greedy = 40,
+  kmp_sch_static_balanced = 41,
+  kmp_sch_guided_iterative_chunked = 42,
+  kmp_sch_guided_analytical_chunked = 43,
+  kmp_sch_static_steal = 44,
+  kmp_sch_static_balanced_chunked = 45,
+  kmp_sch_guided_simd = 46,
+  kmp_sch_runtime_simd = 47
+};
+
+enum { RED_INT32 = 0 };
+enum { RED_SUM = 0 };
+
+extern int __kmpc_global_thread_num(ident_t *);
+extern void __kmpc_dispatch_init_4(ident_t *, int gtid, enum sched_type,
+                                   int lb, int ub, int st, int chunk);
+extern int __kmpc_dispatch_next_4(ident_t *, int gtid, int *last, int *lb,
+                                  int *ub, int *st);
+extern int __kmpc_reduce(ident_t *, int gtid, int num_vars, size_t size,
+                         void *data, void (*func)(void *, void *),
+                         kmp_critical_name *lck);
+extern void __kmpc_end_reduce(ident_t *, int gtid, kmp_critical_name *lck);
+extern int __kmpc_reduce_nowait(ident_t *, int gtid, int num_vars, size_t size,
+                                void *data, void (*func)(void *, void *),
+                                kmp_critical_name *lck);
+extern void __kmpc_end_reduce_nowait(ident_t *, int gtid,
+                                     kmp_critical_name *lck);
+extern void __kmpc_barrier_reduce(ident_t *, int gtid, int type, int op,
+                                  void *data);
+extern void __kmpc_barrier_arrive(ident_t *, int gtid);
+extern void __kmpc_barrier_wait(ident_t *, int gtid);
+extern void __kmpc_atomic_fixed4_add(ident_t *, int gtid, int *lhs, int rhs);
+extern void __kmpc_atomic_float8_add(ident_t *, int gtid, double *lhs,
+                                     double rhs);
+#if defined(__x86_64__) || defined(__i386__)
+extern void __kmpc_atomic_float10_add(ident_t *, int gtid, long double *lhs,
+                                      long double rhs);
+#endif
+// End of definitions copied from the OpenMP RTL.
+
+static ident_t loc = {0, KMP_IDENT_KMPC | KMP_IDENT_ATOMIC_REDUCE, 0, 0,
+                      ";microbench.c;microbench;0;0;;"};
+
+static int inner_reps = 1000;
+static int outer_reps = 20;
+static int delay_length = 100;
+static int loop_iters = 128; // iterations per thread in the schedule loops
+static int chunk_size = 1;
+static const char *only; // comma separated benchmark names to run
+static void delay(int length) {
+  volatile int a = 0;
+  int i;
+  for (i = 0; i < length; i++)
+    a += i;
+}
+
+typedef void (*bench_fn)(int nthreads, int reps, void *arg);
+
+typedef struct {
+  const char *name;
+  const char *variant;
+  bench_fn fn;
+  void *arg;
+  // Delays on the critical path, per construct instance.
+  double path_delays;
+} bench_t;
+
+static double now(void) { return omp_get_wtime(); }
+
+/* Time the delays of reps construct instances run back to back by one
+   thread, the part of a sample that is not overhead. */
+static double reference_time(const bench_t *b, int reps) {
+  int n = (int)(b->path_delays * reps), i;
+  double start;
+
+  if (!n)
+    return 0.0;
+  start = now();
+  for (i = 0; i < n; i++)
+    delay(delay_length);
+  return now() - start;
+}
+
+static int selected(const char *name) {
+  size_t len = strlen(name);
+  const char *p = only;
+  while (p) {
+    if (!strncmp(p, name, len) && (p[len] == ',' || p[len] == '\0'))
+      return 1;
+    p = strchr(p, ',');
+    if (p)
+      p++;
+  }
+  return 0;
+}
+
+/* Time outer_reps runs of b at team size nthreads and print the overhead of
+   one construct instance as mean, minimum and standard deviation in us,
+   followed by the mean raw time and reference time per instance. Noise can
+   make a sample faster than its reference; its overhead counts as zero. */
+static void run_bench(const bench_t *b, int nthreads) {
+  double sum = 0.0, sum2 = 0.0, min = 1e30, mean, sd;
+  double raw_sum = 0.0, ref_sum = 0.0;
+  int k;
+
+  if (only && !selected(b->name))
+    return;
+  b->fn(nthreads, inner_reps / 10 + 1, b->arg); // warm up the team
+  for (k = 0; k < outer_reps; k++) {
+    double ref = reference_time(b, inner_reps) / inner_reps * 1e6;
+    double start = now(), raw, t;
+    b->fn(nthreads, inner_reps, b->arg);
+    raw = (now() - start) / inner_reps * 1e6;
+    t = raw > ref ? raw - ref : 0.0;
+    raw_sum += raw;
+    ref_sum += ref;
+    sum += t;
+    sum2 += t * t;
+    if (t < min)
+      min = t;
+  }
+  mean = sum / outer_reps;
+  sd = sum2 / outer_reps - mean * mean;
+  sd = sd > 0.0 ? sqrt(sd) : 0.0;
+  printf("%s,%s,%d,%d,%.4f,%.4f,%.4f,%.4f,%.4f\n", b->name, b->variant,
+         nthreads, inner_reps, mean, min, sd, raw_sum / outer_reps,
+         ref_sum / outer_reps);
+  fflush(stdout);
+}
+
+/* Fork/join */
+
+static void bench_parallel(int nthreads, int reps, void *arg) {
+  int j;
+  for (j = 0; j < reps; j++) {
+#pragma omp parallel num_threads(nthreads)
+    delay(delay_length);
+  }
+}
+
+/* Barriers */
+
+static void bench_barrier(int nthreads, int reps, void *arg) {
+#pragma omp parallel num_threads(nthreads)
+  {
+    int j;
+    for (j = 0; j < reps; j++) {
+      delay(delay_length);
+#pragma omp barrier
+    }
+  }
+}
+
+static void bench_split_barrier(int nthreads, int reps, void *arg) {
+#pragma omp parallel num_threads(nthreads)
+  {
+    int gtid = __kmpc_global_thread_num(&loc);
+    int j;
+    for (j = 0; j < reps; j++) {
+      __kmpc_barrier_arrive(&loc, gtid);
+      delay(delay_length);
+      __kmpc_barrier_wait(&loc, gtid);
+    }
+  }
+}
+
+/* Single */
+
+static void bench_single(int nthreads, int reps, void *arg) {
+#pragma omp parallel num_threads(nthreads)
+  {
+    int j;
+    for (j = 0; j < reps; j++) {
+#pragma omp single
+      delay(delay_length);
+    }
+  }
+}
+
+/* Critical and locks: reps instances in total, split over the team. */
+
+static void bench_critical(int nthreads, int reps, void *arg) {
+#pragma omp parallel num_threads(nthreads)
+  {
+    int j, n = reps / omp_get_num_threads();
+    for (j = 0; j < n; j++) {
+#pragma omp critical
+      delay(delay_length);
+    }
+  }
+}
+
+static void bench_lock(int nthreads, int reps, void *arg) {
+  omp_lock_hint_t hint = *(omp_lock_hint_t *)arg;
+  omp_lock_t lock;
+
+  omp_init_lock_with_hint(&lock, hint);
+#pragma omp parallel num_threads(nthreads)
+  {
+    int j, n = reps / omp_get_num_threads();
+    for (j = 0; j < n; j++) {
+      omp_set_lock(&lock);
+      delay(delay_length);
+      omp_unset_lock(&lock);
+    }
+  }
+  omp_destroy_lock(&lock);
+}
+
+static void bench_nest_lock(int nthreads, int reps, void *arg) {
+  omp_nest_lock_t lock;
+
+  omp_init_nest_lock(&lock);
+#pragma omp parallel num_threads(nthreads)
+  {
+    int j, n = reps / omp_get_num_threads();
+    for (j = 0; j < n; j++) {
+      omp_set_nest_lock(&lock);
+      delay(delay_length);
+      omp_unset_nest_lock(&lock);
+    }
+  }
+  omp_destroy_nest_lock(&lock);
+}
+
+/* Atomics: reps updates in total, split over the team, no delays. */
+
+enum { ATOMIC_PRAGMA, ATOMIC_FIXED4, ATOMIC_FLOAT8, ATOMIC_FLOAT10 };
+
+static void bench_atomic(int nthreads, int reps, void *arg) {
+  int kind = *(int *)arg;
+  int ix = 0;
+  double dx = 0.0;
+#if defined(__x86_64__) || defined(__i386__)
+  long double lx = 0.0;
+#endif
+
+#pragma omp parallel num_threads(nthreads)
+  {
+    int gtid = __kmpc_global_thread_num(&loc);
+    int j, n = reps / omp_get_num_threads();
+    switch (kind) {
+    case ATOMIC_PRAGMA:
+      for (j = 0; j < n; j++) {
+#pragma omp atomic
+        ix += 1;
+      }
+      break;
+    case ATOMIC_FIXED4:
+      for (j = 0; j < n; j++)
+        __kmpc_atomic_fixed4_add(&loc, gtid, &ix, 1);
+      break;
+    case ATOMIC_FLOAT8:
+      for (j = 0; j < n; j++)
+        __kmpc_atomic_float8_add(&loc, gtid, &dx, 1.0);
+      break;
+#if defined(__x86_64__) || defined(__i386__)
+    case ATOMIC_FLOAT10:
+      for (j = 0; j < n; j++)
+        __kmpc_atomic_float10_add(&loc, gtid, &lx, 1.0L);
+      break;
+#endif
+    }
+  }
+}
+
+/* Reductions, the way a compiler lowers reduction(+:x). The method
+   __kmpc_reduce picks is controlled by KMP_FORCE_REDUCTION. */
+
+enum { REDUCE_BLOCKING, REDUCE_NOWAIT, REDUCE_FUSED };
+
+static void reduce_sum(void *lhs, void *rhs) { *(int *)lhs += *(int *)rhs; }
+
+static void bench_reduction(int nthreads, int reps, void *arg) {
+  static kmp_critical_name crit;
+  int kind = *(int *)arg;
+
+#pragma omp parallel num_threads(nthreads)
+  {
+    int gtid = __kmpc_global_thread_num(&loc);
+    int j;
+    for (j = 0; j < reps; j++) {
+      static int shared;
+      int priv = 1;
+      delay(delay_length);
+      if (kind == REDUCE_FUSED) {
+        __kmpc_barrier_reduce(&loc, gtid, RED_INT32, RED_SUM, &priv);
+        continue;
+      }
+      switch (kind == REDUCE_NOWAIT
+                  ? __kmpc_reduce_nowait(&loc, gtid, 1, sizeof(priv), &priv,
+                                         reduce_sum, &crit)
+                  : __kmpc_reduce(&loc, gtid, 1, sizeof(priv), &priv,
+                                  reduce_sum, &crit)) {
+      case 1:
+        shared += priv;
+        if (kind == REDUCE_NOWAIT)
+          __kmpc_end_reduce_nowait(&loc, gtid, &crit);
+        else
+          __kmpc_end_reduce(&loc, gtid, &crit);
+        break;
+      case 2:
+#pragma omp atomic
+        shared += priv;
+        if (kind == REDUCE_NOWAIT)
+          __kmpc_end_reduce_nowait(&loc, gtid, &crit);
+        else
+          __kmpc_end_reduce(&loc, gtid, &crit);
+        break;
+      }
+      if (kind == REDUCE_NOWAIT) {
+#pragma omp barrier
+      }
+    }
+  }
+}
+
+/* Loop schedules, driven through the dispatcher the way a compiler does for
+   schedule(...) loops; each loop ends with the usual barrier. */
+
+static void bench_schedule(int nthreads, int reps, void *arg) {
+  enum sched_type sched = *(enum sched_type *)arg;
+
+#pragma omp parallel num_threads(nthreads)
+  {
+    int gtid = __kmpc_global_thread_num(&loc);
+    int ub = loop_iters * omp_get_num_threads() - 1;
+    int j;
+    for (j = 0; j < reps; j++) {
+      int last, lb, hb, st, i;
+      __kmpc_dispatch_init_4(&loc, gtid, sched, 0, ub, 1, chunk_size);
+      while (__kmpc_dispatch_next_4(&loc, gtid, &last, &lb, &hb, &st)) {
+        for (i = lb; i <= hb; i++)
+          delay(delay_length);
+      }
+#pragma omp barrier
+    }
+  }
+}
+
+static omp_lock_hint_t lock_hints[] = {
+    omp_lock_hint_none, omp_lock_hint_uncontended, omp_lock_hint_contended,
+    omp_lock_hint_nonspeculative, omp_lock_hint_speculative};
+static int atomic_kinds[] = {ATOMIC_PRAGMA, ATOMIC_FIXED4, ATOMIC_FLOAT8,
+                             ATOMIC_FLOAT10};
+static int reduce_kinds[] = {REDUCE_BLOCKING, REDUCE_NOWAIT, REDUCE_FUSED};
+static enum sched_type scheds[] = {
+    kmp_sch_static_chunked,          kmp_sch_static,
+    kmp_sch_dynamic_chunked,         kmp_sch_guided_chunked,
+    kmp_sch_runtime,                 kmp_sch_auto,
+    kmp_sch_trapezoidal,             kmp_sch_static_greedy,
+    kmp_sch_static_balanced,         kmp_sch_guided_iterative_chunked,
+    kmp_sch_guided_analytical_chunked, kmp_sch_static_steal,
+    kmp_sch_static_balanced_chunked, kmp_sch_guided_simd,
+    kmp_sch_runtime_simd};
+
+static const bench_t benches[] = {
+    {"parallel", "fork_join", bench_parallel, NULL, 1},
+    {"barrier", "omp_barrier", bench_barrier, NULL, 1},
+    {"barrier", "split_phase", bench_split_barrier, NULL, 1},
+    {"single", "single", bench_single, NULL, 1},
+    {"critical", "critical", bench_critical, NULL, 1},
+    {"lock", "hint_none", bench_lock, &lock_hints[0], 1},
+    {"lock", "hint_uncontended", bench_lock, &lock_hints[1], 1},
+    {"lock", "hint_contended", bench_lock, &lock_hints[2], 1},
+    {"lock", "hint_nonspeculative", bench_lock, &lock_hints[3], 1},
+    {"lock", "hint_speculative", bench_lock, &lock_hints[4], 1},
+    {"lock", "nest", bench_nest_lock, NULL, 1},
+    {"atomic", "pragma_int32_add", bench_atomic, &atomic_kinds[0], 0},
+    {"atomic", "kmpc_fixed4_add", bench_atomic, &atomic_kinds[1], 0},
+    {"atomic", "kmpc_float8_add", bench_atomic, &atomic_kinds[2], 0},
+#if defined(__x86_64__) || defined(__i386__)
+    {"atomic", "kmpc_float10_add", bench_atomic, &atomic_kinds[3], 0},
+#endif
+    {"reduction", "kmpc_reduce", bench_reduction, &reduce_kinds[0], 1},
+    {"reduction", "kmpc_reduce_nowait", bench_reduction, &reduce_kinds[1], 1},
+    {"reduction", "barrier_reduce", bench_reduction, &reduce_kinds[2], 1},
+};
+
+static const char *sched_names[] = {
+    "static_chunked",  "static",           "dynamic_chunked",
+    "guided_chunked",  "runtime",          "auto",
+    "trapezoidal",     "static_greedy",    "static_balanced",
+    "guided_iterative_chunked", "guided_analytical_chunked", "static_steal",
+    "static_balanced_chunked", "guided_simd", "runtime_simd"};
+
+static void usage(const char *prog) {
+  fprintf(stderr,
+          "usage: %s [-t n,n,...] [-i inner_reps] [-o outer_reps]\n"
+          "          [-d delay_length] [-l loop_iters] [-c chunk]"
+          " [-b name,name,...] [-H]\n",
+          prog);
+  exit(2);
+}
+
+int main(int argc, char **argv) {
+  int threads[64], nthreads = 0, header = 1;
+  int i, t;
+
+  for (i = 1; i < argc; i++) {
+    const char *opt = argv[i];
+    const char *val = i + 1 < argc ? argv[i + 1] : NULL;
+    if (!strcmp(opt, "-H")) {
+      header = 0;
+      continue;
+    }
+    if (!val || opt[0] != '-' || opt[2])
+      usage(argv[0]);
+    i++;
+    switch (opt[1]) {
+    case 't': {
+      char *p = (char *)val;
+      while (*p && nthreads < 64) {
+        threads[nthreads++] = (int)strtol(p, &p, 10);
+        if (*p == ',')
+          p++;
+      }
+      break;
+    }
+    case 'i':
+      inner_reps = atoi(val);
+      break;
+    case 'o':
+      outer_reps = atoi(val);
+      break;
+    case 'd':
+      delay_length = atoi(val);
+      break;
+    case 'l':
+      loop_iters = atoi(val);
+      break;
+    case 'c':
+      chunk_size = atoi(val);
+      break;
+    case 'b':
+      only = val;
+      break;
+    default:
+      usage(argv[0]);
+    }
+  }
+  if (inner_reps < 1 || outer_reps < 1)
+    usage(argv[0]);
+  if (!nthreads) {
+    // Powers of two up to the number of procs, and the number of procs.
+    int procs = omp_get_num_procs();
+    for (t = 1; t < procs && nthreads < 63; t *= 2)
+      threads[nthreads++] = t;
+    threads[nthreads++] = procs;
+  }
+
+  omp_set_dynamic(0);
+  if (header)
+    printf("benchmark,variant,threads,reps,mean_us,min_us,sd_us,time_us,"
+           "ref_us\n");
+
+  for (t = 0; t < nthreads; t++) {
+    for (i = 0; i < (int)(sizeof(benches) / sizeof(benches[0])); i++)
+      run_bench(&benches[i], threads[t]);
+    for (i = 0; i < (int)(sizeof(scheds) / sizeof(scheds[0])); i++) {
+      bench_t b = {"schedule", sched_names[i], bench_schedule, &scheds[i],
+                   loop_iters};
+      run_bench(&b, threads[t]);
+    }
+  }
+  return 0;
+}
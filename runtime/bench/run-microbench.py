@@ -0,0 +1,103 @@
+#!/usr/bin/env python
+#
+#//===----------------------------------------------------------------------===//
+#//
+#//                     The LLVM Compiler Infrastructure
+#//
+#// This file is dual licensed under the MIT and the University of Illinois Open
+#// Source Licenses. See LICENSE.txt for details.
+#//
+#//===----------------------------------------------------------------------===//
+#
+
+"""
+Run the libomp synchronization microbenchmarks under each runtime setting
+that can only be chosen at initialization and collect the results as one
+CSV table:
+
+    config,benchmark,variant,threads,reps,mean_us,min_us,sd_us,time_us,ref_us
+
+config is "default" or the environment the run used, e.g.
+"KMP_LOCK_KIND=queuing". mean_us, min_us and sd_us are the overhead of one
+construct instance; time_us and ref_us are the raw time of one instance and
+the time of its delays alone, which the overhead is taken from.
+"""
+
+import argparse
+import os
+import subprocess
+import sys
+
+BARRIER_PATTERNS = ['linear', 'tree', 'hyper', 'hierarchical', 'dist']
+LOCK_KINDS = ['tas', 'futex', 'ticket', 'queuing', 'drdpa']
+REDUCTION_METHODS = ['critical', 'atomic', 'tree']
+
+
+def configs(args):
+    """Yield (name, environment, benchmarks) for every run."""
+    yield 'default', {}, None
+    for pat in args.barrier_patterns.split(','):
+        value = pat + ',' + pat
+        env = {'KMP_PLAIN_BARRIER_PATTERN': value,
+               'KMP_FORKJOIN_BARRIER_PATTERN': value,
+               'KMP_REDUCTION_BARRIER_PATTERN': value}
+        yield 'KMP_BARRIER_PATTERN=' + pat, env, 'parallel,barrier,reduction'
+    for kind in args.lock_kinds.split(','):
+        yield ('KMP_LOCK_KIND=' + kind, {'KMP_LOCK_KIND': kind},
+               'critical,lock')
+    for method in args.reduction_methods.split(','):
+        yield ('KMP_FORCE_REDUCTION=' + method,
+               {'KMP_FORCE_REDUCTION': method}, 'reduction')
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+        formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('binary', help='path to the libomp-microbench binary')
+    parser.add_argument('-o', '--output', help='also write the CSV here')
+    parser.add_argument('-t', '--threads',
+                        help='comma separated team sizes (default: powers '
+                             'of two up to the number of procs)')
+    parser.add_argument('--inner-reps', default='1000')
+    parser.add_argument('--outer-reps', default='20')
+    parser.add_argument('--barrier-patterns',
+                        default=','.join(BARRIER_PATTERNS))
+    parser.add_argument('--lock-kinds', default=','.join(LOCK_KINDS))
+    parser.add_argument('--reduction-methods',
+                        default=','.join(REDUCTION_METHODS))
+    args = parser.parse_args()
+
+    out = open(args.output, 'w') if args.output else None
+    header = ('config,benchmark,variant,threads,reps,mean_us,min_us,sd_us,'
+              'time_us,ref_us')
+    for f in (sys.stdout, out):
+        if f:
+            f.write(header + '\n')
+    failed = 0
+    for name, extra, benches in configs(args):
+        cmd = [args.binary, '-H', '-i', args.inner_reps,
+               '-o', args.outer_reps]
+        if args.threads:
+            cmd += ['-t', args.threads]
+        if benches:
+            cmd += ['-b', benches]
+        env = dict(os.environ)
+        env.update(extra)
+        proc = subprocess.Popen(cmd, env=env, stdout=subprocess.PIPE,
+                                universal_newlines=True)
+        for line in proc.stdout:
+            for f in (sys.stdout, out):
+                if f:
+                    f.write(name + ',' + line)
+                    f.flush()
+        if proc.wait() != 0:
+            sys.stderr.write('%s: %s failed with status %d\n' %
+                             (sys.argv[0], name, proc.returncode))
+            failed += 1
+    if out:
+        out.close()
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -764,6 +764,8 @@ extern void __kmp_affinity_bind_thread(int which);
 
 extern kmp_affin_mask_t *__kmp_affin_fullMask;
 extern char *__kmp_cpuinfo_file;
+extern int __kmp_numa_local_state; /* move a bound thread's descriptor to its
+                                      NUMA node */
 
 #endif /* KMP_AFFINITY_SUPPORTED */
 
@@ -924,6 +926,18 @@ extern int __kmp_hws_abs_flag; // absolute or per-item number requested
   (INT_MAX) /* Must be this for "infinite" setting the work */
 #define KMP_DEFAULT_BLOCKTIME (200) /*  __kmp_blocktime is in milliseconds  */
 
+// Current time: TSC ticks on x86 Unix, nanoseconds elsewhere.
+#if KMP_OS_UNIX && (KMP_ARCH_X86 || KMP_ARCH_X86_64)
+#if KMP_COMPILER_ICC
+#define KMP_NOW() ((kmp_uint64)_rdtsc())
+#else
+#define KMP_NOW() __kmp_hardware_timestamp()
+#endif
+#else
+extern kmp_uint64 __kmp_now_nsec();
+#define KMP_NOW() __kmp_now_nsec()
+#endif
+
 #if KMP_USE_MONITOR
 #define KMP_DEFAULT_MONITOR_STKSIZE ((size_t)(64 * 1024))
 #define KMP_MIN_MONITOR_WAKEUPS (1) // min times monitor wakes up per second
@@ -951,19 +965,12 @@ extern int __kmp_hws_abs_flag; // absolute or per-item number requested
 #if KMP_OS_UNIX && (KMP_ARCH_X86 || KMP_ARCH_X86_64)
 // HW TSC is used to reduce overhead (clock tick instead of nanosecond).
 extern kmp_uint64 __kmp_ticks_per_msec;
-#if KMP_COMPILER_ICC
-#define KMP_NOW() ((kmp_uint64)_rdtsc())
-#else
-#define KMP_NOW() __kmp_hardware_timestamp()
-#endif
 #define KMP_NOW_MSEC() (KMP_NOW() / __kmp_ticks_per_msec)
 #define KMP_BLOCKTIME_INTERVAL(team, tid)                                      \
   (KMP_BLOCKTIME(team, tid) * __kmp_ticks_per_msec)
 #define KMP_BLOCKING(goal, count) ((goal) > KMP_NOW())
 #else
 // System time is retrieved sporadically while blocking.
-extern kmp_uint64 __kmp_now_nsec();
-#define KMP_NOW() __kmp_now_nsec()
 #define KMP_NOW_MSEC() (KMP_NOW() / KMP_USEC_PER_SEC)
 #define KMP_BLOCKTIME_INTERVAL(team, tid)                                      \
   (KMP_BLOCKTIME(team, tid) * KMP_USEC_PER_SEC)
@@ -1002,8 +1009,15 @@ extern kmp_uint64 __kmp_now_nsec();
 
 #define KMP_MAX_BRANCH_BITS 31
 
+#define KMP_MAX_NUMA_NODES 64
+
 #define KMP_MAX_ACTIVE_LEVELS_LIMIT INT_MAX
 
+#if KMP_NESTED_HOT_TEAMS
+#define KMP_HOT_TEAMS_ADAPTIVE_LEVELS 8
+#define KMP_MAX_HOT_TEAMS_ADAPTIVE_FORKS 1024
+#endif
+
 #define KMP_MAX_DEFAULT_DEVICE_LIMIT INT_MAX
 
 #define KMP_MAX_TASK_PRIORITY_LIMIT INT_MAX
@@ -1808,11 +1822,15 @@ typedef enum kmp_bar_pat { /* Barrier communication patterns */
                                2, /* Hypercube-embedded tree with min branching
                                      factor 2^n */
                            bp_hierarchical_bar = 3, /* Machine hierarchy tree */
+                           bp_dist_bar = 4, /* Dissemination, log2(P) rounds */
                            bp_last_bar /* Placeholder to mark the end */
 } kmp_bar_pat_e;
 
 #define KMP_BARRIER_ICV_PUSH 1
 
+// Rounds of the dissemination barrier; larger teams use the linear gather
+#define KMP_DIST_BAR_MAX_ROUNDS 16
+
 /* Record for holding the values of the internal controls stack records */
 typedef struct kmp_internal_control {
   int serial_nesting_level; /* corresponds to the value of the
@@ -1843,6 +1861,27 @@ static inline void copy_icvs(kmp_internal_control_t *dst,
   *dst = *src;
 }
 
+/* Scalar reduction fused into the barrier, see __kmpc_barrier_reduce */
+enum kmp_bar_red_type {
+  kmp_bar_red_int32 = 0,
+  kmp_bar_red_float,
+  kmp_bar_red_double,
+  kmp_bar_red_last_type
+};
+
+enum kmp_bar_red_op {
+  kmp_bar_red_sum = 0,
+  kmp_bar_red_min,
+  kmp_bar_red_max,
+  kmp_bar_red_last_op
+};
+
+typedef union kmp_bar_red {
+  kmp_int32 i32;
+  float f;
+  double d;
+} kmp_bar_red_t;
+
 /* Thread barrier needs volatile barrier fields */
 typedef struct KMP_ALIGN_CACHE kmp_bstate {
   // th_fixed_icvs is aligned by virtue of kmp_bstate being aligned (and all
@@ -1853,6 +1892,8 @@ typedef struct KMP_ALIGN_CACHE kmp_bstate {
   // Tuck b_go into end of th_fixed_icvs cache line, so it can be stored with
   // same NGO store
   volatile kmp_uint64 b_go; // STATE => task should proceed (hierarchical)
+  // Generation of th_fixed_icvs, 0 if none
+  kmp_uint64 icv_gen;
   KMP_ALIGN_CACHE volatile kmp_uint64
       b_arrived; // STATE => task reached synch point.
   kmp_uint32 *skip_per_level;
@@ -1869,6 +1910,12 @@ typedef struct KMP_ALIGN_CACHE kmp_bstate {
   kmp_uint8 offset;
   kmp_uint8 wait_flag;
   kmp_uint8 use_oncore_barrier;
+  kmp_uint8 b_tune; // candidate pattern of the barrier in progress, see team
+  // Dissemination barrier: b_dist[p][k] is bumped by the partner of round k
+  // in barriers of parity p, and reset by this thread once seen.
+  KMP_ALIGN_CACHE volatile kmp_uint64 b_dist[2][KMP_DIST_BAR_MAX_ROUNDS];
+  // Partial result of a fused reduction, combined in place by the gather
+  KMP_ALIGN_CACHE kmp_bar_red_t b_red;
 #if USE_DEBUGGER
   // The following field is intended for the debugger solely. Only the worker
   // thread itself accesses this field: the worker increases it by 1 when it
@@ -1886,11 +1933,20 @@ union KMP_ALIGN_CACHE kmp_barrier_union {
 typedef union kmp_barrier_union kmp_balign_t;
 
 /* Team barrier needs only non-volatile arrived counter */
+struct kmp_bar_tune;
+
 union KMP_ALIGN_CACHE kmp_barrier_team_union {
   double b_align; /* use worst case alignment */
   char b_pad[CACHE_LINE];
   struct {
     kmp_uint64 b_arrived; /* STATE => task reached synch point. */
+    // Barrier tuning: candidate pattern of the next barrier (0 for the
+    // settings), chosen by the master before it releases the current one
+    kmp_int32 b_tune;
+    struct kmp_bar_tune *b_tune_state;
+    // Result of a fused reduction, set by the master before it releases the
+    // team; workers read it before they arrive at the next barrier
+    kmp_bar_red_t b_red;
 #if USE_DEBUGGER
     // The following two fields are indended for the debugger solely. Only
     // master of the team accesses these fields: the first one is increased by
@@ -2085,6 +2141,16 @@ typedef enum kmp_tasking_mode {
 extern kmp_tasking_mode_t
     __kmp_tasking_mode; /* determines how/when to execute tasks */
 extern int __kmp_task_stealing_constraint;
+extern int __kmp_task_deque_lockfree; // use lock-free (Chase-Lev) task deques
+
+typedef enum kmp_steal_policy {
+  steal_random = 0, // victims are picked at random from the whole team
+  steal_hierarchical = 1 // victims close in the machine hierarchy go first
+} kmp_steal_policy_t;
+
+extern kmp_steal_policy_t __kmp_task_steal_policy;
+extern int __kmp_task_continuation; // run a released successor task next
+extern int __kmp_task_range_deps; // match dependences by address range
 #if OMP_40_ENABLED
 extern kmp_int32 __kmp_default_device; // Set via OMP_DEFAULT_DEVICE if
 // specified, defaults to 0 otherwise
@@ -2167,6 +2233,14 @@ typedef struct kmp_taskgroup {
 typedef union kmp_depnode kmp_depnode_t;
 typedef struct kmp_depnode_list kmp_depnode_list_t;
 typedef struct kmp_dephash_entry kmp_dephash_entry_t;
+typedef struct kmp_dep_pool kmp_dep_pool_t; // see kmp_taskdeps.cpp
+
+// Dependence kinds as encoded in the flags of kmp_depend_info_t
+#define KMP_DEP_IN 0x1
+#define KMP_DEP_OUT 0x2
+#define KMP_DEP_INOUT 0x3
+#define KMP_DEP_MTX 0x4 // mutexinoutset
+#define KMP_DEP_SET 0x8 // inoutset
 
 typedef struct kmp_depend_info {
   kmp_intptr_t base_addr;
@@ -2174,12 +2248,27 @@ typedef struct kmp_depend_info {
   struct {
     bool in : 1;
     bool out : 1;
+    bool mtx : 1;
+    bool set : 1;
   } flags;
 } kmp_depend_info_t;
 
+// Mutexinoutset dependences of a task that get a lock; any others are treated
+// as inout
+#define MAX_MTX_DEPS 4
+
+// Lock shared by the mutexinoutset tasks of one dependence address. It is
+// referenced by the dependence hash entry and by every task using it, since
+// the entry may be freed while those tasks run.
+typedef struct kmp_dep_mtx {
+  kmp_lock_t lock;
+  std::atomic<kmp_int32> nrefs;
+} kmp_dep_mtx_t;
+
 struct kmp_depnode_list {
   kmp_depnode_t *node;
   kmp_depnode_list_t *next;
+  kmp_dep_pool_t *pool; // pool the entry came from
 };
 
 typedef struct kmp_base_depnode {
@@ -2194,6 +2283,12 @@ typedef struct kmp_base_depnode {
 
   std::atomic<kmp_int32> npredecessors;
   std::atomic<kmp_int32> nrefs;
+  kmp_int32 nrefs_credit; // references already counted in nrefs but not yet
+  // handed out, only used by the thread processing the node's dependences
+  kmp_int32 tdg_index; // index in the task graph being recorded, -1 if none
+  kmp_int32 mtx_num_locks; // number of mtx_locks, negated while they are held
+  kmp_dep_mtx_t *mtx_locks[MAX_MTX_DEPS]; // in decreasing address order
+  kmp_dep_pool_t *pool; // pool the node came from, NULL if on the stack
 } kmp_base_depnode_t;
 
 union KMP_ALIGN_CACHE kmp_depnode {
@@ -2202,22 +2297,86 @@ union KMP_ALIGN_CACHE kmp_depnode {
   kmp_base_depnode_t dn;
 };
 
+// The tasks in last_ins form a set of dependences of kind last_flag (in,
+// mutexinoutset or inoutset) that may run in any order. They all come after
+// last_out, or after every task of the previous set if there is one.
 struct kmp_dephash_entry {
   kmp_intptr_t addr;
   kmp_depnode_t *last_out;
   kmp_depnode_list_t *last_ins;
+  kmp_depnode_list_t *prev_set;
+  kmp_uint8 last_flag; // KMP_DEP_IN, KMP_DEP_MTX or KMP_DEP_SET, 0 if no set
+  kmp_dep_mtx_t *mtx_lock; // serializes the mutexinoutset tasks
   kmp_dephash_entry_t *next_in_bucket;
 };
 
+// Dependence state of the bytes [start, end) of an array section, used when
+// __kmp_task_range_deps is set. The segments of a dependence hash are disjoint
+// and sorted by address; a section overlapping some of them splits them so
+// that only the overlapping part is updated.
+typedef struct kmp_dep_range {
+  kmp_intptr_t start;
+  kmp_intptr_t end;
+  kmp_depnode_t *last_out;
+  kmp_depnode_list_t *last_ins;
+} kmp_dep_range_t;
+
 typedef struct kmp_dephash {
   kmp_dephash_entry_t **buckets;
-  size_t size;
+  size_t size; // number of buckets, a power of 2
+  kmp_uint32 nelements; // the table grows as this reaches 3/4 of size
+  kmp_uint32 nranges; // number of segments in use in ranges
+  kmp_uint32 ranges_size; // number of segments allocated
+  kmp_dep_range_t *ranges; // interval index for array section dependences
 #ifdef KMP_DEBUG
-  kmp_uint32 nelements;
   kmp_uint32 nconflicts;
+  kmp_uint32 max_chain;
 #endif
 } kmp_dephash_t;
 
+// Task dependence graph of a region, recorded the first time the region runs
+// and replayed by the following runs, see __kmpc_start_record_task
+typedef enum kmp_tdg_status {
+  tdg_empty = 0, // nothing recorded
+  tdg_recording,
+  tdg_ready, // recorded, can be replayed
+  tdg_replaying,
+  tdg_diverged, // a replay stopped, the rest of the region is tracked only
+  tdg_disabled // the region does not replay
+} kmp_tdg_status_t;
+
+typedef struct kmp_tdg_node {
+  ident_t *ident; // location of the task
+  kmp_int32 ndeps; // number of dependences the task was created with
+  kmp_int32 deps; // index of its first dependence in kmp_tdg_t::deps
+  kmp_int32 npredecessors;
+  kmp_int32 successors; // index of the first successor in kmp_tdg_t::edges
+  kmp_int32 nsuccessors;
+} kmp_tdg_node_t;
+
+typedef struct kmp_tdg {
+  kmp_int32 id; // tdg_id given by the program
+  std::atomic<kmp_int32> status; // kmp_tdg_status_t
+  bool replayable; // cleared while recording if the region cannot replay
+  kmp_int32 nnodes;
+  kmp_int32 nodes_size;
+  kmp_tdg_node_t *nodes; // tasks in creation order
+  kmp_int32 ndeps;
+  kmp_int32 deps_size;
+  kmp_depend_info_t *deps; // dependences of the tasks, compared when replaying
+  kmp_int32 nedges;
+  kmp_int32 edges_size;
+  kmp_int32 *edges; // (predecessor, successor) pairs while recording, then
+  // the successors of each node
+  kmp_dephash_t *saved_dephash; // dependence hash of the task recording
+  kmp_int32 next; // index of the next task created while replaying
+  std::atomic<kmp_int32> *npredecessors; // remaining predecessors of each
+  // task while replaying, plus one until the task is created
+  kmp_taskdata_t **tasks; // tasks created while replaying
+  std::atomic<kmp_int32> nremaining; // tasks of the region not finished
+  struct kmp_tdg *next_tdg;
+} kmp_tdg_t;
+
 #endif
 
 #ifdef BUILD_TIED_TASK_STACK
@@ -2305,6 +2464,9 @@ struct kmp_taskdata { /* aligned during dynamic allocation       */
       *td_dephash; // Dependencies for children tasks are tracked from here
   kmp_depnode_t
       *td_depnode; // Pointer to graph node if this task has dependencies
+  kmp_tdg_t *td_tdg_region; // Task graph recorded or replayed by this task
+  kmp_tdg_t *td_tdg; // Task graph this task is part of
+  kmp_int32 td_tdg_index; // Index of this task in td_tdg
 #endif // OMP_40_ENABLED
 #if OMP_45_ENABLED
   kmp_task_team_t *td_task_team;
@@ -2315,6 +2477,8 @@ struct kmp_taskdata { /* aligned during dynamic allocation       */
 #endif
 #endif // OMP_45_ENABLED
   kmp_taskdata_t *td_last_tied; // keep tied task for task scheduling constraint
+  kmp_int32 td_rw_reader; // gtid + 1 picking the reader slots of rw locks the
+  // task holds shared, fixed at its first shared acquire; 0 before that
 #if defined(KMP_GOMP_COMPAT) && OMP_45_ENABLED
   // GOMP sends in a copy function for copy constructors
   void (*td_copy_func)(void *, void *);
@@ -2327,6 +2491,16 @@ struct kmp_taskdata { /* aligned during dynamic allocation       */
 // Make sure padding above worked
 KMP_BUILD_ASSERT(sizeof(kmp_taskdata_t) % sizeof(void *) == 0);
 
+// Circular array backing the lock-free task deque. Arrays are only ever
+// replaced by larger ones; the replaced array is kept on cla_retired because
+// thieves may still be reading from it, until no thread uses the task team
+// any more (see __kmp_task_team_wait) or the deque is freed.
+typedef struct kmp_task_cl_array {
+  kmp_int64 cla_size; // Number of slots, always a power of 2
+  struct kmp_task_cl_array *cla_retired; // Previously used (smaller) array
+  std::atomic<kmp_taskdata_t *> cla_tasks[1]; // cla_size slots
+} kmp_task_cl_array_t;
+
 // Data for task team but per thread
 typedef struct kmp_base_thread_data {
   kmp_info_p *td_thr; // Pointer back to thread info
@@ -2341,14 +2515,27 @@ typedef struct kmp_base_thread_data {
   kmp_int32 td_deque_ntasks; // Number of tasks in deque
   // GEH: shouldn't this be volatile since used in while-spin?
   kmp_int32 td_deque_last_stolen; // Thread number of last successful steal
+  kmp_int32 td_steal_level; // Hierarchy level victims are picked from
+  kmp_int32 td_steal_fails; // Failed steal attempts at td_steal_level
+  // Lock-free (Chase-Lev) deque, used when __kmp_task_deque_lockfree is set.
+  // Only the owner pushes and pops at td_cl_bottom, thieves advance td_cl_top
+  // with a CAS. The locked td_deque above then only holds tasks that other
+  // threads give to this thread (see __kmp_give_task).
+  std::atomic<kmp_task_cl_array_t *> td_cl_array;
+  std::atomic<kmp_int64> td_cl_bottom;
+  KMP_ALIGN_CACHE std::atomic<kmp_int64> td_cl_top; // written by thieves
 #ifdef BUILD_TIED_TASK_STACK
   kmp_task_stack_t td_susp_tied_tasks; // Stack of suspended tied tasks for task
 // scheduling constraint
 #endif // BUILD_TIED_TASK_STACK
 } kmp_base_thread_data_t;
 
+#define KMP_TASK_STEAL_MAX_LEVELS 8 // Victim selection levels per task team
+
 #define TASK_DEQUE_BITS 8 // Used solely to define INITIAL_TASK_DEQUE_SIZE
 #define INITIAL_TASK_DEQUE_SIZE (1 << TASK_DEQUE_BITS)
+// Lock-free deques only grow past this size for tasks that must be queued
+#define MAX_TASK_CL_DEQUE_SIZE (INITIAL_TASK_DEQUE_SIZE << 6)
 
 #define TASK_DEQUE_SIZE(td) ((td).td_deque_size)
 #define TASK_DEQUE_MASK(td) ((td).td_deque_size - 1)
@@ -2359,11 +2546,26 @@ typedef union KMP_ALIGN_CACHE kmp_thread_data {
   char td_pad[KMP_PAD(kmp_base_thread_data_t, CACHE_LINE)];
 } kmp_thread_data_t;
 
+#if OMP_45_ENABLED
+// Deque of tasks with the same priority. The task team keeps a list of them
+// sorted by decreasing priority; every thread of the team takes from them.
+typedef struct kmp_task_pri {
+  kmp_thread_data_t td; // Deque of tasks (td_thr is unused)
+  kmp_int32 priority; // Priority of all tasks in the deque
+  struct kmp_task_pri *next; // Deque with the next lower priority
+} kmp_task_pri_t;
+#endif
+
 // Data for task teams which are used when tasking is enabled for the team
 typedef struct kmp_base_task_team {
   kmp_bootstrap_lock_t
       tt_threads_lock; /* Lock used to allocate per-thread part of task team */
   /* must be bootstrap lock since used at library shutdown*/
+#if OMP_45_ENABLED
+  kmp_bootstrap_lock_t
+      tt_task_pri_lock; /* Lock used to insert into the priority deque list */
+  kmp_task_pri_t *tt_task_pri_list; /* Priority deques, highest first */
+#endif
   kmp_task_team_t *tt_next; /* For linking the task team free list */
   kmp_thread_data_t
       *tt_threads_data; /* Array of per-thread structures for task team */
@@ -2379,6 +2581,16 @@ typedef struct kmp_base_task_team {
       tt_found_proxy_tasks; /* Have we found proxy tasks since last barrier */
 #endif
   kmp_int32 tt_untied_task_encountered;
+  // Number of threads sharing each level of the machine hierarchy, innermost
+  // level first: tt_steal_skip[0] is 1 (the thread itself) and the last level
+  // spans the team. Used to pick nearby victims when stealing tasks.
+  kmp_int32 tt_steal_levels;
+  kmp_uint32 tt_steal_skip[KMP_TASK_STEAL_MAX_LEVELS];
+
+#if OMP_45_ENABLED
+  KMP_ALIGN_CACHE
+  std::atomic<kmp_int32> tt_num_task_pri; /* #tasks in priority deques */
+#endif
 
   KMP_ALIGN_CACHE
   std::atomic<kmp_int32> tt_unfinished_threads; /* #threads still active */
@@ -2408,9 +2620,13 @@ typedef struct kmp_free_list {
 #if KMP_NESTED_HOT_TEAMS
 // Hot teams array keeps hot teams and their sizes for given thread. Hot teams
 // are not put in teams pool, and they don't put threads in threads pool.
+// Levels below KMP_HOT_TEAMS_MAX_LEVEL are always hot; with
+// KMP_HOT_TEAMS_ADAPTIVE the deeper levels up to KMP_HOT_TEAMS_ADAPTIVE_LEVELS
+// become hot once the thread keeps forking there.
 typedef struct kmp_hot_team_ptr {
   kmp_team_p *hot_team; // pointer to hot_team of given nesting level
   kmp_int32 hot_team_nth; // number of threads allocated for the hot_team
+  kmp_int32 hot_team_forks; // forks at this level without a hot team
 } kmp_hot_team_ptr_t;
 #endif
 #if OMP_40_ENABLED
@@ -2430,6 +2646,9 @@ typedef struct KMP_ALIGN_CACHE kmp_base_info {
   kmp_team_p *th_team; /* team we belong to */
   kmp_root_p *th_root; /* pointer to root of task hierarchy */
   kmp_info_p *th_next_pool; /* next available thread in the pool */
+  kmp_info_p *th_spawn_next; /* next worker to create after this one */
+  kmp_info_p *th_spawn_child; /* first worker to create when this one starts */
+  volatile kmp_uint32 th_spawn_pending; /* OS thread not created yet */
   kmp_disp_t *th_dispatch; /* thread's dispatch data */
   int th_in_pool; /* in thread pool (32 bits for TCR/TCW) */
 
@@ -2502,6 +2721,7 @@ typedef struct KMP_ALIGN_CACHE kmp_base_info {
   /* while awaiting queuing lock acquire */
 
   volatile void *th_sleep_loc; // this points at a kmp_flag<T>
+  volatile void *th_sleep_word; // the flag word th_sleep_loc waits on
 
   ident_t *th_ident;
   unsigned th_x; // Random number generator data
@@ -2517,6 +2737,14 @@ typedef struct KMP_ALIGN_CACHE kmp_base_info {
   kmp_uint32 th_task_state_stack_sz; // Size of th_task_state_memo_stack
   kmp_uint32 th_reap_state; // Non-zero indicates thread is not
   // tasking, thus safe to reap
+  kmp_taskdata_t *th_task_continuation; // Ready successor to run next, kept
+  // by __kmp_release_deps when __kmp_task_continuation is set
+  kmp_taskdata_t *th_task_continuation_src; // Task whose completion may set
+  // th_task_continuation, i.e. the one run by __kmp_execute_tasks_template
+  kmp_dep_pool_t *th_dep_pool; // Pool of depnodes and depnode list entries,
+  // see kmp_taskdeps.cpp
+  kmp_int32 th_lock_prof_held; // 1 + lock profile table index of the lock the
+  // thread last acquired, 0 if none (KMP_LOCK_PROFILE)
 
   /* More stuff for keeping track of active/sleeping threads (this part is
      written by the worker thread) */
@@ -2531,13 +2759,17 @@ typedef struct KMP_ALIGN_CACHE kmp_base_info {
   /* Add the syncronizing data which is cache aligned and padded. */
   KMP_ALIGN_CACHE kmp_balign_t th_bar[bs_last_barrier];
 
+  KMP_ALIGN_CACHE volatile kmp_uint64
+      th_split_go; /* bumped by the last thread to arrive at a split barrier */
+  kmp_int32 th_split_arrived; /* arrived at a split barrier, not waited yet */
+
   KMP_ALIGN_CACHE volatile kmp_int32
       th_next_waiting; /* gtid+1 of next thread on lock wait queue, 0 if none */
 
 #if (USE_FAST_MEMORY == 3) || (USE_FAST_MEMORY == 5)
-#define NUM_LISTS 4
+#define NUM_LISTS 6
   kmp_free_list_t th_free_lists[NUM_LISTS]; // Free lists for fast memory
-// allocation routines
+// allocation routines, one per power of 2 size class from 2 to 64 cache lines
 #endif
 
 #if KMP_OS_WINDOWS
@@ -2610,6 +2842,9 @@ typedef struct KMP_ALIGN_CACHE kmp_base_team {
   kmp_balign_team_t t_bar[bs_last_barrier];
   std::atomic<int> t_construct; // count of single directive encountered by team
   char pad[sizeof(kmp_lock_t)]; // padding to maintain performance on big iron
+  KMP_ALIGN_CACHE std::atomic<kmp_int32>
+      t_split_arrived; // threads arrived at the current split barrier
+  int t_split_tasks; // the split barrier released last must finish tasks
 
   // Master only
   // ---------------------------------------------------------------------------
@@ -2655,6 +2890,7 @@ typedef struct KMP_ALIGN_CACHE kmp_base_team {
   kmp_taskdata_t
       *t_implicit_task_taskdata; // Taskdata for the thread's implicit task
   int t_level; // nested parallel level
+  kmp_uint64 t_icv_gen; // generation of the ICVs pushed by the fork barrier
 
   KMP_ALIGN_CACHE int t_max_argc;
   int t_max_nproc; // max threads this team can handle (dynamicly expandable)
@@ -2849,6 +3085,7 @@ extern char const *__kmp_barrier_branch_bit_env_name[bs_last_barrier];
 extern char const *__kmp_barrier_pattern_env_name[bs_last_barrier];
 extern char const *__kmp_barrier_type_name[bs_last_barrier];
 extern char const *__kmp_barrier_pattern_name[bp_last_bar];
+extern int __kmp_barrier_tuning; // barriers timed per candidate pattern
 
 /* Global Locks */
 extern kmp_bootstrap_lock_t __kmp_initz_lock; /* control initialization */
@@ -2886,6 +3123,8 @@ extern size_t __kmp_monitor_stksize; /* stack size for monitor thread */
 #endif
 extern size_t __kmp_stkoffset; /* stack offset per thread       */
 extern int __kmp_stkpadding; /* Should we pad root thread(s) stack */
+extern int __kmp_spawn_branch; /* # of workers a new worker creates itself */
+extern int __kmp_prespawn; /* create the default team's workers at init */
 
 extern size_t
     __kmp_malloc_pool_incr; /* incremental size of pool for kmp_malloc() */
@@ -2917,6 +3156,7 @@ extern size_t __kmp_align_alloc;
 /* following data protected by initialization routines */
 extern int __kmp_xproc; /* number of processors in the system */
 extern int __kmp_avail_proc; /* number of processors available to the process */
+extern int __kmp_num_numa_nodes; /* number of NUMA nodes in the system */
 extern size_t __kmp_sys_min_stksize; /* system-defined minimum stack size */
 extern int __kmp_sys_max_nth; /* system-imposed maximum number of threads */
 // maximum total number of concurrently-existing threads on device
@@ -2938,6 +3178,8 @@ extern int __kmp_dflt_nested; /* nested parallelism enabled by default a la
                                  OMP_NESTED */
 extern int __kmp_dflt_blocktime; /* number of milliseconds to wait before
                                     blocking (env setting) */
+extern int __kmp_futex_sleep; /* sleep on the flag word with futex instead of
+                                 the thread's condition variable */
 #if KMP_USE_MONITOR
 extern int
     __kmp_monitor_wakeups; /* number of times monitor wakes up per second */
@@ -2985,6 +3227,9 @@ extern int __kmp_dispatch_num_buffers; /* max possible dynamic loops in
 #if KMP_NESTED_HOT_TEAMS
 extern int __kmp_hot_teams_mode;
 extern int __kmp_hot_teams_max_level;
+extern int __kmp_hot_teams_adaptive;
+extern int __kmp_hot_teams_budget;
+extern std::atomic<kmp_int32> __kmp_hot_teams_reserved;
 #endif
 
 #if KMP_OS_LINUX
@@ -3028,6 +3273,10 @@ extern char *__kmp_speculative_statsfile;
 
 #endif // KMP_USE_ADAPTIVE_LOCKS
 
+// Lock contention profiling
+extern int __kmp_lock_profile; /* TRUE or FALSE */
+extern char *__kmp_lock_profile_file;
+
 #if OMP_40_ENABLED
 extern int __kmp_display_env; /* TRUE or FALSE */
 extern int __kmp_display_env_verbose; /* TRUE if OMP_DISPLAY_ENV=VERBOSE */
@@ -3297,6 +3546,8 @@ __kmp_initialize_system_tick(void); /* Initialize timer tick value */
 extern void
 __kmp_runtime_initialize(void); /* machine specific initialization */
 extern void __kmp_runtime_destroy(void);
+extern int __kmp_get_numa_node(void); /* NUMA node of the calling thread's
+                                         processor, 0..__kmp_num_numa_nodes-1 */
 
 #if KMP_AFFINITY_SUPPORTED
 extern char *__kmp_affinity_print_mask(char *buf, int buf_len,
@@ -3316,6 +3567,7 @@ extern int __kmp_aux_set_affinity_mask_proc(int proc, void **mask);
 extern int __kmp_aux_unset_affinity_mask_proc(int proc, void **mask);
 extern int __kmp_aux_get_affinity_mask_proc(int proc, void **mask);
 extern void __kmp_balanced_affinity(int tid, int team_size);
+extern void __kmp_localize_thread_state(kmp_info_t *th);
 #if KMP_OS_LINUX
 extern int kmp_set_thread_affinity_mask_initial(void);
 #endif
@@ -3323,6 +3575,9 @@ extern int kmp_set_thread_affinity_mask_initial(void);
 
 extern void __kmp_cleanup_hierarchy();
 extern void __kmp_get_hierarchy(kmp_uint32 nproc, kmp_bstate_t *thr_bar);
+extern kmp_uint32 __kmp_get_hierarchy_groups(kmp_uint32 nproc,
+                                             kmp_uint32 *groups,
+                                             kmp_uint32 max_levels);
 
 #if KMP_USE_FUTEX
 
@@ -3384,6 +3639,7 @@ extern void __kmp_suspend_uninitialize_thread(kmp_info_t *th);
 
 extern kmp_info_t *__kmp_allocate_thread(kmp_root_t *root, kmp_team_t *team,
                                          int tid);
+extern void __kmp_spawn_children(kmp_info_t *th);
 #if OMP_40_ENABLED
 extern kmp_team_t *
 __kmp_allocate_team(kmp_root_t *root, int new_nproc, int max_nproc,
@@ -3423,6 +3679,10 @@ extern int __kmp_barrier(enum barrier_type bt, int gtid, int is_split,
                          size_t reduce_size, void *reduce_data,
                          void (*reduce)(void *, void *));
 extern void __kmp_end_split_barrier(enum barrier_type bt, int gtid);
+extern void __kmp_barrier_arrive(int gtid);
+extern void __kmp_barrier_wait(int gtid);
+extern void __kmp_barrier_tune_free(kmp_team_t *team);
+extern void __kmp_cleanup_barrier_tuning(void);
 
 /*!
  * Tell the fork call which compiler generated the fork call, and therefore how
@@ -3602,6 +3862,8 @@ KMP_EXPORT void __kmpc_end_serialized_parallel(ident_t *, kmp_int32 global_tid);
 
 KMP_EXPORT void __kmpc_flush(ident_t *);
 KMP_EXPORT void __kmpc_barrier(ident_t *, kmp_int32 global_tid);
+KMP_EXPORT void __kmpc_barrier_arrive(ident_t *, kmp_int32 global_tid);
+KMP_EXPORT void __kmpc_barrier_wait(ident_t *, kmp_int32 global_tid);
 KMP_EXPORT kmp_int32 __kmpc_master(ident_t *, kmp_int32 global_tid);
 KMP_EXPORT void __kmpc_end_master(ident_t *, kmp_int32 global_tid);
 KMP_EXPORT void __kmpc_ordered(ident_t *, kmp_int32 global_tid);
@@ -3704,6 +3966,15 @@ KMP_EXPORT void __kmpc_omp_wait_deps(ident_t *loc_ref, kmp_int32 gtid,
 extern void __kmp_release_deps(kmp_int32 gtid, kmp_taskdata_t *task);
 extern void __kmp_dephash_free_entries(kmp_info_t *thread, kmp_dephash_t *h);
 extern void __kmp_dephash_free(kmp_info_t *thread, kmp_dephash_t *h);
+extern bool __kmp_acquire_mtx_deps(kmp_int32 gtid, kmp_depnode_t *node);
+extern void __kmp_reap_dep_pools(kmp_info_t *thread);
+extern void __kmp_cleanup_dep_pools(void);
+KMP_EXPORT kmp_int32 __kmpc_start_record_task(ident_t *loc_ref, kmp_int32 gtid,
+                                              kmp_int32 input_flags,
+                                              kmp_int32 tdg_id);
+KMP_EXPORT void __kmpc_end_record_task(ident_t *loc_ref, kmp_int32 gtid,
+                                       kmp_int32 input_flags, kmp_int32 tdg_id);
+extern void __kmp_cleanup_tdgs(void);
 
 extern kmp_int32 __kmp_omp_task(kmp_int32 gtid, kmp_task_t *new_task,
                                 bool serialize_immediate);
@@ -3749,6 +4020,10 @@ KMP_EXPORT void __kmpc_unset_lock(ident_t *loc, kmp_int32 gtid,
                                   void **user_lock);
 KMP_EXPORT void __kmpc_unset_nest_lock(ident_t *loc, kmp_int32 gtid,
                                        void **user_lock);
+KMP_EXPORT void __kmpc_set_lock_shared(ident_t *loc, kmp_int32 gtid,
+                                       void **user_lock);
+KMP_EXPORT void __kmpc_unset_lock_shared(ident_t *loc, kmp_int32 gtid,
+                                         void **user_lock);
 KMP_EXPORT int __kmpc_test_lock(ident_t *loc, kmp_int32 gtid, void **user_lock);
 KMP_EXPORT int __kmpc_test_nest_lock(ident_t *loc, kmp_int32 gtid,
                                      void **user_lock);
@@ -3775,6 +4050,9 @@ KMP_EXPORT kmp_int32 __kmpc_reduce(
     kmp_critical_name *lck);
 KMP_EXPORT void __kmpc_end_reduce(ident_t *loc, kmp_int32 global_tid,
                                   kmp_critical_name *lck);
+KMP_EXPORT void __kmpc_barrier_reduce(ident_t *loc, kmp_int32 global_tid,
+                                      kmp_int32 type, kmp_int32 op,
+                                      void *data);
 
 /* Internal fast reduction routines */
 
@@ -45,6 +45,32 @@ void __kmp_get_hierarchy(kmp_uint32 nproc, kmp_bstate_t *thr_bar) {
   thr_bar->skip_per_level = machine_hierarchy.skipPerLevel;
 }
 
+// Fill groups[] with the number of threads below each distinct level of the
+// machine hierarchy for a team of nproc threads, innermost first. groups[0] is
+// 1 and the last entry is nproc. Returns the number of entries written, at most
+// max_levels.
+kmp_uint32 __kmp_get_hierarchy_groups(kmp_uint32 nproc, kmp_uint32 *groups,
+                                      kmp_uint32 max_levels) {
+  kmp_uint32 levels = 1;
+  KMP_DEBUG_ASSERT(max_levels > 1);
+
+  if (TCR_1(machine_hierarchy.uninitialized))
+    machine_hierarchy.init(NULL, nproc);
+  if (nproc > machine_hierarchy.base_num_threads)
+    machine_hierarchy.resize(nproc);
+
+  groups[0] = 1;
+  for (kmp_uint32 d = 1; d < machine_hierarchy.maxLevels; ++d) {
+    kmp_uint32 size = machine_hierarchy.skipPerLevel[d];
+    if (size >= nproc || levels == max_levels - 1)
+      break;
+    if (size > groups[levels - 1])
+      groups[levels++] = size;
+  }
+  groups[levels++] = nproc; // the whole team
+  return levels;
+}
+
 #if KMP_AFFINITY_SUPPORTED
 
 bool KMPAffinity::picked_api = false;
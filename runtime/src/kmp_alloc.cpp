@@ -13,6 +13,7 @@
 
 #include "kmp.h"
 #include "kmp_io.h"
+#include "kmp_stats.h"
 #include "kmp_wrapper_malloc.h"
 
 // Disable bget when it is not used
@@ -1649,8 +1650,7 @@ void ___kmp_free(void *ptr KMP_SRC_LOC_DECL) {
 
 void *___kmp_fast_allocate(kmp_info_t *this_thr, size_t size KMP_SRC_LOC_DECL) {
   void *ptr;
-  int num_lines;
-  int idx;
+  size_t num_lines;
   int index;
   void *alloc_ptr;
   size_t alloc_size;
@@ -1660,23 +1660,19 @@ void *___kmp_fast_allocate(kmp_info_t *this_thr, size_t size KMP_SRC_LOC_DECL) {
                 __kmp_gtid_from_thread(this_thr), (int)size KMP_SRC_LOC_PARM));
 
   num_lines = (size + DCACHE_LINE - 1) / DCACHE_LINE;
-  idx = num_lines - 1;
-  KMP_DEBUG_ASSERT(idx >= 0);
-  if (idx < 2) {
-    index = 0; // idx is [ 0, 1 ], use first free list
-    num_lines = 2; // 1, 2 cache lines or less than cache line
-  } else if ((idx >>= 2) == 0) {
-    index = 1; // idx is [ 2, 3 ], use second free list
-    num_lines = 4; // 3, 4 cache lines
-  } else if ((idx >>= 2) == 0) {
-    index = 2; // idx is [ 4, 15 ], use third free list
-    num_lines = 16; // 5, 6, ..., 16 cache lines
-  } else if ((idx >>= 2) == 0) {
-    index = 3; // idx is [ 16, 63 ], use fourth free list
-    num_lines = 64; // 17, 18, ..., 64 cache lines
-  } else {
-    goto alloc_call; // 65 or more cache lines ( > 8KB ), don't use free lists
+  // Free list index grows with the power of 2 size class: 1 or 2 cache lines
+  // use the first list, 3 or 4 the second, 5..8 the third, and so on
+  for (index = 0; index < NUM_LISTS; ++index) {
+    if (num_lines <= ((size_t)2 << index))
+      break;
+  }
+  // Checked in all builds: num_lines is a size_t, so sizes of any magnitude
+  // past the largest class get here and never index past th_free_lists
+  if (index >= NUM_LISTS) {
+    KMP_COUNT_BLOCK(FAST_ALLOC_miss);
+    goto alloc_call; // too large for the free lists
   }
+  num_lines = (size_t)2 << index;
 
   ptr = this_thr->th.th_free_lists[index].th_free_list_self;
   if (ptr != NULL) {
@@ -1686,6 +1682,7 @@ void *___kmp_fast_allocate(kmp_info_t *this_thr, size_t size KMP_SRC_LOC_DECL) {
         this_thr ==
         ((kmp_mem_descr_t *)((kmp_uintptr_t)ptr - sizeof(kmp_mem_descr_t)))
             ->ptr_aligned);
+    KMP_COUNT_BLOCK(FAST_ALLOC_self_hit);
     goto end;
   }
   ptr = TCR_SYNC_PTR(this_thr->th.th_free_lists[index].th_free_list_sync);
@@ -1705,8 +1702,10 @@ void *___kmp_fast_allocate(kmp_info_t *this_thr, size_t size KMP_SRC_LOC_DECL) {
         this_thr ==
         ((kmp_mem_descr_t *)((kmp_uintptr_t)ptr - sizeof(kmp_mem_descr_t)))
             ->ptr_aligned);
+    KMP_COUNT_BLOCK(FAST_ALLOC_sync_hit);
     goto end;
   }
+  KMP_COUNT_BLOCK(FAST_ALLOC_miss);
 
 alloc_call:
   // haven't found block in the free lists, thus allocate it
@@ -1755,20 +1754,16 @@ void ___kmp_fast_free(kmp_info_t *this_thr, void *ptr KMP_SRC_LOC_DECL) {
   KE_TRACE(26, ("   __kmp_fast_free:     size_aligned=%d\n",
                 (int)descr->size_aligned));
 
-  size = descr->size_aligned; // 2, 4, 16, 64, 65, 66, ... cache lines
+  size = descr->size_aligned; // 2, 4, 8, ..., 64, 65, 66, ... cache lines
 
   idx = DCACHE_LINE * 2; // 2 cache lines is minimal size of block
-  if (idx == size) {
-    index = 0; // 2 cache lines
-  } else if ((idx <<= 1) == size) {
-    index = 1; // 4 cache lines
-  } else if ((idx <<= 2) == size) {
-    index = 2; // 16 cache lines
-  } else if ((idx <<= 2) == size) {
-    index = 3; // 64 cache lines
-  } else {
-    KMP_DEBUG_ASSERT(size > DCACHE_LINE * 64);
-    goto free_call; // 65 or more cache lines ( > 8KB )
+  for (index = 0; index < NUM_LISTS; ++index, idx <<= 1) {
+    if (idx == size)
+      break; // 2 << index cache lines
+  }
+  if (index == NUM_LISTS) {
+    KMP_DEBUG_ASSERT(size > (DCACHE_LINE << NUM_LISTS));
+    goto free_call; // too large for the free lists
   }
 
   alloc_thr = (kmp_info_t *)descr->ptr_aligned; // get thread owning the block
@@ -1777,6 +1772,7 @@ void ___kmp_fast_free(kmp_info_t *this_thr, void *ptr KMP_SRC_LOC_DECL) {
     *((void **)ptr) = this_thr->th.th_free_lists[index].th_free_list_self;
     this_thr->th.th_free_lists[index].th_free_list_self = ptr;
   } else {
+    KMP_COUNT_BLOCK(FAST_FREE_remote);
     void *head = this_thr->th.th_free_lists[index].th_free_list_other;
     if (head == NULL) {
       // Create new free list
@@ -1815,6 +1811,7 @@ void ___kmp_fast_free(kmp_info_t *this_thr, void *ptr KMP_SRC_LOC_DECL) {
           next = *((void **)next);
         }
         KMP_DEBUG_ASSERT(q_th != NULL);
+        KMP_COUNT_BLOCK(FAST_FREE_remote_batch);
         // push block to owner's sync free list
         old_ptr = TCR_PTR(q_th->th.th_free_lists[index].th_free_list_sync);
         /* the next pointer must be set before setting free_list to ptr to avoid
@@ -573,30 +573,8 @@ KMP_ALIGN(128)
 
 // Control access to all user coded atomics in Gnu compat mode
 kmp_atomic_lock_t __kmp_atomic_lock;
-// Control access to all user coded atomics for 1-byte fixed data types
-kmp_atomic_lock_t __kmp_atomic_lock_1i;
-// Control access to all user coded atomics for 2-byte fixed data types
-kmp_atomic_lock_t __kmp_atomic_lock_2i;
-// Control access to all user coded atomics for 4-byte fixed data types
-kmp_atomic_lock_t __kmp_atomic_lock_4i;
-// Control access to all user coded atomics for kmp_real32 data type
-kmp_atomic_lock_t __kmp_atomic_lock_4r;
-// Control access to all user coded atomics for 8-byte fixed data types
-kmp_atomic_lock_t __kmp_atomic_lock_8i;
-// Control access to all user coded atomics for kmp_real64 data type
-kmp_atomic_lock_t __kmp_atomic_lock_8r;
-// Control access to all user coded atomics for complex byte data type
-kmp_atomic_lock_t __kmp_atomic_lock_8c;
-// Control access to all user coded atomics for long double data type
-kmp_atomic_lock_t __kmp_atomic_lock_10r;
-// Control access to all user coded atomics for _Quad data type
-kmp_atomic_lock_t __kmp_atomic_lock_16r;
-// Control access to all user coded atomics for double complex data type
-kmp_atomic_lock_t __kmp_atomic_lock_16c;
-// Control access to all user coded atomics for long double complex type
-kmp_atomic_lock_t __kmp_atomic_lock_20c;
-// Control access to all user coded atomics for _Quad complex data type
-kmp_atomic_lock_t __kmp_atomic_lock_32c;
+// Control access to all other user coded atomics, hashed by address
+kmp_atomic_lock_t __kmp_atomic_lock_table[KMP_ATOMIC_LOCK_TABLE_SIZE];
 
 /* 2007-03-02:
    Without "volatile" specifier in OP_CMPXCHG and MIN_MAX_CMPXCHG we have a bug
@@ -699,20 +677,21 @@ static inline void operator/=(kmp_cmplx128_a16_t &lhs,
     KA_TRACE(100, ("__kmpc_atomic_" #TYPE_ID "_" #OP_ID ": T#%d\n", gtid));
 
 // ------------------------------------------------------------------------
-// Lock variables used for critical sections for various size operands
-#define ATOMIC_LOCK0 __kmp_atomic_lock // all types, for Gnu compat
-#define ATOMIC_LOCK1i __kmp_atomic_lock_1i // char
-#define ATOMIC_LOCK2i __kmp_atomic_lock_2i // short
-#define ATOMIC_LOCK4i __kmp_atomic_lock_4i // long int
-#define ATOMIC_LOCK4r __kmp_atomic_lock_4r // float
-#define ATOMIC_LOCK8i __kmp_atomic_lock_8i // long long int
-#define ATOMIC_LOCK8r __kmp_atomic_lock_8r // double
-#define ATOMIC_LOCK8c __kmp_atomic_lock_8c // float complex
-#define ATOMIC_LOCK10r __kmp_atomic_lock_10r // long double
-#define ATOMIC_LOCK16r __kmp_atomic_lock_16r // _Quad
-#define ATOMIC_LOCK16c __kmp_atomic_lock_16c // double complex
-#define ATOMIC_LOCK20c __kmp_atomic_lock_20c // long double complex
-#define ATOMIC_LOCK32c __kmp_atomic_lock_32c // _Quad complex
+// Lock variables used for critical sections for various size operands; all
+// but the Gnu compat lock are picked by the address of the operand
+#define ATOMIC_LOCK0(ADDR) (&__kmp_atomic_lock) // all types, for Gnu compat
+#define ATOMIC_LOCK1i(ADDR) __kmp_get_atomic_lock(ADDR) // char
+#define ATOMIC_LOCK2i(ADDR) __kmp_get_atomic_lock(ADDR) // short
+#define ATOMIC_LOCK4i(ADDR) __kmp_get_atomic_lock(ADDR) // long int
+#define ATOMIC_LOCK4r(ADDR) __kmp_get_atomic_lock(ADDR) // float
+#define ATOMIC_LOCK8i(ADDR) __kmp_get_atomic_lock(ADDR) // long long int
+#define ATOMIC_LOCK8r(ADDR) __kmp_get_atomic_lock(ADDR) // double
+#define ATOMIC_LOCK8c(ADDR) __kmp_get_atomic_lock(ADDR) // float complex
+#define ATOMIC_LOCK10r(ADDR) __kmp_get_atomic_lock(ADDR) // long double
+#define ATOMIC_LOCK16r(ADDR) __kmp_get_atomic_lock(ADDR) // _Quad
+#define ATOMIC_LOCK16c(ADDR) __kmp_get_atomic_lock(ADDR) // double complex
+#define ATOMIC_LOCK20c(ADDR) __kmp_get_atomic_lock(ADDR) // long double complex
+#define ATOMIC_LOCK32c(ADDR) __kmp_get_atomic_lock(ADDR) // _Quad complex
 
 // ------------------------------------------------------------------------
 // Operation on *lhs, rhs bound by critical section
@@ -721,11 +700,11 @@ static inline void operator/=(kmp_cmplx128_a16_t &lhs,
 // Note: don't check gtid as it should always be valid
 // 1, 2-byte - expect valid parameter, other - check before this macro
 #define OP_CRITICAL(OP, LCK_ID)                                                \
-  __kmp_acquire_atomic_lock(&ATOMIC_LOCK##LCK_ID, gtid);                       \
+  __kmp_acquire_atomic_lock(ATOMIC_LOCK##LCK_ID(lhs), gtid);                   \
                                                                                \
   (*lhs) OP(rhs);                                                              \
                                                                                \
-  __kmp_release_atomic_lock(&ATOMIC_LOCK##LCK_ID, gtid);
+  __kmp_release_atomic_lock(ATOMIC_LOCK##LCK_ID(lhs), gtid);
 
 // ------------------------------------------------------------------------
 // For GNU compatibility, we may need to use a critical section,
@@ -1082,12 +1061,12 @@ ATOMIC_CMPX_L(fixed8, orl, kmp_int64, 64, ||, 8i, 7,
 // MIN and MAX need separate macros
 // OP - operator to check if we need any actions?
 #define MIN_MAX_CRITSECT(OP, LCK_ID)                                           \
-  __kmp_acquire_atomic_lock(&ATOMIC_LOCK##LCK_ID, gtid);                       \
+  __kmp_acquire_atomic_lock(ATOMIC_LOCK##LCK_ID(lhs), gtid);                   \
                                                                                \
   if (*lhs OP rhs) { /* still need actions? */                                 \
     *lhs = rhs;                                                                \
   }                                                                            \
-  __kmp_release_atomic_lock(&ATOMIC_LOCK##LCK_ID, gtid);
+  __kmp_release_atomic_lock(ATOMIC_LOCK##LCK_ID(lhs), gtid);
 
 // -------------------------------------------------------------------------
 #ifdef KMP_GOMP_COMPAT
@@ -1358,11 +1337,11 @@ ATOMIC_CRITICAL(cmplx16, div_a16, kmp_cmplx128_a16_t, /, 32c,
 // Note: don't check gtid as it should always be valid
 // 1, 2-byte - expect valid parameter, other - check before this macro
 #define OP_CRITICAL_REV(OP, LCK_ID)                                            \
-  __kmp_acquire_atomic_lock(&ATOMIC_LOCK##LCK_ID, gtid);                       \
+  __kmp_acquire_atomic_lock(ATOMIC_LOCK##LCK_ID(lhs), gtid);                   \
                                                                                \
   (*lhs) = (rhs)OP(*lhs);                                                      \
                                                                                \
-  __kmp_release_atomic_lock(&ATOMIC_LOCK##LCK_ID, gtid);
+  __kmp_release_atomic_lock(ATOMIC_LOCK##LCK_ID(lhs), gtid);
 
 #ifdef KMP_GOMP_COMPAT
 #define OP_GOMP_CRITICAL_REV(OP, FLAG)                                         \
@@ -1906,11 +1885,11 @@ ATOMIC_CMPXCHG_CMPLX(cmplx4, kmp_cmplx32, div, 64, /, cmplx8, kmp_cmplx64, 8c,
 // Note: don't check gtid as it should always be valid
 // 1, 2-byte - expect valid parameter, other - check before this macro
 #define OP_CRITICAL_READ(OP, LCK_ID)                                           \
-  __kmp_acquire_atomic_lock(&ATOMIC_LOCK##LCK_ID, gtid);                       \
+  __kmp_acquire_atomic_lock(ATOMIC_LOCK##LCK_ID(loc), gtid);                   \
                                                                                \
   new_value = (*loc);                                                          \
                                                                                \
-  __kmp_release_atomic_lock(&ATOMIC_LOCK##LCK_ID, gtid);
+  __kmp_release_atomic_lock(ATOMIC_LOCK##LCK_ID(loc), gtid);
 
 // -------------------------------------------------------------------------
 #ifdef KMP_GOMP_COMPAT
@@ -1960,11 +1939,11 @@ ATOMIC_CMPXCHG_CMPLX(cmplx4, kmp_cmplx32, div, 64, /, cmplx8, kmp_cmplx64, 8c,
 #if (KMP_OS_WINDOWS)
 
 #define OP_CRITICAL_READ_WRK(OP, LCK_ID)                                       \
-  __kmp_acquire_atomic_lock(&ATOMIC_LOCK##LCK_ID, gtid);                       \
+  __kmp_acquire_atomic_lock(ATOMIC_LOCK##LCK_ID(loc), gtid);                   \
                                                                                \
   (*out) = (*loc);                                                             \
                                                                                \
-  __kmp_release_atomic_lock(&ATOMIC_LOCK##LCK_ID, gtid);
+  __kmp_release_atomic_lock(ATOMIC_LOCK##LCK_ID(loc), gtid);
 // ------------------------------------------------------------------------
 #ifdef KMP_GOMP_COMPAT
 #define OP_GOMP_CRITICAL_READ_WRK(OP, FLAG)                                    \
@@ -2164,7 +2143,7 @@ ATOMIC_CRITICAL_WR(cmplx16, a16_wr, kmp_cmplx128_a16_t, =, 32c,
 // Note: don't check gtid as it should always be valid
 // 1, 2-byte - expect valid parameter, other - check before this macro
 #define OP_CRITICAL_CPT(OP, LCK_ID)                                            \
-  __kmp_acquire_atomic_lock(&ATOMIC_LOCK##LCK_ID, gtid);                       \
+  __kmp_acquire_atomic_lock(ATOMIC_LOCK##LCK_ID(lhs), gtid);                   \
                                                                                \
   if (flag) {                                                                  \
     (*lhs) OP rhs;                                                             \
@@ -2174,7 +2153,7 @@ ATOMIC_CRITICAL_WR(cmplx16, a16_wr, kmp_cmplx128_a16_t, =, 32c,
     (*lhs) OP rhs;                                                             \
   }                                                                            \
                                                                                \
-  __kmp_release_atomic_lock(&ATOMIC_LOCK##LCK_ID, gtid);                       \
+  __kmp_release_atomic_lock(ATOMIC_LOCK##LCK_ID(lhs), gtid);                   \
   return new_value;
 
 // ------------------------------------------------------------------------
@@ -2500,14 +2479,14 @@ ATOMIC_CRITICAL_CPT_MIX(float10, long double, div_cpt, /, fp, _Quad, 10r,
 // Note: don't check gtid as it should always be valid
 // 1, 2-byte - expect valid parameter, other - check before this macro
 #define OP_CRITICAL_L_CPT(OP, LCK_ID)                                          \
-  __kmp_acquire_atomic_lock(&ATOMIC_LOCK##LCK_ID, gtid);                       \
+  __kmp_acquire_atomic_lock(ATOMIC_LOCK##LCK_ID(lhs), gtid);                   \
                                                                                \
   if (flag) {                                                                  \
     new_value OP rhs;                                                          \
   } else                                                                       \
     new_value = (*lhs);                                                        \
                                                                                \
-  __kmp_release_atomic_lock(&ATOMIC_LOCK##LCK_ID, gtid);
+  __kmp_release_atomic_lock(ATOMIC_LOCK##LCK_ID(lhs), gtid);
 
 // ------------------------------------------------------------------------
 #ifdef KMP_GOMP_COMPAT
@@ -2557,7 +2536,7 @@ ATOMIC_CMPX_L_CPT(fixed8, orl_cpt, kmp_int64, 64, ||,
 // MIN and MAX need separate macros
 // OP - operator to check if we need any actions?
 #define MIN_MAX_CRITSECT_CPT(OP, LCK_ID)                                       \
-  __kmp_acquire_atomic_lock(&ATOMIC_LOCK##LCK_ID, gtid);                       \
+  __kmp_acquire_atomic_lock(ATOMIC_LOCK##LCK_ID(lhs), gtid);                   \
                                                                                \
   if (*lhs OP rhs) { /* still need actions? */                                 \
     old_value = *lhs;                                                          \
@@ -2567,7 +2546,7 @@ ATOMIC_CMPX_L_CPT(fixed8, orl_cpt, kmp_int64, 64, ||,
     else                                                                       \
       new_value = old_value;                                                   \
   }                                                                            \
-  __kmp_release_atomic_lock(&ATOMIC_LOCK##LCK_ID, gtid);                       \
+  __kmp_release_atomic_lock(ATOMIC_LOCK##LCK_ID(lhs), gtid);                   \
   return new_value;
 
 // -------------------------------------------------------------------------
@@ -2716,7 +2695,7 @@ ATOMIC_CMPX_EQV_CPT(fixed8, eqv_cpt, kmp_int64, 64, ^~,
 // Workaround for cmplx4. Regular routines with return value don't work
 // on Win_32e. Let's return captured values through the additional parameter.
 #define OP_CRITICAL_CPT_WRK(OP, LCK_ID)                                        \
-  __kmp_acquire_atomic_lock(&ATOMIC_LOCK##LCK_ID, gtid);                       \
+  __kmp_acquire_atomic_lock(ATOMIC_LOCK##LCK_ID(lhs), gtid);                   \
                                                                                \
   if (flag) {                                                                  \
     (*lhs) OP rhs;                                                             \
@@ -2726,7 +2705,7 @@ ATOMIC_CMPX_EQV_CPT(fixed8, eqv_cpt, kmp_int64, 64, ^~,
     (*lhs) OP rhs;                                                             \
   }                                                                            \
                                                                                \
-  __kmp_release_atomic_lock(&ATOMIC_LOCK##LCK_ID, gtid);                       \
+  __kmp_release_atomic_lock(ATOMIC_LOCK##LCK_ID(lhs), gtid);                   \
   return;
 // ------------------------------------------------------------------------
 
@@ -2849,7 +2828,7 @@ ATOMIC_CRITICAL_CPT(cmplx16, div_a16_cpt, kmp_cmplx128_a16_t, /, 32c,
 // Note: don't check gtid as it should always be valid
 // 1, 2-byte - expect valid parameter, other - check before this macro
 #define OP_CRITICAL_CPT_REV(OP, LCK_ID)                                        \
-  __kmp_acquire_atomic_lock(&ATOMIC_LOCK##LCK_ID, gtid);                       \
+  __kmp_acquire_atomic_lock(ATOMIC_LOCK##LCK_ID(lhs), gtid);                   \
                                                                                \
   if (flag) {                                                                  \
     /*temp_val = (*lhs);*/                                                     \
@@ -2859,7 +2838,7 @@ ATOMIC_CRITICAL_CPT(cmplx16, div_a16_cpt, kmp_cmplx128_a16_t, /, 32c,
     new_value = (*lhs);                                                        \
     (*lhs) = (rhs)OP(*lhs);                                                    \
   }                                                                            \
-  __kmp_release_atomic_lock(&ATOMIC_LOCK##LCK_ID, gtid);                       \
+  __kmp_release_atomic_lock(ATOMIC_LOCK##LCK_ID(lhs), gtid);                   \
   return new_value;
 
 // ------------------------------------------------------------------------
@@ -3010,7 +2989,7 @@ ATOMIC_CRITICAL_CPT_REV(float16, div_a16_cpt_rev, Quad_a16_t, /, 16r,
 // Workaround for cmplx4. Regular routines with return value don't work
 // on Win_32e. Let's return captured values through the additional parameter.
 #define OP_CRITICAL_CPT_REV_WRK(OP, LCK_ID)                                    \
-  __kmp_acquire_atomic_lock(&ATOMIC_LOCK##LCK_ID, gtid);                       \
+  __kmp_acquire_atomic_lock(ATOMIC_LOCK##LCK_ID(lhs), gtid);                   \
                                                                                \
   if (flag) {                                                                  \
     (*lhs) = (rhs)OP(*lhs);                                                    \
@@ -3020,7 +2999,7 @@ ATOMIC_CRITICAL_CPT_REV(float16, div_a16_cpt_rev, Quad_a16_t, /, 16r,
     (*lhs) = (rhs)OP(*lhs);                                                    \
   }                                                                            \
                                                                                \
-  __kmp_release_atomic_lock(&ATOMIC_LOCK##LCK_ID, gtid);                       \
+  __kmp_release_atomic_lock(ATOMIC_LOCK##LCK_ID(lhs), gtid);                   \
   return;
 // ------------------------------------------------------------------------
 
@@ -3169,12 +3148,12 @@ ATOMIC_CRITICAL_CPT_REV_MIX(float10, long double, div_cpt_rev, /, fp, _Quad,
     KA_TRACE(100, ("__kmpc_atomic_" #TYPE_ID "_swp: T#%d\n", gtid));
 
 #define CRITICAL_SWP(LCK_ID)                                                   \
-  __kmp_acquire_atomic_lock(&ATOMIC_LOCK##LCK_ID, gtid);                       \
+  __kmp_acquire_atomic_lock(ATOMIC_LOCK##LCK_ID(lhs), gtid);                   \
                                                                                \
   old_value = (*lhs);                                                          \
   (*lhs) = rhs;                                                                \
                                                                                \
-  __kmp_release_atomic_lock(&ATOMIC_LOCK##LCK_ID, gtid);                       \
+  __kmp_release_atomic_lock(ATOMIC_LOCK##LCK_ID(lhs), gtid);                   \
   return old_value;
 
 // ------------------------------------------------------------------------
@@ -3272,12 +3251,12 @@ ATOMIC_XCHG_FLOAT_SWP(float8, kmp_real64, 64,
     KA_TRACE(100, ("__kmpc_atomic_" #TYPE_ID "_swp: T#%d\n", gtid));
 
 #define CRITICAL_SWP_WRK(LCK_ID)                                               \
-  __kmp_acquire_atomic_lock(&ATOMIC_LOCK##LCK_ID, gtid);                       \
+  __kmp_acquire_atomic_lock(ATOMIC_LOCK##LCK_ID(lhs), gtid);                   \
                                                                                \
   tmp = (*lhs);                                                                \
   (*lhs) = (rhs);                                                              \
   (*out) = tmp;                                                                \
-  __kmp_release_atomic_lock(&ATOMIC_LOCK##LCK_ID, gtid);                       \
+  __kmp_release_atomic_lock(ATOMIC_LOCK##LCK_ID(lhs), gtid);                   \
   return;
 // ------------------------------------------------------------------------
 
@@ -3367,7 +3346,7 @@ void __kmpc_atomic_1(ident_t *id_ref, int gtid, void *lhs, void *rhs,
       __kmp_acquire_atomic_lock(&__kmp_atomic_lock, gtid);
     } else
 #endif /* KMP_GOMP_COMPAT */
-      __kmp_acquire_atomic_lock(&__kmp_atomic_lock_1i, gtid);
+      __kmp_acquire_atomic_lock(__kmp_get_atomic_lock(lhs), gtid);
 
     (*f)(lhs, lhs, rhs);
 
@@ -3376,7 +3355,7 @@ void __kmpc_atomic_1(ident_t *id_ref, int gtid, void *lhs, void *rhs,
       __kmp_release_atomic_lock(&__kmp_atomic_lock, gtid);
     } else
 #endif /* KMP_GOMP_COMPAT */
-      __kmp_release_atomic_lock(&__kmp_atomic_lock_1i, gtid);
+      __kmp_release_atomic_lock(__kmp_get_atomic_lock(lhs), gtid);
   }
 }
 
@@ -3414,7 +3393,7 @@ void __kmpc_atomic_2(ident_t *id_ref, int gtid, void *lhs, void *rhs,
       __kmp_acquire_atomic_lock(&__kmp_atomic_lock, gtid);
     } else
 #endif /* KMP_GOMP_COMPAT */
-      __kmp_acquire_atomic_lock(&__kmp_atomic_lock_2i, gtid);
+      __kmp_acquire_atomic_lock(__kmp_get_atomic_lock(lhs), gtid);
 
     (*f)(lhs, lhs, rhs);
 
@@ -3423,7 +3402,7 @@ void __kmpc_atomic_2(ident_t *id_ref, int gtid, void *lhs, void *rhs,
       __kmp_release_atomic_lock(&__kmp_atomic_lock, gtid);
     } else
 #endif /* KMP_GOMP_COMPAT */
-      __kmp_release_atomic_lock(&__kmp_atomic_lock_2i, gtid);
+      __kmp_release_atomic_lock(__kmp_get_atomic_lock(lhs), gtid);
   }
 }
 
@@ -3456,7 +3435,7 @@ void __kmpc_atomic_4(ident_t *id_ref, int gtid, void *lhs, void *rhs,
 
     return;
   } else {
-// Use __kmp_atomic_lock_4i for all 4-byte data,
+// Use the address-hashed lock for all 4-byte data,
 // even if it isn't of integer data type.
 
 #ifdef KMP_GOMP_COMPAT
@@ -3464,7 +3443,7 @@ void __kmpc_atomic_4(ident_t *id_ref, int gtid, void *lhs, void *rhs,
       __kmp_acquire_atomic_lock(&__kmp_atomic_lock, gtid);
     } else
 #endif /* KMP_GOMP_COMPAT */
-      __kmp_acquire_atomic_lock(&__kmp_atomic_lock_4i, gtid);
+      __kmp_acquire_atomic_lock(__kmp_get_atomic_lock(lhs), gtid);
 
     (*f)(lhs, lhs, rhs);
 
@@ -3473,7 +3452,7 @@ void __kmpc_atomic_4(ident_t *id_ref, int gtid, void *lhs, void *rhs,
       __kmp_release_atomic_lock(&__kmp_atomic_lock, gtid);
     } else
 #endif /* KMP_GOMP_COMPAT */
-      __kmp_release_atomic_lock(&__kmp_atomic_lock_4i, gtid);
+      __kmp_release_atomic_lock(__kmp_get_atomic_lock(lhs), gtid);
   }
 }
 
@@ -3505,7 +3484,7 @@ void __kmpc_atomic_8(ident_t *id_ref, int gtid, void *lhs, void *rhs,
 
     return;
   } else {
-// Use __kmp_atomic_lock_8i for all 8-byte data,
+// Use the address-hashed lock for all 8-byte data,
 // even if it isn't of integer data type.
 
 #ifdef KMP_GOMP_COMPAT
@@ -3513,7 +3492,7 @@ void __kmpc_atomic_8(ident_t *id_ref, int gtid, void *lhs, void *rhs,
       __kmp_acquire_atomic_lock(&__kmp_atomic_lock, gtid);
     } else
 #endif /* KMP_GOMP_COMPAT */
-      __kmp_acquire_atomic_lock(&__kmp_atomic_lock_8i, gtid);
+      __kmp_acquire_atomic_lock(__kmp_get_atomic_lock(lhs), gtid);
 
     (*f)(lhs, lhs, rhs);
 
@@ -3522,7 +3501,7 @@ void __kmpc_atomic_8(ident_t *id_ref, int gtid, void *lhs, void *rhs,
       __kmp_release_atomic_lock(&__kmp_atomic_lock, gtid);
     } else
 #endif /* KMP_GOMP_COMPAT */
-      __kmp_release_atomic_lock(&__kmp_atomic_lock_8i, gtid);
+      __kmp_release_atomic_lock(__kmp_get_atomic_lock(lhs), gtid);
   }
 }
 
@@ -3535,7 +3514,7 @@ void __kmpc_atomic_10(ident_t *id_ref, int gtid, void *lhs, void *rhs,
     __kmp_acquire_atomic_lock(&__kmp_atomic_lock, gtid);
   } else
 #endif /* KMP_GOMP_COMPAT */
-    __kmp_acquire_atomic_lock(&__kmp_atomic_lock_10r, gtid);
+    __kmp_acquire_atomic_lock(__kmp_get_atomic_lock(lhs), gtid);
 
   (*f)(lhs, lhs, rhs);
 
@@ -3544,7 +3523,7 @@ void __kmpc_atomic_10(ident_t *id_ref, int gtid, void *lhs, void *rhs,
     __kmp_release_atomic_lock(&__kmp_atomic_lock, gtid);
   } else
 #endif /* KMP_GOMP_COMPAT */
-    __kmp_release_atomic_lock(&__kmp_atomic_lock_10r, gtid);
+    __kmp_release_atomic_lock(__kmp_get_atomic_lock(lhs), gtid);
 }
 
 void __kmpc_atomic_16(ident_t *id_ref, int gtid, void *lhs, void *rhs,
@@ -3556,7 +3535,7 @@ void __kmpc_atomic_16(ident_t *id_ref, int gtid, void *lhs, void *rhs,
     __kmp_acquire_atomic_lock(&__kmp_atomic_lock, gtid);
   } else
 #endif /* KMP_GOMP_COMPAT */
-    __kmp_acquire_atomic_lock(&__kmp_atomic_lock_16c, gtid);
+    __kmp_acquire_atomic_lock(__kmp_get_atomic_lock(lhs), gtid);
 
   (*f)(lhs, lhs, rhs);
 
@@ -3565,7 +3544,7 @@ void __kmpc_atomic_16(ident_t *id_ref, int gtid, void *lhs, void *rhs,
     __kmp_release_atomic_lock(&__kmp_atomic_lock, gtid);
   } else
 #endif /* KMP_GOMP_COMPAT */
-    __kmp_release_atomic_lock(&__kmp_atomic_lock_16c, gtid);
+    __kmp_release_atomic_lock(__kmp_get_atomic_lock(lhs), gtid);
 }
 
 void __kmpc_atomic_20(ident_t *id_ref, int gtid, void *lhs, void *rhs,
@@ -3577,7 +3556,7 @@ void __kmpc_atomic_20(ident_t *id_ref, int gtid, void *lhs, void *rhs,
     __kmp_acquire_atomic_lock(&__kmp_atomic_lock, gtid);
   } else
 #endif /* KMP_GOMP_COMPAT */
-    __kmp_acquire_atomic_lock(&__kmp_atomic_lock_20c, gtid);
+    __kmp_acquire_atomic_lock(__kmp_get_atomic_lock(lhs), gtid);
 
   (*f)(lhs, lhs, rhs);
 
@@ -3586,7 +3565,7 @@ void __kmpc_atomic_20(ident_t *id_ref, int gtid, void *lhs, void *rhs,
     __kmp_release_atomic_lock(&__kmp_atomic_lock, gtid);
   } else
 #endif /* KMP_GOMP_COMPAT */
-    __kmp_release_atomic_lock(&__kmp_atomic_lock_20c, gtid);
+    __kmp_release_atomic_lock(__kmp_get_atomic_lock(lhs), gtid);
 }
 
 void __kmpc_atomic_32(ident_t *id_ref, int gtid, void *lhs, void *rhs,
@@ -3598,7 +3577,7 @@ void __kmpc_atomic_32(ident_t *id_ref, int gtid, void *lhs, void *rhs,
     __kmp_acquire_atomic_lock(&__kmp_atomic_lock, gtid);
   } else
 #endif /* KMP_GOMP_COMPAT */
-    __kmp_acquire_atomic_lock(&__kmp_atomic_lock_32c, gtid);
+    __kmp_acquire_atomic_lock(__kmp_get_atomic_lock(lhs), gtid);
 
   (*f)(lhs, lhs, rhs);
 
@@ -3607,7 +3586,7 @@ void __kmpc_atomic_32(ident_t *id_ref, int gtid, void *lhs, void *rhs,
     __kmp_release_atomic_lock(&__kmp_atomic_lock, gtid);
   } else
 #endif /* KMP_GOMP_COMPAT */
-    __kmp_release_atomic_lock(&__kmp_atomic_lock_32c, gtid);
+    __kmp_release_atomic_lock(__kmp_get_atomic_lock(lhs), gtid);
 }
 
 // AC: same two routines as GOMP_atomic_start/end, but will be called by our
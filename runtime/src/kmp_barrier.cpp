@@ -42,6 +42,113 @@
 
 void __kmp_print_structure(void); // Forward declaration
 
+// ----------------------------- Barrier Tuning -------------------------------
+
+// Patterns tried for plain and reduction barriers with KMP_BARRIER_TUNING, in
+// addition to the settings (candidate 0). A candidate uses the same pattern
+// and branch bits for the gather and the release.
+typedef struct kmp_bar_tune_candidate {
+  kmp_bar_pat_e pattern;
+  kmp_uint32 branch_bits;
+} kmp_bar_tune_candidate_t;
+
+static const kmp_bar_tune_candidate_t __kmp_bar_tune_candidates[] = {
+    {bp_linear_bar, 0}, {bp_tree_bar, 1},  {bp_tree_bar, 2},
+    {bp_tree_bar, 3},   {bp_hyper_bar, 1}, {bp_hyper_bar, 2},
+    {bp_hyper_bar, 3},  {bp_dist_bar, 0}};
+
+#define KMP_BAR_TUNE_CANDIDATES                                                \
+  (1 + sizeof(__kmp_bar_tune_candidates) / sizeof(kmp_bar_tune_candidate_t))
+
+// Each thread takes the candidate of the team when it enters the barrier into
+// thr_bar->b_tune, which stays 0 for fork/join barriers and without tuning.
+static inline kmp_bar_pat_e __kmp_bar_gather_pattern(enum barrier_type bt,
+                                                     kmp_bstate_t *thr_bar) {
+  return thr_bar->b_tune ? __kmp_bar_tune_candidates[thr_bar->b_tune - 1].pattern
+                         : __kmp_barrier_gather_pattern[bt];
+}
+
+static inline kmp_bar_pat_e __kmp_bar_release_pattern(enum barrier_type bt,
+                                                      kmp_bstate_t *thr_bar) {
+  return thr_bar->b_tune ? __kmp_bar_tune_candidates[thr_bar->b_tune - 1].pattern
+                         : __kmp_barrier_release_pattern[bt];
+}
+
+static inline kmp_uint32 __kmp_bar_gather_bb(enum barrier_type bt,
+                                             kmp_bstate_t *thr_bar) {
+  return thr_bar->b_tune
+             ? __kmp_bar_tune_candidates[thr_bar->b_tune - 1].branch_bits
+             : __kmp_barrier_gather_branch_bits[bt];
+}
+
+static inline kmp_uint32 __kmp_bar_release_bb(enum barrier_type bt,
+                                              kmp_bstate_t *thr_bar) {
+  return thr_bar->b_tune
+             ? __kmp_bar_tune_candidates[thr_bar->b_tune - 1].branch_bits
+             : __kmp_barrier_release_branch_bits[bt];
+}
+
+// ------------------------- Fork Barrier ICV Copies --------------------------
+
+// Each thread keeps the ICVs of its last fork in th_fixed_icvs of its fork/join
+// barrier state, tagged with their generation in icv_gen. The master takes a
+// new generation for the team only when its ICVs differ from those it pushed
+// last, and a parent copies its fixed ICVs to a child only when the child has
+// another generation. Forking the same hot team with unchanged ICVs then copies
+// no ICVs between threads; each worker only refreshes its implicit task from
+// its own cached copy.
+
+static std::atomic<kmp_uint64> __kmp_icv_gen = ATOMIC_VAR_INIT(0);
+
+static inline bool __kmp_icvs_equal(const kmp_internal_control_t *a,
+                                    const kmp_internal_control_t *b) {
+  return a->serial_nesting_level == b->serial_nesting_level &&
+         a->nested == b->nested && a->dynamic == b->dynamic &&
+         a->bt_set == b->bt_set && a->blocktime == b->blocktime &&
+#if KMP_USE_MONITOR
+         a->bt_intervals == b->bt_intervals &&
+#endif
+         a->nproc == b->nproc && a->max_active_levels == b->max_active_levels &&
+         a->sched.sched == b->sched.sched &&
+#if OMP_40_ENABLED
+         a->proc_bind == b->proc_bind &&
+         a->default_device == b->default_device &&
+#endif
+         a->next == b->next;
+}
+
+// Master: make its fixed ICVs those of its implicit task, in a new generation
+// for the team if they changed.
+static void __kmp_master_fixed_icvs(kmp_team_t *team, kmp_bstate_t *thr_bar) {
+  kmp_internal_control_t *icvs = &team->t.t_implicit_task_taskdata[0].td_icvs;
+  if (thr_bar->icv_gen != 0 && thr_bar->icv_gen == team->t.t_icv_gen &&
+      __kmp_icvs_equal(&thr_bar->th_fixed_icvs, icvs))
+    return;
+  copy_icvs(&thr_bar->th_fixed_icvs, icvs);
+  thr_bar->icv_gen = team->t.t_icv_gen = KMP_ATOMIC_INC(&__kmp_icv_gen) + 1;
+  KA_TRACE(20, ("__kmp_master_fixed_icvs: team %d ICV generation %llu\n",
+                team->t.t_id, thr_bar->icv_gen));
+}
+
+// Parent: bring the fixed ICVs of a child to the parent's generation.
+static inline void __kmp_push_fixed_icvs(kmp_bstate_t *child_bar,
+                                         kmp_bstate_t *thr_bar) {
+  if (child_bar->icv_gen != thr_bar->icv_gen) {
+    copy_icvs(&child_bar->th_fixed_icvs, &thr_bar->th_fixed_icvs);
+    child_bar->icv_gen = thr_bar->icv_gen;
+    KMP_COUNT_BLOCK(ICV_copy);
+  }
+}
+
+// Released worker: set up its implicit task with its fixed ICVs.
+static inline void __kmp_install_fixed_icvs(kmp_team_t *team, int tid,
+                                            kmp_bstate_t *thr_bar) {
+  __kmp_init_implicit_task(team->t.t_ident, team->t.t_threads[tid], team, tid,
+                           FALSE);
+  copy_icvs(&team->t.t_implicit_task_taskdata[tid].td_icvs,
+            &thr_bar->th_fixed_icvs);
+}
+
 // ---------------------------- Barrier Algorithms ----------------------------
 
 // Linear Barrier
@@ -161,22 +268,6 @@ static void __kmp_linear_barrier_release(
                   gtid, team->t.t_id, tid, bt));
 
     if (nproc > 1) {
-#if KMP_BARRIER_ICV_PUSH
-      {
-        KMP_TIME_DEVELOPER_PARTITIONED_BLOCK(USER_icv_copy);
-        if (propagate_icvs) {
-          ngo_load(&team->t.t_implicit_task_taskdata[0].td_icvs);
-          for (i = 1; i < nproc; ++i) {
-            __kmp_init_implicit_task(team->t.t_ident, team->t.t_threads[i],
-                                     team, i, FALSE);
-            ngo_store_icvs(&team->t.t_implicit_task_taskdata[i].td_icvs,
-                           &team->t.t_implicit_task_taskdata[0].td_icvs);
-          }
-          ngo_sync();
-        }
-      }
-#endif // KMP_BARRIER_ICV_PUSH
-
       // Now, release all of the worker threads
       for (i = 1; i < nproc; ++i) {
 #if KMP_CACHE_MANAGE
@@ -184,6 +275,10 @@ static void __kmp_linear_barrier_release(
         if (i + 1 < nproc)
           KMP_CACHE_PREFETCH(&other_threads[i + 1]->th.th_bar[bt].bb.b_go);
 #endif /* KMP_CACHE_MANAGE */
+#if KMP_BARRIER_ICV_PUSH
+        if (propagate_icvs) // push my fixed ICVs to the worker
+          __kmp_push_fixed_icvs(&other_threads[i]->th.th_bar[bt].bb, thr_bar);
+#endif // KMP_BARRIER_ICV_PUSH
         KA_TRACE(
             20,
             ("__kmp_linear_barrier_release: T#%d(%d:%d) releasing T#%d(%d:%d) "
@@ -235,6 +330,13 @@ static void __kmp_linear_barrier_release(
              ("__kmp_linear_barrier_release: T#%d(%d:%d) set go(%p) = %u\n",
               gtid, team->t.t_id, tid, &thr_bar->b_go, KMP_INIT_BARRIER_STATE));
     KMP_MB(); // Flush all pending memory write invalidates.
+#if KMP_BARRIER_ICV_PUSH
+    if (propagate_icvs) { // copy ICVs locally to final dest
+      tid = __kmp_tid_from_gtid(gtid);
+      team = __kmp_threads[gtid]->th.th_team;
+      __kmp_install_fixed_icvs(team, tid, thr_bar);
+    }
+#endif // KMP_BARRIER_ICV_PUSH
   }
   KA_TRACE(
       20,
@@ -252,7 +354,7 @@ __kmp_tree_barrier_gather(enum barrier_type bt, kmp_info_t *this_thr, int gtid,
   kmp_bstate_t *thr_bar = &this_thr->th.th_bar[bt].bb;
   kmp_info_t **other_threads = team->t.t_threads;
   kmp_uint32 nproc = this_thr->th.th_team_nproc;
-  kmp_uint32 branch_bits = __kmp_barrier_gather_branch_bits[bt];
+  kmp_uint32 branch_bits = __kmp_bar_gather_bb(bt, thr_bar);
   kmp_uint32 branch_factor = 1 << branch_bits;
   kmp_uint32 child;
   kmp_uint32 child_tid;
@@ -359,7 +461,7 @@ static void __kmp_tree_barrier_release(
   kmp_team_t *team;
   kmp_bstate_t *thr_bar = &this_thr->th.th_bar[bt].bb;
   kmp_uint32 nproc;
-  kmp_uint32 branch_bits = __kmp_barrier_release_branch_bits[bt];
+  kmp_uint32 branch_bits = __kmp_bar_release_bb(bt, thr_bar);
   kmp_uint32 branch_factor = 1 << branch_bits;
   kmp_uint32 child;
   kmp_uint32 child_tid;
@@ -429,16 +531,8 @@ static void __kmp_tree_barrier_release(
 #endif /* KMP_CACHE_MANAGE */
 
 #if KMP_BARRIER_ICV_PUSH
-      {
-        KMP_TIME_DEVELOPER_PARTITIONED_BLOCK(USER_icv_copy);
-        if (propagate_icvs) {
-          __kmp_init_implicit_task(team->t.t_ident,
-                                   team->t.t_threads[child_tid], team,
-                                   child_tid, FALSE);
-          copy_icvs(&team->t.t_implicit_task_taskdata[child_tid].td_icvs,
-                    &team->t.t_implicit_task_taskdata[0].td_icvs);
-        }
-      }
+      if (propagate_icvs) // push my fixed ICVs to my child
+        __kmp_push_fixed_icvs(child_bar, thr_bar);
 #endif // KMP_BARRIER_ICV_PUSH
       KA_TRACE(20,
                ("__kmp_tree_barrier_release: T#%d(%d:%d) releasing T#%d(%d:%u)"
@@ -454,6 +548,11 @@ static void __kmp_tree_barrier_release(
       child_tid++;
     } while (child <= branch_factor && child_tid < nproc);
   }
+#if KMP_BARRIER_ICV_PUSH
+  if (propagate_icvs &&
+      !KMP_MASTER_TID(tid)) // copy ICVs locally to final dest
+    __kmp_install_fixed_icvs(team, tid, thr_bar);
+#endif
   KA_TRACE(
       20, ("__kmp_tree_barrier_release: T#%d(%d:%d) exit for barrier type %d\n",
            gtid, team->t.t_id, tid, bt));
@@ -470,7 +569,7 @@ __kmp_hyper_barrier_gather(enum barrier_type bt, kmp_info_t *this_thr, int gtid,
   kmp_info_t **other_threads = team->t.t_threads;
   kmp_uint64 new_state = KMP_BARRIER_UNUSED_STATE;
   kmp_uint32 num_threads = this_thr->th.th_team_nproc;
-  kmp_uint32 branch_bits = __kmp_barrier_gather_branch_bits[bt];
+  kmp_uint32 branch_bits = __kmp_bar_gather_bb(bt, thr_bar);
   kmp_uint32 branch_factor = 1 << branch_bits;
   kmp_uint32 offset;
   kmp_uint32 level;
@@ -588,7 +687,7 @@ static void __kmp_hyper_barrier_release(
   kmp_bstate_t *thr_bar = &this_thr->th.th_bar[bt].bb;
   kmp_info_t **other_threads;
   kmp_uint32 num_threads;
-  kmp_uint32 branch_bits = __kmp_barrier_release_branch_bits[bt];
+  kmp_uint32 branch_bits = __kmp_bar_release_bb(bt, thr_bar);
   kmp_uint32 branch_factor = 1 << branch_bits;
   kmp_uint32 child;
   kmp_uint32 child_tid;
@@ -605,12 +704,6 @@ static void __kmp_hyper_barrier_release(
     KA_TRACE(20, ("__kmp_hyper_barrier_release: T#%d(%d:%d) master enter for "
                   "barrier type %d\n",
                   gtid, team->t.t_id, tid, bt));
-#if KMP_BARRIER_ICV_PUSH
-    if (propagate_icvs) { // master already has ICVs in final destination; copy
-      copy_icvs(&thr_bar->th_fixed_icvs,
-                &team->t.t_implicit_task_taskdata[tid].td_icvs);
-    }
-#endif
   } else { // Handle fork barrier workers who aren't part of a team yet
     KA_TRACE(20, ("__kmp_hyper_barrier_release: T#%d wait go(%p) == %u\n", gtid,
                   &thr_bar->b_go, KMP_BARRIER_STATE_BUMP));
@@ -705,7 +798,7 @@ static void __kmp_hyper_barrier_release(
 
 #if KMP_BARRIER_ICV_PUSH
         if (propagate_icvs) // push my fixed ICVs to my child
-          copy_icvs(&child_bar->th_fixed_icvs, &thr_bar->th_fixed_icvs);
+          __kmp_push_fixed_icvs(child_bar, thr_bar);
 #endif // KMP_BARRIER_ICV_PUSH
 
         KA_TRACE(
@@ -724,12 +817,8 @@ static void __kmp_hyper_barrier_release(
   }
 #if KMP_BARRIER_ICV_PUSH
   if (propagate_icvs &&
-      !KMP_MASTER_TID(tid)) { // copy ICVs locally to final dest
-    __kmp_init_implicit_task(team->t.t_ident, team->t.t_threads[tid], team, tid,
-                             FALSE);
-    copy_icvs(&team->t.t_implicit_task_taskdata[tid].td_icvs,
-              &thr_bar->th_fixed_icvs);
-  }
+      !KMP_MASTER_TID(tid)) // copy ICVs locally to final dest
+    __kmp_install_fixed_icvs(team, tid, thr_bar);
 #endif
   KA_TRACE(
       20,
@@ -737,6 +826,215 @@ static void __kmp_hyper_barrier_release(
        gtid, team->t.t_id, tid, bt));
 }
 
+// Dissemination Barrier
+/* In round k of the gather, thread tid signals thread (tid + 2^k) % nproc and
+   waits for thread (tid - 2^k + nproc) % nproc, so after ceil(log2(nproc))
+   rounds every thread knows that all threads have arrived without any thread
+   waiting on more than one flag per round. Barriers of odd and even team
+   arrived state use separate flags: a partner signals the flags of the same
+   parity only after this thread has arrived at the next barrier, by then it
+   has seen and reset them.
+   The flags belong to the thread, not the team, so nested teams use the linear
+   gather: the master of a nested team is still in its outer team, whose
+   threads may already signal it for their next barrier. Teams of more than
+   2^KMP_DIST_BAR_MAX_ROUNDS threads use it as well. */
+static void
+__kmp_dist_barrier_gather(enum barrier_type bt, kmp_info_t *this_thr, int gtid,
+                          int tid, void (*reduce)(void *, void *)
+                                       USE_ITT_BUILD_ARG(void *itt_sync_obj)) {
+  KMP_TIME_DEVELOPER_PARTITIONED_BLOCK(KMP_dist_gather);
+  kmp_team_t *team = this_thr->th.th_team;
+  kmp_bstate_t *thr_bar = &this_thr->th.th_bar[bt].bb;
+  kmp_info_t **other_threads = team->t.t_threads;
+  kmp_uint32 num_threads = this_thr->th.th_team_nproc;
+  kmp_uint64 new_state = team->t.t_bar[bt].b_arrived + KMP_BARRIER_STATE_BUMP;
+  int parity = (int)(new_state >> KMP_BARRIER_BUMP_BIT) & 1;
+  kmp_uint32 round;
+  kmp_uint32 offset;
+
+  KA_TRACE(
+      20,
+      ("__kmp_dist_barrier_gather: T#%d(%d:%d) enter for barrier type %d\n",
+       gtid, team->t.t_id, tid, bt));
+  KMP_DEBUG_ASSERT(this_thr == other_threads[this_thr->th.th_info.ds.ds_tid]);
+  if (team->t.t_active_level != 1 ||
+      num_threads > (1U << KMP_DIST_BAR_MAX_ROUNDS)) {
+    __kmp_linear_barrier_gather(bt, this_thr, gtid, tid,
+                                reduce USE_ITT_BUILD_ARG(itt_sync_obj));
+    return;
+  }
+
+#if USE_ITT_BUILD && USE_ITT_NOTIFY
+  // Barrier imbalance - save arrive time to the thread
+  if (__kmp_forkjoin_frames_mode == 3 || __kmp_forkjoin_frames_mode == 2) {
+    this_thr->th.th_bar_arrive_time = this_thr->th.th_bar_min_time =
+        __itt_get_timestamp();
+  }
+#endif
+  /* The master may finish the gather while other threads are still in their
+     last rounds, and then the team may be deallocated or resized. Look up
+     the partners of all rounds before the first signal.  */
+  kmp_info_t *to_thrs[KMP_DIST_BAR_MAX_ROUNDS];
+  kmp_uint32 rounds = 0;
+  for (offset = 1; offset < num_threads; offset <<= 1)
+    to_thrs[rounds++] = other_threads[(tid + offset) % num_threads];
+  /* Keep the arrived state in step for the other gather patterns. Once this
+     thread signals, the master may go on to a barrier of another pattern and
+     sleep on this flag, a later plain store would clear its sleep bit. */
+  if (!KMP_MASTER_TID(tid))
+    thr_bar->b_arrived = new_state;
+
+  for (round = 0; round < rounds; round++) {
+    kmp_info_t *to_thr = to_thrs[round];
+    kmp_bstate_t *to_bar = &to_thr->th.th_bar[bt].bb;
+
+    KA_TRACE(20, ("__kmp_dist_barrier_gather: T#%d(%d:%d) round %u signals "
+                  "T#%d dist(%p)\n",
+                  gtid, team->t.t_id, tid, round,
+                  to_thr->th.th_info.ds.ds_gtid,
+                  &to_bar->b_dist[parity][round]));
+    ANNOTATE_BARRIER_BEGIN(this_thr);
+    kmp_flag_64 to_flag(&to_bar->b_dist[parity][round], to_thr);
+    to_flag.release();
+
+    KA_TRACE(20, ("__kmp_dist_barrier_gather: T#%d round %u wait dist(%p) == "
+                  "%u\n",
+                  gtid, round, &thr_bar->b_dist[parity][round],
+                  KMP_BARRIER_STATE_BUMP));
+    kmp_flag_64 flag(&thr_bar->b_dist[parity][round], KMP_BARRIER_STATE_BUMP);
+    flag.wait(this_thr, FALSE USE_ITT_BUILD_ARG(itt_sync_obj));
+    TCW_8(thr_bar->b_dist[parity][round], KMP_INIT_BARRIER_STATE);
+  }
+  KMP_MB();
+
+  if (KMP_MASTER_TID(tid)) {
+    // Every thread arrived; the partial results are combined here as the
+    // rounds do not form a reduction tree.
+    if (reduce) {
+      for (kmp_uint32 i = 1; i < num_threads; ++i) {
+        KA_TRACE(100,
+                 ("__kmp_dist_barrier_gather: T#%d(%d:%d) += T#%d(%d:%u)\n",
+                  gtid, team->t.t_id, tid, __kmp_gtid_from_tid(i, team),
+                  team->t.t_id, i));
+        ANNOTATE_REDUCE_AFTER(reduce);
+        (*reduce)(this_thr->th.th_local.reduce_data,
+                  other_threads[i]->th.th_local.reduce_data);
+        ANNOTATE_REDUCE_BEFORE(reduce);
+        ANNOTATE_REDUCE_BEFORE(&team->t.t_bar);
+      }
+    }
+    team->t.t_bar[bt].b_arrived = new_state;
+    KA_TRACE(20, ("__kmp_dist_barrier_gather: T#%d(%d:%d) set team %d "
+                  "arrived(%p) = %llu\n",
+                  gtid, team->t.t_id, tid, team->t.t_id,
+                  &team->t.t_bar[bt].b_arrived, new_state));
+    KA_TRACE(20,
+             ("__kmp_dist_barrier_gather: T#%d(%d:%d) exit for barrier type "
+              "%d\n",
+              gtid, team->t.t_id, tid, bt));
+  } else {
+    KA_TRACE(20, ("__kmp_dist_barrier_gather: T#%d exit for barrier type %d\n",
+                  gtid, bt));
+  }
+}
+
+/* Release in the same rounds, last one first: a thread released in round k
+   releases thread tid + 2^j for each round j < k, and the master for every
+   round. Nobody releases more than log2(nproc) threads. */
+static void __kmp_dist_barrier_release(
+    enum barrier_type bt, kmp_info_t *this_thr, int gtid, int tid,
+    int propagate_icvs USE_ITT_BUILD_ARG(void *itt_sync_obj)) {
+  KMP_TIME_DEVELOPER_PARTITIONED_BLOCK(KMP_dist_release);
+  kmp_team_t *team;
+  kmp_bstate_t *thr_bar = &this_thr->th.th_bar[bt].bb;
+  kmp_info_t **other_threads;
+  kmp_uint32 num_threads;
+  kmp_uint32 offset;
+
+  if (KMP_MASTER_TID(tid)) { // master
+    team = __kmp_threads[gtid]->th.th_team;
+    KMP_DEBUG_ASSERT(team != NULL);
+    KA_TRACE(20, ("__kmp_dist_barrier_release: T#%d(%d:%d) master enter for "
+                  "barrier type %d\n",
+                  gtid, team->t.t_id, tid, bt));
+  } else { // Handle fork barrier workers who aren't part of a team yet
+    KA_TRACE(20, ("__kmp_dist_barrier_release: T#%d wait go(%p) == %u\n", gtid,
+                  &thr_bar->b_go, KMP_BARRIER_STATE_BUMP));
+    // Wait for the thread of the previous round to release us
+    kmp_flag_64 flag(&thr_bar->b_go, KMP_BARRIER_STATE_BUMP);
+    flag.wait(this_thr, TRUE USE_ITT_BUILD_ARG(itt_sync_obj));
+    ANNOTATE_BARRIER_END(this_thr);
+#if USE_ITT_BUILD && USE_ITT_NOTIFY
+    if ((__itt_sync_create_ptr && itt_sync_obj == NULL) || KMP_ITT_DEBUG) {
+      // In fork barrier where we could not get the object reliably
+      itt_sync_obj = __kmp_itt_barrier_object(gtid, bs_forkjoin_barrier, 0, -1);
+      // Cancel wait on previous parallel region...
+      __kmp_itt_task_starting(itt_sync_obj);
+
+      if (bt == bs_forkjoin_barrier && TCR_4(__kmp_global.g.g_done))
+        return;
+
+      itt_sync_obj = __kmp_itt_barrier_object(gtid, bs_forkjoin_barrier);
+      if (itt_sync_obj != NULL)
+        // Call prepare as early as possible for "new" barrier
+        __kmp_itt_task_finished(itt_sync_obj);
+    } else
+#endif /* USE_ITT_BUILD && USE_ITT_NOTIFY */
+        // Early exit for reaping threads releasing forkjoin barrier
+        if (bt == bs_forkjoin_barrier && TCR_4(__kmp_global.g.g_done))
+      return;
+
+    // The worker thread may now assume that the team is valid.
+    team = __kmp_threads[gtid]->th.th_team;
+    KMP_DEBUG_ASSERT(team != NULL);
+    tid = __kmp_tid_from_gtid(gtid);
+
+    TCW_4(thr_bar->b_go, KMP_INIT_BARRIER_STATE);
+    KA_TRACE(20,
+             ("__kmp_dist_barrier_release: T#%d(%d:%d) set go(%p) = %u\n",
+              gtid, team->t.t_id, tid, &thr_bar->b_go, KMP_INIT_BARRIER_STATE));
+    KMP_MB(); // Flush all pending memory write invalidates.
+  }
+  num_threads = this_thr->th.th_team_nproc;
+  other_threads = team->t.t_threads;
+
+  // Find the round this thread was released in
+  for (offset = 1; offset < num_threads && (tid & offset) == 0; offset <<= 1)
+    ;
+  // Release the threads of the earlier rounds, farthest first
+  for (offset >>= 1; offset != 0; offset >>= 1) {
+    kmp_uint32 child_tid = tid + offset;
+    if (child_tid >= num_threads)
+      continue;
+    kmp_info_t *child_thr = other_threads[child_tid];
+    kmp_bstate_t *child_bar = &child_thr->th.th_bar[bt].bb;
+#if KMP_BARRIER_ICV_PUSH
+    if (propagate_icvs) // push my fixed ICVs to my child
+      __kmp_push_fixed_icvs(child_bar, thr_bar);
+#endif // KMP_BARRIER_ICV_PUSH
+    KA_TRACE(
+        20,
+        ("__kmp_dist_barrier_release: T#%d(%d:%d) releasing T#%d(%d:%u)"
+         "go(%p): %u => %u\n",
+         gtid, team->t.t_id, tid, __kmp_gtid_from_tid(child_tid, team),
+         team->t.t_id, child_tid, &child_bar->b_go, child_bar->b_go,
+         child_bar->b_go + KMP_BARRIER_STATE_BUMP));
+    // Release child from barrier
+    ANNOTATE_BARRIER_BEGIN(child_thr);
+    kmp_flag_64 flag(&child_bar->b_go, child_thr);
+    flag.release();
+  }
+#if KMP_BARRIER_ICV_PUSH
+  if (propagate_icvs &&
+      !KMP_MASTER_TID(tid)) // copy ICVs locally to final dest
+    __kmp_install_fixed_icvs(team, tid, thr_bar);
+#endif
+  KA_TRACE(
+      20,
+      ("__kmp_dist_barrier_release: T#%d(%d:%d) exit for barrier type %d\n",
+       gtid, team->t.t_id, tid, bt));
+}
+
 // Hierarchical Barrier
 
 // Initialize thread barrier data
@@ -1082,25 +1380,27 @@ static void __kmp_hierarchical_barrier_release(
   if (propagate_icvs) {
     __kmp_init_implicit_task(team->t.t_ident, team->t.t_threads[tid], team, tid,
                              FALSE);
-    if (KMP_MASTER_TID(
-            tid)) { // master already has copy in final destination; copy
-      copy_icvs(&thr_bar->th_fixed_icvs,
-                &team->t.t_implicit_task_taskdata[tid].td_icvs);
-    } else if (__kmp_dflt_blocktime == KMP_MAX_BLOCKTIME &&
-               thr_bar->use_oncore_barrier) { // optimization for inf blocktime
-      if (!thr_bar->my_level) // I'm a leaf in the hierarchy (my_level==0)
-        // leaves (on-core children) pull parent's fixed ICVs directly to local
-        // ICV store
-        copy_icvs(&team->t.t_implicit_task_taskdata[tid].td_icvs,
-                  &thr_bar->parent_bar->th_fixed_icvs);
-      // non-leaves will get ICVs piggybacked with b_go via NGO store
-    } else { // blocktime is not infinite; pull ICVs from parent's fixed ICVs
-      if (thr_bar->my_level) // not a leaf; copy ICVs to my fixed ICVs child can
-        // access
-        copy_icvs(&thr_bar->th_fixed_icvs, &thr_bar->parent_bar->th_fixed_icvs);
-      else // leaves copy parent's fixed ICVs directly to local ICV store
-        copy_icvs(&team->t.t_implicit_task_taskdata[tid].td_icvs,
-                  &thr_bar->parent_bar->th_fixed_icvs);
+    // The master already has its fixed ICVs, see __kmp_master_fixed_icvs
+    if (!KMP_MASTER_TID(tid)) {
+      if (__kmp_dflt_blocktime == KMP_MAX_BLOCKTIME &&
+          thr_bar->use_oncore_barrier) { // optimization for inf blocktime
+        if (!thr_bar->my_level) { // I'm a leaf in the hierarchy (my_level==0)
+          // leaves (on-core children) pull parent's fixed ICVs if they
+          // changed, and copy them to local ICV store
+          if (thr_bar->icv_gen != team->t.t_icv_gen)
+            __kmp_push_fixed_icvs(thr_bar, thr_bar->parent_bar);
+          copy_icvs(&team->t.t_implicit_task_taskdata[tid].td_icvs,
+                    &thr_bar->th_fixed_icvs);
+        }
+        // non-leaves will get ICVs piggybacked with b_go via NGO store
+      } else { // blocktime is not infinite; pull ICVs from parent's fixed ICVs
+        // if they changed, into my fixed ICVs that my children can access
+        if (thr_bar->icv_gen != team->t.t_icv_gen)
+          __kmp_push_fixed_icvs(thr_bar, thr_bar->parent_bar);
+        if (!thr_bar->my_level) // leaves copy them to local ICV store
+          copy_icvs(&team->t.t_implicit_task_taskdata[tid].td_icvs,
+                    &thr_bar->th_fixed_icvs);
+      }
     }
   }
 #endif // KMP_BARRIER_ICV_PUSH
@@ -1209,6 +1509,151 @@ static void __kmp_hierarchical_barrier_release(
 
 // End of Barrier Algorithms
 
+// Barrier tuning state of a team for one barrier type, used by the master
+struct kmp_bar_tune {
+  kmp_int32 nproc; // team size the state is for
+  kmp_int32 chosen; // candidate kept, -1 while tuning
+  kmp_int32 timed; // barriers timed so far
+  kmp_uint64 start; // start of the barrier being timed, 0 if not timed
+  kmp_uint64 best[KMP_BAR_TUNE_CANDIDATES]; // shortest time of each candidate
+};
+
+// Candidates chosen so far, for teams of the same size that come later
+typedef struct kmp_bar_tune_result {
+  enum barrier_type bt;
+  kmp_int32 nproc;
+  kmp_int32 chosen;
+  struct kmp_bar_tune_result *next;
+} kmp_bar_tune_result_t;
+
+static kmp_bootstrap_lock_t __kmp_bar_tune_lock =
+    KMP_BOOTSTRAP_LOCK_INITIALIZER(__kmp_bar_tune_lock);
+static kmp_bar_tune_result_t *__kmp_bar_tune_results = NULL;
+
+static kmp_int32 __kmp_bar_tune_lookup(enum barrier_type bt, kmp_int32 nproc) {
+  kmp_int32 chosen = -1;
+  __kmp_acquire_bootstrap_lock(&__kmp_bar_tune_lock);
+  for (kmp_bar_tune_result_t *r = __kmp_bar_tune_results; r; r = r->next) {
+    if (r->bt == bt && r->nproc == nproc) {
+      chosen = r->chosen;
+      break;
+    }
+  }
+  __kmp_release_bootstrap_lock(&__kmp_bar_tune_lock);
+  return chosen;
+}
+
+static void __kmp_bar_tune_publish(enum barrier_type bt, kmp_int32 nproc,
+                                   kmp_int32 chosen) {
+  kmp_bar_tune_result_t *r;
+  __kmp_acquire_bootstrap_lock(&__kmp_bar_tune_lock);
+  for (r = __kmp_bar_tune_results; r; r = r->next)
+    if (r->bt == bt && r->nproc == nproc)
+      break;
+  if (r == NULL) { // the first team of this size to finish tuning wins
+    r = (kmp_bar_tune_result_t *)__kmp_allocate(sizeof(kmp_bar_tune_result_t));
+    r->bt = bt;
+    r->nproc = nproc;
+    r->chosen = chosen;
+    r->next = __kmp_bar_tune_results;
+    __kmp_bar_tune_results = r;
+  }
+  __kmp_release_bootstrap_lock(&__kmp_bar_tune_lock);
+}
+
+// __kmp_bar_tune_begin: the master entered a barrier
+static inline void __kmp_bar_tune_begin(enum barrier_type bt,
+                                        kmp_team_t *team) {
+  struct kmp_bar_tune *state = team->t.t_bar[bt].b_tune_state;
+  if (state != NULL && state->chosen < 0 && state->nproc == team->t.t_nproc)
+    state->start = KMP_NOW();
+}
+
+// __kmp_bar_tune_next: all threads arrived, so none of them reads the
+// candidate of the team again before the master releases them. Set the
+// candidate of the next barrier: each one in turn for KMP_BARRIER_TUNING
+// barriers, then the fastest.
+static void __kmp_bar_tune_next(enum barrier_type bt, kmp_team_t *team) {
+  kmp_balign_team_t *team_bar = &team->t.t_bar[bt];
+  struct kmp_bar_tune *state = team_bar->b_tune_state;
+  kmp_int32 nproc = team->t.t_nproc;
+
+  // the hierarchical barrier keeps state between barriers; leave it alone
+  if (__kmp_barrier_gather_pattern[bt] == bp_hierarchical_bar ||
+      __kmp_barrier_release_pattern[bt] == bp_hierarchical_bar)
+    return;
+  if (state == NULL) {
+    state = (struct kmp_bar_tune *)__kmp_allocate(sizeof(struct kmp_bar_tune));
+    team_bar->b_tune_state = state;
+  }
+  if (state->nproc != nproc) {
+    state->nproc = nproc;
+    state->timed = 0;
+    state->start = 0;
+    for (int c = 0; c < (int)KMP_BAR_TUNE_CANDIDATES; c++)
+      state->best[c] = ~(kmp_uint64)0;
+    state->chosen = __kmp_bar_tune_lookup(bt, nproc);
+  }
+  if (state->chosen >= 0) {
+    team_bar->b_tune = state->chosen;
+  } else {
+    kmp_int32 next = state->timed + (state->start != 0);
+    team_bar->b_tune =
+        (next / __kmp_barrier_tuning) % (kmp_int32)KMP_BAR_TUNE_CANDIDATES;
+  }
+}
+
+// __kmp_bar_tune_end: the master released a barrier. The time it spent in the
+// barrier includes waiting for late threads, so the shortest time of each
+// candidate is compared.
+static void __kmp_bar_tune_end(enum barrier_type bt, kmp_info_t *this_thr,
+                               kmp_team_t *team) {
+  struct kmp_bar_tune *state = team->t.t_bar[bt].b_tune_state;
+  if (state == NULL || state->start == 0)
+    return;
+  kmp_uint64 ticks = KMP_NOW() - state->start;
+  int c = this_thr->th.th_bar[bt].bb.b_tune;
+  state->start = 0;
+  if (ticks < state->best[c])
+    state->best[c] = ticks;
+  if (++state->timed < __kmp_barrier_tuning * (int)KMP_BAR_TUNE_CANDIDATES)
+    return;
+
+  kmp_int32 chosen = 0;
+  for (c = 1; c < (int)KMP_BAR_TUNE_CANDIDATES; c++)
+    if (state->best[c] < state->best[chosen])
+      chosen = c;
+  state->chosen = chosen;
+  KA_TRACE(10, ("__kmp_bar_tune_end: %s barrier of %d threads uses %s "
+                "pattern with %u branch bits (%llu ticks, settings %llu)\n",
+                __kmp_barrier_type_name[bt], state->nproc,
+                __kmp_barrier_pattern_name
+                    [chosen ? __kmp_bar_tune_candidates[chosen - 1].pattern
+                            : __kmp_barrier_gather_pattern[bt]],
+                chosen ? __kmp_bar_tune_candidates[chosen - 1].branch_bits
+                       : __kmp_barrier_gather_branch_bits[bt],
+                state->best[chosen], state->best[0]));
+  __kmp_bar_tune_publish(bt, state->nproc, chosen);
+}
+
+void __kmp_barrier_tune_free(kmp_team_t *team) {
+  for (int b = 0; b < bs_last_barrier; ++b) {
+    if (team->t.t_bar[b].b_tune_state != NULL) {
+      __kmp_free(team->t.t_bar[b].b_tune_state);
+      team->t.t_bar[b].b_tune_state = NULL;
+    }
+  }
+}
+
+void __kmp_cleanup_barrier_tuning(void) {
+  kmp_bar_tune_result_t *next;
+  for (kmp_bar_tune_result_t *r = __kmp_bar_tune_results; r; r = next) {
+    next = r->next;
+    __kmp_free(r);
+  }
+  __kmp_bar_tune_results = NULL;
+}
+
 // Internal function to do a barrier.
 /* If is_split is true, do a split barrier, otherwise, do a plain barrier
    If reduce is non-NULL, do a split reduction barrier, otherwise, do a split
@@ -1222,6 +1667,7 @@ int __kmp_barrier(enum barrier_type bt, int gtid, int is_split,
   int tid = __kmp_tid_from_gtid(gtid);
   kmp_info_t *this_thr = __kmp_threads[gtid];
   kmp_team_t *team = this_thr->th.th_team;
+  kmp_bstate_t *thr_bar = &this_thr->th.th_bar[bt].bb;
   int status = 0;
   ident_t *loc = __kmp_threads[gtid]->th.th_ident;
 #if OMPT_SUPPORT
@@ -1311,9 +1757,15 @@ int __kmp_barrier(enum barrier_type bt, int gtid, int is_split,
           this_thr, team,
           0); // use 0 to only setup the current team if nthreads > 1
 
-    switch (__kmp_barrier_gather_pattern[bt]) {
+    if (UNLIKELY(__kmp_barrier_tuning) && bt != bs_forkjoin_barrier) {
+      thr_bar->b_tune = (kmp_uint8)team->t.t_bar[bt].b_tune;
+      if (KMP_MASTER_TID(tid))
+        __kmp_bar_tune_begin(bt, team);
+    }
+
+    switch (__kmp_bar_gather_pattern(bt, thr_bar)) {
     case bp_hyper_bar: {
-      KMP_ASSERT(__kmp_barrier_gather_branch_bits[bt]); // don't set branch bits
+      KMP_ASSERT(__kmp_bar_gather_bb(bt, thr_bar)); // don't set branch bits
       // to 0; use linear
       __kmp_hyper_barrier_gather(bt, this_thr, gtid, tid,
                                  reduce USE_ITT_BUILD_ARG(itt_sync_obj));
@@ -1324,8 +1776,13 @@ int __kmp_barrier(enum barrier_type bt, int gtid, int is_split,
                                         reduce USE_ITT_BUILD_ARG(itt_sync_obj));
       break;
     }
+    case bp_dist_bar: {
+      __kmp_dist_barrier_gather(bt, this_thr, gtid, tid,
+                                reduce USE_ITT_BUILD_ARG(itt_sync_obj));
+      break;
+    }
     case bp_tree_bar: {
-      KMP_ASSERT(__kmp_barrier_gather_branch_bits[bt]); // don't set branch bits
+      KMP_ASSERT(__kmp_bar_gather_bb(bt, thr_bar)); // don't set branch bits
       // to 0; use linear
       __kmp_tree_barrier_gather(bt, this_thr, gtid, tid,
                                 reduce USE_ITT_BUILD_ARG(itt_sync_obj));
@@ -1341,6 +1798,8 @@ int __kmp_barrier(enum barrier_type bt, int gtid, int is_split,
 
     if (KMP_MASTER_TID(tid)) {
       status = 0;
+      if (UNLIKELY(__kmp_barrier_tuning) && bt != bs_forkjoin_barrier)
+        __kmp_bar_tune_next(bt, team);
       if (__kmp_tasking_mode != tskm_immediate_exec) {
         __kmp_task_team_wait(this_thr, team USE_ITT_BUILD_ARG(itt_sync_obj));
       }
@@ -1418,9 +1877,9 @@ int __kmp_barrier(enum barrier_type bt, int gtid, int is_split,
 #endif /* USE_ITT_BUILD */
     }
     if (status == 1 || !is_split) {
-      switch (__kmp_barrier_release_pattern[bt]) {
+      switch (__kmp_bar_release_pattern(bt, thr_bar)) {
       case bp_hyper_bar: {
-        KMP_ASSERT(__kmp_barrier_release_branch_bits[bt]);
+        KMP_ASSERT(__kmp_bar_release_bb(bt, thr_bar));
         __kmp_hyper_barrier_release(bt, this_thr, gtid, tid,
                                     FALSE USE_ITT_BUILD_ARG(itt_sync_obj));
         break;
@@ -1430,8 +1889,13 @@ int __kmp_barrier(enum barrier_type bt, int gtid, int is_split,
             bt, this_thr, gtid, tid, FALSE USE_ITT_BUILD_ARG(itt_sync_obj));
         break;
       }
+      case bp_dist_bar: {
+        __kmp_dist_barrier_release(bt, this_thr, gtid, tid,
+                                   FALSE USE_ITT_BUILD_ARG(itt_sync_obj));
+        break;
+      }
       case bp_tree_bar: {
-        KMP_ASSERT(__kmp_barrier_release_branch_bits[bt]);
+        KMP_ASSERT(__kmp_bar_release_bb(bt, thr_bar));
         __kmp_tree_barrier_release(bt, this_thr, gtid, tid,
                                    FALSE USE_ITT_BUILD_ARG(itt_sync_obj));
         break;
@@ -1441,6 +1905,9 @@ int __kmp_barrier(enum barrier_type bt, int gtid, int is_split,
                                      FALSE USE_ITT_BUILD_ARG(itt_sync_obj));
       }
       }
+      if (status == 0 && UNLIKELY(__kmp_barrier_tuning) &&
+          bt != bs_forkjoin_barrier)
+        __kmp_bar_tune_end(bt, this_thr, team);
       if (__kmp_tasking_mode != tskm_immediate_exec) {
         __kmp_task_team_sync(this_thr, team);
       }
@@ -1516,13 +1983,14 @@ void __kmp_end_split_barrier(enum barrier_type bt, int gtid) {
   int tid = __kmp_tid_from_gtid(gtid);
   kmp_info_t *this_thr = __kmp_threads[gtid];
   kmp_team_t *team = this_thr->th.th_team;
+  kmp_bstate_t *thr_bar = &this_thr->th.th_bar[bt].bb;
 
   ANNOTATE_BARRIER_BEGIN(&team->t.t_bar);
   if (!team->t.t_serialized) {
     if (KMP_MASTER_GTID(gtid)) {
-      switch (__kmp_barrier_release_pattern[bt]) {
+      switch (__kmp_bar_release_pattern(bt, thr_bar)) {
       case bp_hyper_bar: {
-        KMP_ASSERT(__kmp_barrier_release_branch_bits[bt]);
+        KMP_ASSERT(__kmp_bar_release_bb(bt, thr_bar));
         __kmp_hyper_barrier_release(bt, this_thr, gtid, tid,
                                     FALSE USE_ITT_BUILD_ARG(NULL));
         break;
@@ -1532,8 +2000,13 @@ void __kmp_end_split_barrier(enum barrier_type bt, int gtid) {
                                            FALSE USE_ITT_BUILD_ARG(NULL));
         break;
       }
+      case bp_dist_bar: {
+        __kmp_dist_barrier_release(bt, this_thr, gtid, tid,
+                                   FALSE USE_ITT_BUILD_ARG(NULL));
+        break;
+      }
       case bp_tree_bar: {
-        KMP_ASSERT(__kmp_barrier_release_branch_bits[bt]);
+        KMP_ASSERT(__kmp_bar_release_bb(bt, thr_bar));
         __kmp_tree_barrier_release(bt, this_thr, gtid, tid,
                                    FALSE USE_ITT_BUILD_ARG(NULL));
         break;
@@ -1543,6 +2016,8 @@ void __kmp_end_split_barrier(enum barrier_type bt, int gtid) {
                                      FALSE USE_ITT_BUILD_ARG(NULL));
       }
       }
+      if (UNLIKELY(__kmp_barrier_tuning) && bt != bs_forkjoin_barrier)
+        __kmp_bar_tune_end(bt, this_thr, team);
       if (__kmp_tasking_mode != tskm_immediate_exec) {
         __kmp_task_team_sync(this_thr, team);
       } // if
@@ -1551,6 +2026,147 @@ void __kmp_end_split_barrier(enum barrier_type bt, int gtid) {
   ANNOTATE_BARRIER_END(&team->t.t_bar);
 }
 
+/* Split-phase barrier: __kmp_barrier_arrive() only counts the thread in and
+   returns; the last thread to arrive bumps th_split_go of every thread of the
+   team, which __kmp_barrier_wait() waits for. Work done between the two calls
+   overlaps with the wait for late threads. The count is reset before anybody
+   is released, so nobody can arrive at the next split barrier early.
+   Like other barriers, it completes the explicit tasks of the team: if any
+   were created since the last barrier, the threads go through a plain barrier
+   once released, which executes them until all are finished. The last thread
+   to arrive decides this for the team, as tasks created after arriving do not
+   have to finish. */
+void __kmp_barrier_arrive(int gtid) {
+  kmp_info_t *this_thr = __kmp_threads[gtid];
+  kmp_team_t *team = this_thr->th.th_team;
+  kmp_int32 nproc = this_thr->th.th_team_nproc;
+
+  KA_TRACE(15, ("__kmp_barrier_arrive: T#%d(%d:%d) has arrived\n", gtid,
+                team->t.t_id, __kmp_tid_from_gtid(gtid)));
+  KMP_DEBUG_ASSERT(!this_thr->th.th_split_arrived);
+  this_thr->th.th_split_arrived = TRUE;
+#if OMPT_SUPPORT && OMPT_OPTIONAL
+  if (ompt_enabled.ompt_callback_sync_region) {
+    ompt_callbacks.ompt_callback(ompt_callback_sync_region)(
+        ompt_sync_region_barrier, ompt_scope_begin, OMPT_CUR_TEAM_DATA(this_thr),
+        OMPT_CUR_TASK_DATA(this_thr), OMPT_LOAD_RETURN_ADDRESS(gtid));
+  }
+#endif
+  if (team->t.t_serialized)
+    return;
+
+  ANNOTATE_BARRIER_BEGIN(&team->t.t_split_arrived);
+  if (KMP_ATOMIC_INC(&team->t.t_split_arrived) + 1 < nproc)
+    return;
+  // Last one in
+  team->t.t_split_arrived = 0;
+  kmp_task_team_t *task_team = this_thr->th.th_task_team;
+  team->t.t_split_tasks =
+      __kmp_tasking_mode != tskm_immediate_exec && task_team != NULL &&
+      KMP_TASKING_ENABLED(task_team);
+  for (int i = 0; i < nproc; ++i) {
+    kmp_info_t *thr = team->t.t_threads[i];
+    KA_TRACE(20, ("__kmp_barrier_arrive: T#%d(%d:%d) releasing T#%d(%d:%d) "
+                  "split_go(%p): %llu => %llu\n",
+                  gtid, team->t.t_id, __kmp_tid_from_gtid(gtid),
+                  __kmp_gtid_from_tid(i, team), team->t.t_id, i,
+                  &thr->th.th_split_go, thr->th.th_split_go,
+                  thr->th.th_split_go + KMP_BARRIER_STATE_BUMP));
+    kmp_flag_64 flag(&thr->th.th_split_go, thr);
+    flag.release();
+  }
+}
+
+void __kmp_barrier_wait(int gtid) {
+  KMP_TIME_PARTITIONED_BLOCK(OMP_split_barrier);
+  KMP_SET_THREAD_STATE_BLOCK(PLAIN_BARRIER);
+  kmp_info_t *this_thr = __kmp_threads[gtid];
+  kmp_team_t *team = this_thr->th.th_team;
+  int tid = __kmp_tid_from_gtid(gtid);
+#if OMPT_SUPPORT && OMPT_OPTIONAL
+  ompt_data_t *my_task_data = NULL;
+  ompt_data_t *my_parallel_data = NULL;
+  void *return_address = NULL;
+#endif
+
+  KA_TRACE(15, ("__kmp_barrier_wait: T#%d(%d:%d) enter\n", gtid, team->t.t_id,
+                tid));
+  KMP_DEBUG_ASSERT(this_thr->th.th_split_arrived);
+  this_thr->th.th_split_arrived = FALSE;
+#if OMPT_SUPPORT
+  if (ompt_enabled.enabled) {
+#if OMPT_OPTIONAL
+    my_task_data = OMPT_CUR_TASK_DATA(this_thr);
+    my_parallel_data = OMPT_CUR_TEAM_DATA(this_thr);
+    return_address = OMPT_LOAD_RETURN_ADDRESS(gtid);
+    if (ompt_enabled.ompt_callback_sync_region_wait) {
+      ompt_callbacks.ompt_callback(ompt_callback_sync_region_wait)(
+          ompt_sync_region_barrier, ompt_scope_begin, my_parallel_data,
+          my_task_data, return_address);
+    }
+#endif
+    this_thr->th.ompt_thread_info.state = omp_state_wait_barrier;
+  }
+#endif
+
+  if (!team->t.t_serialized) {
+    // Copy the blocktime info to the thread, as in __kmp_barrier()
+    if (__kmp_dflt_blocktime != KMP_MAX_BLOCKTIME) {
+#if KMP_USE_MONITOR
+      this_thr->th.th_team_bt_intervals =
+          team->t.t_implicit_task_taskdata[tid].td_icvs.bt_intervals;
+      this_thr->th.th_team_bt_set =
+          team->t.t_implicit_task_taskdata[tid].td_icvs.bt_set;
+#else
+      this_thr->th.th_team_bt_intervals = KMP_BLOCKTIME_INTERVAL(team, tid);
+#endif
+    }
+    kmp_flag_64 flag(&this_thr->th.th_split_go, KMP_BARRIER_STATE_BUMP);
+    flag.wait(this_thr, FALSE USE_ITT_BUILD_ARG(NULL));
+    TCW_8(this_thr->th.th_split_go, KMP_INIT_BARRIER_STATE);
+    KMP_MB();
+    ANNOTATE_BARRIER_END(&team->t.t_split_arrived);
+  }
+
+#if OMPT_SUPPORT
+  if (ompt_enabled.enabled) {
+#if OMPT_OPTIONAL
+    if (ompt_enabled.ompt_callback_sync_region_wait) {
+      ompt_callbacks.ompt_callback(ompt_callback_sync_region_wait)(
+          ompt_sync_region_barrier, ompt_scope_end, my_parallel_data,
+          my_task_data, return_address);
+    }
+#endif
+  }
+#endif
+
+  // Nobody arrives at the next split barrier before everybody has read this
+  if (!team->t.t_serialized && team->t.t_split_tasks) {
+    KA_TRACE(20, ("__kmp_barrier_wait: T#%d(%d:%d) finishing tasks\n", gtid,
+                  team->t.t_id, tid));
+#if OMPT_SUPPORT && OMPT_OPTIONAL
+    if (ompt_enabled.enabled)
+      this_thr->th.ompt_thread_info.return_address = return_address;
+#endif
+    __kmp_barrier(bs_plain_barrier, gtid, FALSE, 0, NULL, NULL);
+  }
+
+#if OMPT_SUPPORT
+  if (ompt_enabled.enabled) {
+#if OMPT_OPTIONAL
+    if (ompt_enabled.ompt_callback_sync_region) {
+      ompt_callbacks.ompt_callback(ompt_callback_sync_region)(
+          ompt_sync_region_barrier, ompt_scope_end, my_parallel_data,
+          my_task_data, return_address);
+    }
+#endif
+    this_thr->th.ompt_thread_info.state = omp_state_work_parallel;
+  }
+#endif
+  KA_TRACE(15, ("__kmp_barrier_wait: T#%d(%d:%d) exit\n", gtid, team->t.t_id,
+                tid));
+}
+
 void __kmp_join_barrier(int gtid) {
   KMP_TIME_PARTITIONED_BLOCK(OMP_join_barrier);
   KMP_SET_THREAD_STATE_BLOCK(FORK_JOIN_BARRIER);
@@ -1678,6 +2294,11 @@ void __kmp_join_barrier(int gtid) {
                                       NULL USE_ITT_BUILD_ARG(itt_sync_obj));
     break;
   }
+  case bp_dist_bar: {
+    __kmp_dist_barrier_gather(bs_forkjoin_barrier, this_thr, gtid, tid,
+                              NULL USE_ITT_BUILD_ARG(itt_sync_obj));
+    break;
+  }
   case bp_tree_bar: {
     KMP_ASSERT(__kmp_barrier_gather_branch_bits[bs_forkjoin_barrier]);
     __kmp_tree_barrier_gather(bs_forkjoin_barrier, this_thr, gtid, tid,
@@ -1854,6 +2475,13 @@ void __kmp_fork_barrier(int gtid, int tid) {
       this_thr->th.th_team_bt_intervals = KMP_BLOCKTIME_INTERVAL(team, tid);
 #endif
     }
+#if KMP_BARRIER_ICV_PUSH
+    {
+      KMP_TIME_DEVELOPER_PARTITIONED_BLOCK(USER_icv_copy);
+      __kmp_master_fixed_icvs(team,
+                              &this_thr->th.th_bar[bs_forkjoin_barrier].bb);
+    }
+#endif
   } // master
 
   switch (__kmp_barrier_release_pattern[bs_forkjoin_barrier]) {
@@ -1868,6 +2496,11 @@ void __kmp_fork_barrier(int gtid, int tid) {
                                        TRUE USE_ITT_BUILD_ARG(itt_sync_obj));
     break;
   }
+  case bp_dist_bar: {
+    __kmp_dist_barrier_release(bs_forkjoin_barrier, this_thr, gtid, tid,
+                               TRUE USE_ITT_BUILD_ARG(itt_sync_obj));
+    break;
+  }
   case bp_tree_bar: {
     KMP_ASSERT(__kmp_barrier_release_branch_bits[bs_forkjoin_barrier]);
     __kmp_tree_barrier_release(bs_forkjoin_barrier, this_thr, gtid, tid,
@@ -1981,6 +2614,7 @@ void __kmp_fork_barrier(int gtid, int tid) {
                      this_thr->th.th_current_place));
     } else {
       __kmp_affinity_set_place(gtid);
+      __kmp_localize_thread_state(this_thr);
     }
   }
 #endif
@@ -2021,7 +2655,8 @@ void __kmp_setup_icv_copy(kmp_team_t *team, int new_nproc,
   KF_TRACE(10, ("__kmp_setup_icv_copy: PULL: T#%d this_thread=%p team=%p\n", 0,
                 team->t.t_threads[0], team));
 #elif KMP_BARRIER_ICV_PUSH
-  // The ICVs will be propagated in the fork barrier, so nothing needs to be
+  // The ICVs will be propagated in the fork barrier, and only to threads that
+  // do not have them yet (see __kmp_master_fixed_icvs), so nothing needs to be
   // done here.
   KF_TRACE(10, ("__kmp_setup_icv_copy: PUSH: T#%d this_thread=%p team=%p\n", 0,
                 team->t.t_threads[0], team));
@@ -56,6 +56,8 @@
 #define KMP_USE_ASSERT LIBOMP_ENABLE_ASSERTIONS
 #cmakedefine01 LIBOMP_USE_HIER_SCHED
 #define KMP_USE_HIER_SCHED LIBOMP_USE_HIER_SCHED
+#cmakedefine01 LIBOMP_USE_LOCKFREE_TASK_DEQUE
+#define KMP_USE_LOCKFREE_TASK_DEQUE LIBOMP_USE_LOCKFREE_TASK_DEQUE
 #cmakedefine01 STUBS_LIBRARY
 #cmakedefine01 LIBOMP_USE_HWLOC
 #define KMP_USE_HWLOC LIBOMP_USE_HWLOC
@@ -701,6 +701,69 @@ void __kmpc_barrier(ident_t *loc, kmp_int32 global_tid) {
 #endif
 }
 
+/*!
+@ingroup SYNCHRONIZATION
+@param loc source location information
+@param global_tid thread id.
+
+Arrive at a split-phase barrier and return without waiting for the other
+threads. The thread must call @ref __kmpc_barrier_wait before it arrives at the
+next split barrier; when that returns, all threads of the team have arrived and
+their writes made before arriving are visible.
+*/
+void __kmpc_barrier_arrive(ident_t *loc, kmp_int32 global_tid) {
+  KMP_COUNT_BLOCK(OMP_SPLIT_BARRIER);
+  KC_TRACE(10, ("__kmpc_barrier_arrive: called T#%d\n", global_tid));
+
+  if (!TCR_4(__kmp_init_parallel))
+    __kmp_parallel_initialize();
+
+  if (__kmp_env_consistency_check) {
+    if (loc == 0) {
+      KMP_WARNING(ConstructIdentInvalid);
+    }
+
+    __kmp_check_barrier(global_tid, ct_barrier, loc);
+  }
+
+#if OMPT_SUPPORT
+  if (ompt_enabled.enabled)
+    OMPT_STORE_RETURN_ADDRESS(global_tid);
+#endif
+  __kmp_threads[global_tid]->th.th_ident = loc;
+  __kmp_barrier_arrive(global_tid);
+}
+
+/*!
+@ingroup SYNCHRONIZATION
+@param loc source location information
+@param global_tid thread id.
+
+Wait until all threads of the team have arrived at the split-phase barrier
+this thread arrived at with @ref __kmpc_barrier_arrive. The explicit tasks the
+team created before arriving are complete when this returns.
+*/
+void __kmpc_barrier_wait(ident_t *loc, kmp_int32 global_tid) {
+  KC_TRACE(10, ("__kmpc_barrier_wait: called T#%d\n", global_tid));
+
+#if OMPT_SUPPORT
+  omp_frame_t *ompt_frame;
+  if (ompt_enabled.enabled) {
+    __ompt_get_task_info_internal(0, NULL, NULL, &ompt_frame, NULL, NULL);
+    if (ompt_frame->enter_frame == NULL)
+      ompt_frame->enter_frame = OMPT_GET_FRAME_ADDRESS(1);
+    OMPT_STORE_RETURN_ADDRESS(global_tid);
+  }
+#endif
+  __kmp_threads[global_tid]->th.th_ident = loc;
+  __kmp_barrier_wait(global_tid);
+#if OMPT_SUPPORT && OMPT_OPTIONAL
+  if (ompt_enabled.enabled) {
+    ompt_frame->enter_frame = NULL;
+  }
+#endif
+}
+
 /* The BARRIER for a MASTER section is always explicit   */
 /*!
 @ingroup WORK_SHARING
@@ -1222,6 +1285,8 @@ static __forceinline kmp_dyna_lockseq_t __kmp_map_hint_to_lock(uintptr_t hint) {
     return KMP_CPUINFO_RTM ? KMP_TSX_LOCK(rtm) : __kmp_user_lock_seq;
   if (hint & kmp_lock_hint_adaptive)
     return KMP_CPUINFO_RTM ? KMP_TSX_LOCK(adaptive) : __kmp_user_lock_seq;
+  if (hint & kmp_lock_hint_read_mostly)
+    return lockseq_rw;
 
   // Rule out conflicting hints first by returning the default lock
   if ((hint & omp_lock_hint_contended) && (hint & omp_lock_hint_uncontended))
@@ -1230,9 +1295,10 @@ static __forceinline kmp_dyna_lockseq_t __kmp_map_hint_to_lock(uintptr_t hint) {
       (hint & omp_lock_hint_nonspeculative))
     return __kmp_user_lock_seq;
 
-  // Do not even consider speculation when it appears to be contended
+  // Do not even consider speculation when it appears to be contended. Keep
+  // contended locks within a NUMA node as long as possible on NUMA machines.
   if (hint & omp_lock_hint_contended)
-    return lockseq_queuing;
+    return __kmp_num_numa_nodes > 1 ? lockseq_cohort : lockseq_queuing;
 
   // Uncontended lock without speculation
   if ((hint & omp_lock_hint_uncontended) && !(hint & omp_lock_hint_speculative))
@@ -1275,6 +1341,8 @@ __ompt_get_mutex_impl_type(void *user_lock, kmp_indirect_lock_t *ilock = 0) {
     return kmp_mutex_impl_speculative;
 #endif
   case locktag_nested_tas:
+  case locktag_rw:
+  case locktag_morph:
     return kmp_mutex_impl_spin;
 #if KMP_USE_FUTEX
   case locktag_nested_futex:
@@ -1282,6 +1350,7 @@ __ompt_get_mutex_impl_type(void *user_lock, kmp_indirect_lock_t *ilock = 0) {
   case locktag_ticket:
   case locktag_queuing:
   case locktag_drdpa:
+  case locktag_cohort:
   case locktag_nested_ticket:
   case locktag_nested_queuing:
   case locktag_nested_drdpa:
@@ -1295,6 +1364,10 @@ __ompt_get_mutex_impl_type(void *user_lock, kmp_indirect_lock_t *ilock = 0) {
 static kmp_mutex_impl_t __ompt_get_mutex_impl_type() {
   switch (__kmp_user_lock_kind) {
   case lk_tas:
+#if KMP_USE_DYNAMIC_LOCK
+  case lk_rw:
+  case lk_morph:
+#endif
     return kmp_mutex_impl_spin;
 #if KMP_USE_FUTEX
   case lk_futex:
@@ -1302,6 +1375,9 @@ static kmp_mutex_impl_t __ompt_get_mutex_impl_type() {
   case lk_ticket:
   case lk_queuing:
   case lk_drdpa:
+#if KMP_USE_DYNAMIC_LOCK
+  case lk_cohort:
+#endif
     return kmp_mutex_impl_queuing;
 #if KMP_USE_TSX
   case lk_hle:
@@ -1332,6 +1408,8 @@ void __kmpc_critical_with_hint(ident_t *loc, kmp_int32 global_tid,
                                kmp_critical_name *crit, uintptr_t hint) {
   KMP_COUNT_BLOCK(OMP_CRITICAL);
   kmp_user_lock_p lck;
+  kmp_uint64 prof_start = 0;
+  int prof_acquired = 0;
 #if OMPT_SUPPORT && OMPT_OPTIONAL
   omp_state_t prev_state = omp_state_undefined;
   ompt_thread_info_t ti;
@@ -1382,17 +1460,25 @@ void __kmpc_critical_with_hint(ident_t *loc, kmp_int32 global_tid,
       }
     }
 #endif
+    // The profiler tells contended acquisitions by trying the lock first
+    if (__kmp_lock_profile) {
+      prof_start = __kmp_lock_prof_now();
+      prof_acquired = KMP_D_LOCK_FUNC(lk, test)(lk, global_tid);
+    }
+    if (!prof_acquired) {
 #if KMP_USE_INLINED_TAS
-    if (__kmp_user_lock_seq == lockseq_tas && !__kmp_env_consistency_check) {
-      KMP_ACQUIRE_TAS_LOCK(lck, global_tid);
-    } else
+      if (__kmp_user_lock_seq == lockseq_tas && !__kmp_env_consistency_check) {
+        KMP_ACQUIRE_TAS_LOCK(lck, global_tid);
+      } else
 #elif KMP_USE_INLINED_FUTEX
-    if (__kmp_user_lock_seq == lockseq_futex && !__kmp_env_consistency_check) {
-      KMP_ACQUIRE_FUTEX_LOCK(lck, global_tid);
-    } else
+      if (__kmp_user_lock_seq == lockseq_futex &&
+          !__kmp_env_consistency_check) {
+        KMP_ACQUIRE_FUTEX_LOCK(lck, global_tid);
+      } else
 #endif
-    {
-      KMP_D_LOCK_FUNC(lk, set)(lk, global_tid);
+      {
+        KMP_D_LOCK_FUNC(lk, set)(lk, global_tid);
+      }
     }
   } else {
     kmp_indirect_lock_t *ilk = *((kmp_indirect_lock_t **)lk);
@@ -1420,8 +1506,16 @@ void __kmpc_critical_with_hint(ident_t *loc, kmp_int32 global_tid,
       }
     }
 #endif
-    KMP_I_LOCK_FUNC(ilk, set)(lck, global_tid);
+    if (__kmp_lock_profile) {
+      prof_start = __kmp_lock_prof_now();
+      prof_acquired = KMP_I_LOCK_FUNC(ilk, test)(lck, global_tid);
+    }
+    if (!prof_acquired)
+      KMP_I_LOCK_FUNC(ilk, set)(lck, global_tid);
   }
+  if (__kmp_lock_profile)
+    __kmp_lock_prof_acquired(crit, global_tid, kmp_lock_prof_critical, loc,
+                             prof_start, !prof_acquired);
 
 #if USE_ITT_BUILD
   __kmp_itt_critical_acquired(lck);
@@ -1462,6 +1556,8 @@ void __kmpc_end_critical(ident_t *loc, kmp_int32 global_tid,
   KC_TRACE(10, ("__kmpc_end_critical: called T#%d\n", global_tid));
 
 #if KMP_USE_DYNAMIC_LOCK
+  if (__kmp_lock_profile)
+    __kmp_lock_prof_released(crit, global_tid);
   if (KMP_IS_D_LOCK(__kmp_user_lock_seq)) {
     lck = (kmp_user_lock_p)crit;
     KMP_ASSERT(lck != NULL);
@@ -2284,6 +2380,8 @@ void __kmpc_init_nest_lock(ident_t *loc, kmp_int32 gtid, void **user_lock) {
 } // __kmpc_init_nest_lock
 
 void __kmpc_destroy_lock(ident_t *loc, kmp_int32 gtid, void **user_lock) {
+  if (__kmp_lock_profile)
+    __kmp_lock_prof_destroy(user_lock);
 #if KMP_USE_DYNAMIC_LOCK
 
 #if USE_ITT_BUILD
@@ -2363,6 +2461,8 @@ void __kmpc_destroy_lock(ident_t *loc, kmp_int32 gtid, void **user_lock) {
 
 /* destroy the lock */
 void __kmpc_destroy_nest_lock(ident_t *loc, kmp_int32 gtid, void **user_lock) {
+  if (__kmp_lock_profile)
+    __kmp_lock_prof_destroy(user_lock);
 #if KMP_USE_DYNAMIC_LOCK
 
 #if USE_ITT_BUILD
@@ -2457,6 +2557,16 @@ void __kmpc_set_lock(ident_t *loc, kmp_int32 gtid, void **user_lock) {
         codeptr);
   }
 #endif
+  if (__kmp_lock_profile) {
+    // The profiler tells contended acquisitions by trying the lock first
+    kmp_uint64 prof_start = __kmp_lock_prof_now();
+    int prof_acquired =
+        __kmp_direct_test[tag]((kmp_dyna_lock_t *)user_lock, gtid);
+    if (!prof_acquired)
+      __kmp_direct_set[tag]((kmp_dyna_lock_t *)user_lock, gtid);
+    __kmp_lock_prof_acquired(user_lock, gtid, kmp_lock_prof_lock, loc,
+                             prof_start, !prof_acquired);
+  } else
 #if KMP_USE_INLINED_TAS
   if (tag == locktag_tas && !__kmp_env_consistency_check) {
     KMP_ACQUIRE_TAS_LOCK(user_lock, gtid);
@@ -2548,8 +2658,24 @@ void __kmpc_set_nest_lock(ident_t *loc, kmp_int32 gtid, void **user_lock) {
     }
   }
 #endif
-  int acquire_status =
-      KMP_D_LOCK_FUNC(user_lock, set)((kmp_dyna_lock_t *)user_lock, gtid);
+  int acquire_status;
+  if (__kmp_lock_profile) {
+    // A successful try returns the new nesting depth
+    kmp_uint64 prof_start = __kmp_lock_prof_now();
+    int prof_depth =
+        KMP_D_LOCK_FUNC(user_lock, test)((kmp_dyna_lock_t *)user_lock, gtid);
+    if (prof_depth)
+      acquire_status = prof_depth == 1 ? KMP_LOCK_ACQUIRED_FIRST
+                                       : KMP_LOCK_ACQUIRED_NEXT;
+    else
+      acquire_status =
+          KMP_D_LOCK_FUNC(user_lock, set)((kmp_dyna_lock_t *)user_lock, gtid);
+    __kmp_lock_prof_acquired(user_lock, gtid, kmp_lock_prof_nest_lock, loc,
+                             prof_start, !prof_depth);
+  } else {
+    acquire_status =
+        KMP_D_LOCK_FUNC(user_lock, set)((kmp_dyna_lock_t *)user_lock, gtid);
+  }
 #if USE_ITT_BUILD
   __kmp_itt_lock_acquired((kmp_user_lock_p)user_lock);
 #endif
@@ -2643,6 +2769,8 @@ void __kmpc_unset_lock(ident_t *loc, kmp_int32 gtid, void **user_lock) {
 #if USE_ITT_BUILD
   __kmp_itt_lock_releasing((kmp_user_lock_p)user_lock);
 #endif
+  if (__kmp_lock_profile)
+    __kmp_lock_prof_released(user_lock, gtid);
 #if KMP_USE_INLINED_TAS
   if (tag == locktag_tas && !__kmp_env_consistency_check) {
     KMP_RELEASE_TAS_LOCK(user_lock, gtid);
@@ -2731,6 +2859,61 @@ void __kmpc_unset_lock(ident_t *loc, kmp_int32 gtid, void **user_lock) {
 #endif // KMP_USE_DYNAMIC_LOCK
 }
 
+/* acquire the lock as one of possibly many readers; only locks of the rw
+   kind (kmp_lock_hint_read_mostly) can be shared, others are set exclusively */
+void __kmpc_set_lock_shared(ident_t *loc, kmp_int32 gtid, void **user_lock) {
+#if KMP_USE_DYNAMIC_LOCK
+  KMP_COUNT_BLOCK(OMP_set_lock);
+#if USE_ITT_BUILD
+  __kmp_itt_lock_acquiring((kmp_user_lock_p)user_lock);
+#endif
+#if OMPT_SUPPORT && OMPT_OPTIONAL
+  void *codeptr = OMPT_LOAD_RETURN_ADDRESS(gtid);
+  if (!codeptr)
+    codeptr = OMPT_GET_RETURN_ADDRESS(0);
+  if (ompt_enabled.ompt_callback_mutex_acquire) {
+    ompt_callbacks.ompt_callback(ompt_callback_mutex_acquire)(
+        ompt_mutex_lock, omp_lock_hint_none,
+        __ompt_get_mutex_impl_type(user_lock), (omp_wait_id_t)user_lock,
+        codeptr);
+  }
+#endif
+  __kmp_set_lock_shared((kmp_dyna_lock_t *)user_lock, gtid);
+#if USE_ITT_BUILD
+  __kmp_itt_lock_acquired((kmp_user_lock_p)user_lock);
+#endif
+#if OMPT_SUPPORT && OMPT_OPTIONAL
+  if (ompt_enabled.ompt_callback_mutex_acquired) {
+    ompt_callbacks.ompt_callback(ompt_callback_mutex_acquired)(
+        ompt_mutex_lock, (omp_wait_id_t)user_lock, codeptr);
+  }
+#endif
+#else // KMP_USE_DYNAMIC_LOCK
+  __kmpc_set_lock(loc, gtid, user_lock);
+#endif // KMP_USE_DYNAMIC_LOCK
+}
+
+/* release a lock acquired with __kmpc_set_lock_shared */
+void __kmpc_unset_lock_shared(ident_t *loc, kmp_int32 gtid, void **user_lock) {
+#if KMP_USE_DYNAMIC_LOCK
+#if USE_ITT_BUILD
+  __kmp_itt_lock_releasing((kmp_user_lock_p)user_lock);
+#endif
+  __kmp_unset_lock_shared((kmp_dyna_lock_t *)user_lock, gtid);
+#if OMPT_SUPPORT && OMPT_OPTIONAL
+  void *codeptr = OMPT_LOAD_RETURN_ADDRESS(gtid);
+  if (!codeptr)
+    codeptr = OMPT_GET_RETURN_ADDRESS(0);
+  if (ompt_enabled.ompt_callback_mutex_released) {
+    ompt_callbacks.ompt_callback(ompt_callback_mutex_released)(
+        ompt_mutex_lock, (omp_wait_id_t)user_lock, codeptr);
+  }
+#endif
+#else // KMP_USE_DYNAMIC_LOCK
+  __kmpc_unset_lock(loc, gtid, user_lock);
+#endif // KMP_USE_DYNAMIC_LOCK
+}
+
 /* release the lock */
 void __kmpc_unset_nest_lock(ident_t *loc, kmp_int32 gtid, void **user_lock) {
 #if KMP_USE_DYNAMIC_LOCK
@@ -2738,6 +2921,8 @@ void __kmpc_unset_nest_lock(ident_t *loc, kmp_int32 gtid, void **user_lock) {
 #if USE_ITT_BUILD
   __kmp_itt_lock_releasing((kmp_user_lock_p)user_lock);
 #endif
+  if (__kmp_lock_profile)
+    __kmp_lock_prof_released(user_lock, gtid);
   int release_status =
       KMP_D_LOCK_FUNC(user_lock, unset)((kmp_dyna_lock_t *)user_lock, gtid);
 
@@ -2862,6 +3047,7 @@ int __kmpc_test_lock(ident_t *loc, kmp_int32 gtid, void **user_lock) {
 #if KMP_USE_DYNAMIC_LOCK
   int rc;
   int tag = KMP_EXTRACT_D_TAG(user_lock);
+  kmp_uint64 prof_start = __kmp_lock_profile ? __kmp_lock_prof_now() : 0;
 #if USE_ITT_BUILD
   __kmp_itt_lock_acquiring((kmp_user_lock_p)user_lock);
 #endif
@@ -2890,6 +3076,9 @@ int __kmpc_test_lock(ident_t *loc, kmp_int32 gtid, void **user_lock) {
     rc = __kmp_direct_test[tag]((kmp_dyna_lock_t *)user_lock, gtid);
   }
   if (rc) {
+    if (__kmp_lock_profile)
+      __kmp_lock_prof_acquired(user_lock, gtid, kmp_lock_prof_lock, loc,
+                               prof_start, FALSE);
 #if USE_ITT_BUILD
     __kmp_itt_lock_acquired((kmp_user_lock_p)user_lock);
 #endif
@@ -2967,6 +3156,7 @@ int __kmpc_test_lock(ident_t *loc, kmp_int32 gtid, void **user_lock) {
 int __kmpc_test_nest_lock(ident_t *loc, kmp_int32 gtid, void **user_lock) {
 #if KMP_USE_DYNAMIC_LOCK
   int rc;
+  kmp_uint64 prof_start = __kmp_lock_profile ? __kmp_lock_prof_now() : 0;
 #if USE_ITT_BUILD
   __kmp_itt_lock_acquiring((kmp_user_lock_p)user_lock);
 #endif
@@ -2983,6 +3173,9 @@ int __kmpc_test_nest_lock(ident_t *loc, kmp_int32 gtid, void **user_lock) {
   }
 #endif
   rc = KMP_D_LOCK_FUNC(user_lock, test)((kmp_dyna_lock_t *)user_lock, gtid);
+  if (rc && __kmp_lock_profile)
+    __kmp_lock_prof_acquired(user_lock, gtid, kmp_lock_prof_nest_lock, loc,
+                             prof_start, FALSE);
 #if USE_ITT_BUILD
   if (rc) {
     __kmp_itt_lock_acquired((kmp_user_lock_p)user_lock);
@@ -3716,6 +3909,134 @@ void __kmpc_end_reduce(ident_t *loc, kmp_int32 global_tid,
   return;
 }
 
+/* 2.b. Scalar reduction fused into the barrier */
+
+#define KMP_BAR_RED_FUNCS(type_name, field)                                    \
+  static void __kmp_bar_red_sum_##type_name(void *lhs, void *rhs) {            \
+    ((kmp_bar_red_t *)lhs)->field += ((kmp_bar_red_t *)rhs)->field;            \
+  }                                                                            \
+  static void __kmp_bar_red_min_##type_name(void *lhs, void *rhs) {            \
+    if (((kmp_bar_red_t *)rhs)->field < ((kmp_bar_red_t *)lhs)->field)         \
+      ((kmp_bar_red_t *)lhs)->field = ((kmp_bar_red_t *)rhs)->field;           \
+  }                                                                            \
+  static void __kmp_bar_red_max_##type_name(void *lhs, void *rhs) {            \
+    if (((kmp_bar_red_t *)rhs)->field > ((kmp_bar_red_t *)lhs)->field)         \
+      ((kmp_bar_red_t *)lhs)->field = ((kmp_bar_red_t *)rhs)->field;           \
+  }
+
+KMP_BAR_RED_FUNCS(int32, i32)
+KMP_BAR_RED_FUNCS(float, f)
+KMP_BAR_RED_FUNCS(double, d)
+
+#undef KMP_BAR_RED_FUNCS
+
+static void (*const __kmp_bar_red_funcs[kmp_bar_red_last_type]
+                                       [kmp_bar_red_last_op])(void *, void *) = {
+    {__kmp_bar_red_sum_int32, __kmp_bar_red_min_int32,
+     __kmp_bar_red_max_int32},
+    {__kmp_bar_red_sum_float, __kmp_bar_red_min_float,
+     __kmp_bar_red_max_float},
+    {__kmp_bar_red_sum_double, __kmp_bar_red_min_double,
+     __kmp_bar_red_max_double}};
+
+/*!
+@ingroup SYNCHRONIZATION
+@param loc source location information
+@param global_tid global thread number
+@param type type of the reduced variable, one of kmp_bar_red_type
+@param op reduction operation, one of kmp_bar_red_op
+@param data on entry the partial result of this thread, on exit the result
+for the whole team
+
+A barrier that also reduces one int, float or double over the team. Each
+thread leaves its partial in a cache line of its own barrier state and the
+gather combines these in place, so the reduction costs a single barrier and
+no pointers into the stacks of other threads are followed. Every thread gets
+the result.
+*/
+void __kmpc_barrier_reduce(ident_t *loc, kmp_int32 global_tid, kmp_int32 type,
+                           kmp_int32 op, void *data) {
+  KMP_COUNT_BLOCK(REDUCE_fused);
+  kmp_info_t *th;
+  kmp_bstate_t *thr_bar;
+  int status;
+#if OMP_40_ENABLED
+  kmp_team_t *team;
+  int teams_swapped = 0, task_state;
+#endif
+
+  KA_TRACE(10, ("__kmpc_barrier_reduce() enter: called T#%d type %d op %d\n",
+                global_tid, type, op));
+  KMP_ASSERT(type >= 0 && type < kmp_bar_red_last_type);
+  KMP_ASSERT(op >= 0 && op < kmp_bar_red_last_op);
+
+  if (!TCR_4(__kmp_init_parallel))
+    __kmp_parallel_initialize();
+
+  if (__kmp_env_consistency_check)
+    __kmp_check_barrier(global_tid, ct_barrier, loc);
+
+  th = __kmp_thread_from_gtid(global_tid);
+#if OMP_40_ENABLED
+  teams_swapped = __kmp_swap_teams_for_teams_reduction(th, &team, &task_state);
+#endif // OMP_40_ENABLED
+
+  thr_bar = &th->th.th_bar[bs_reduction_barrier].bb;
+  switch (type) {
+  case kmp_bar_red_int32:
+    thr_bar->b_red.i32 = *(kmp_int32 *)data;
+    break;
+  case kmp_bar_red_float:
+    thr_bar->b_red.f = *(float *)data;
+    break;
+  default:
+    thr_bar->b_red.d = *(double *)data;
+  }
+
+#if OMPT_SUPPORT
+  omp_frame_t *ompt_frame;
+  if (ompt_enabled.enabled) {
+    __ompt_get_task_info_internal(0, NULL, NULL, &ompt_frame, NULL, NULL);
+    if (ompt_frame->enter_frame == NULL)
+      ompt_frame->enter_frame = OMPT_GET_FRAME_ADDRESS(1);
+    OMPT_STORE_RETURN_ADDRESS(global_tid);
+  }
+#endif
+  th->th.th_ident = loc;
+  status = __kmp_barrier(bs_reduction_barrier, global_tid, TRUE,
+                         sizeof(kmp_bar_red_t), &thr_bar->b_red,
+                         __kmp_bar_red_funcs[type][op]);
+  kmp_balign_team_t *team_bar = &th->th.th_team->t.t_bar[bs_reduction_barrier];
+  if (status == 0) {
+    // master: its slot holds the team result, publish it and release
+    team_bar->b_red = thr_bar->b_red;
+    __kmp_end_split_barrier(bs_reduction_barrier, global_tid);
+  }
+#if OMPT_SUPPORT && OMPT_OPTIONAL
+  if (ompt_enabled.enabled) {
+    ompt_frame->enter_frame = NULL;
+  }
+#endif
+
+  switch (type) {
+  case kmp_bar_red_int32:
+    *(kmp_int32 *)data = team_bar->b_red.i32;
+    break;
+  case kmp_bar_red_float:
+    *(float *)data = team_bar->b_red.f;
+    break;
+  default:
+    *(double *)data = team_bar->b_red.d;
+  }
+#if OMP_40_ENABLED
+  if (teams_swapped) {
+    __kmp_restore_swapped_teams(th, team, task_state);
+  }
+#endif
+
+  KA_TRACE(10, ("__kmpc_barrier_reduce() exit: called T#%d\n", global_tid));
+}
+
 #undef __KMP_GET_REDUCTION_METHOD
 #undef __KMP_SET_REDUCTION_METHOD
 
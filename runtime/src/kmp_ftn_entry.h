@@ -204,6 +204,17 @@ void FTN_STDCALL FTN_SET_DISP_NUM_BUFFERS(int KMP_DEREF arg) {
 #endif
 }
 
+void FTN_STDCALL FTN_PRINT_LOCK_PROFILE(void) {
+#ifdef KMP_STUB
+  ; // empty routine
+#else
+  if (!__kmp_init_serial) {
+    __kmp_serial_initialize();
+  }
+  __kmp_print_lock_profile();
+#endif
+}
+
 int FTN_STDCALL FTN_SET_AFFINITY(void **mask) {
 #if defined(KMP_STUB) || !KMP_AFFINITY_SUPPORTED
   return -1;
@@ -910,6 +921,8 @@ void FTN_STDCALL FTN_INIT_LOCK_WITH_HINT(void **user_lock,
   OMPT_STORE_RETURN_ADDRESS(gtid);
 #endif
   __kmpc_init_lock_with_hint(NULL, gtid, user_lock, KMP_DEREF hint);
+  if (__kmp_lock_profile)
+    __kmp_lock_prof_init(user_lock, kmp_lock_prof_lock, KMP_LOCK_PROF_CALLER());
 #endif
 }
 
@@ -923,6 +936,9 @@ void FTN_STDCALL FTN_INIT_NEST_LOCK_WITH_HINT(void **user_lock,
   OMPT_STORE_RETURN_ADDRESS(gtid);
 #endif
   __kmpc_init_nest_lock_with_hint(NULL, gtid, user_lock, KMP_DEREF hint);
+  if (__kmp_lock_profile)
+    __kmp_lock_prof_init(user_lock, kmp_lock_prof_nest_lock,
+                         KMP_LOCK_PROF_CALLER());
 #endif
 }
 #endif
@@ -937,6 +953,8 @@ void FTN_STDCALL KMP_EXPAND_NAME(FTN_INIT_LOCK)(void **user_lock) {
   OMPT_STORE_RETURN_ADDRESS(gtid);
 #endif
   __kmpc_init_lock(NULL, gtid, user_lock);
+  if (__kmp_lock_profile)
+    __kmp_lock_prof_init(user_lock, kmp_lock_prof_lock, KMP_LOCK_PROF_CALLER());
 #endif
 }
 
@@ -950,6 +968,9 @@ void FTN_STDCALL KMP_EXPAND_NAME(FTN_INIT_NEST_LOCK)(void **user_lock) {
   OMPT_STORE_RETURN_ADDRESS(gtid);
 #endif
   __kmpc_init_nest_lock(NULL, gtid, user_lock);
+  if (__kmp_lock_profile)
+    __kmp_lock_prof_init(user_lock, kmp_lock_prof_nest_lock,
+                         KMP_LOCK_PROF_CALLER());
 #endif
 }
 
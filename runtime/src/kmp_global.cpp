@@ -74,6 +74,8 @@ size_t __kmp_monitor_stksize = 0; // auto adjust
 #endif
 size_t __kmp_stkoffset = KMP_DEFAULT_STKOFFSET;
 int __kmp_stkpadding = KMP_MIN_STKPADDING;
+int __kmp_spawn_branch = 0; /* 0 - the master creates all workers */
+int __kmp_prespawn = FALSE;
 
 size_t __kmp_malloc_pool_incr = KMP_DEFAULT_MALLOC_POOL_INCR;
 
@@ -113,8 +115,9 @@ char const *__kmp_barrier_type_name[bs_last_barrier] = {"plain", "forkjoin"
                                                         "reduction"
 #endif // KMP_FAST_REDUCTION_BARRIER
 };
-char const *__kmp_barrier_pattern_name[bp_last_bar] = {"linear", "tree",
-                                                       "hyper", "hierarchical"};
+char const *__kmp_barrier_pattern_name[bp_last_bar] = {
+    "linear", "tree", "hyper", "hierarchical", "dist"};
+int __kmp_barrier_tuning = 0;
 
 int __kmp_allThreadsSpecified = 0;
 size_t __kmp_align_alloc = CACHE_LINE;
@@ -123,6 +126,7 @@ int __kmp_generate_warnings = kmp_warnings_low;
 int __kmp_reserve_warn = 0;
 int __kmp_xproc = 0;
 int __kmp_avail_proc = 0;
+int __kmp_num_numa_nodes = 1;
 size_t __kmp_sys_min_stksize = KMP_MIN_STKSIZE;
 int __kmp_sys_max_nth = KMP_MAX_NTH;
 int __kmp_max_nth = 0;
@@ -141,6 +145,12 @@ int __kmp_dflt_max_active_levels =
 int __kmp_hot_teams_mode = 0; /* 0 - free extra threads when reduced */
 /* 1 - keep extra threads when reduced */
 int __kmp_hot_teams_max_level = 1; /* nesting level of hot teams */
+int __kmp_hot_teams_adaptive = 0; /* forks at a deeper level before it is kept
+                                     hot, 0 - no adaptive hot teams */
+int __kmp_hot_teams_budget = 0; /* workers adaptive hot teams may keep,
+                                   0 - number of processors */
+std::atomic<kmp_int32> __kmp_hot_teams_reserved =
+    ATOMIC_VAR_INIT(0); /* workers kept by adaptive hot teams */
 #endif
 enum library_type __kmp_library = library_none;
 enum sched_type __kmp_sched =
@@ -158,6 +168,7 @@ int __kmp_hier_threads_per[kmp_hier_layer_e::LAYER_LAST + 1];
 kmp_hier_sched_env_t __kmp_hier_scheds = {0, 0, NULL, NULL, NULL};
 #endif
 int __kmp_dflt_blocktime = KMP_DEFAULT_BLOCKTIME;
+int __kmp_futex_sleep = FALSE;
 #if KMP_USE_MONITOR
 int __kmp_monitor_wakeups = KMP_MIN_MONITOR_WAKEUPS;
 int __kmp_bt_intervals = KMP_INTERVALS_FROM_BLOCKTIME(KMP_DEFAULT_BLOCKTIME,
@@ -209,6 +220,9 @@ char *__kmp_speculative_statsfile = "-";
 
 #endif // KMP_USE_ADAPTIVE_LOCKS
 
+int __kmp_lock_profile = FALSE;
+char *__kmp_lock_profile_file = NULL; // stderr
+
 #if OMP_40_ENABLED
 int __kmp_display_env = FALSE;
 int __kmp_display_env_verbose = FALSE;
@@ -274,6 +288,7 @@ kmp_affin_mask_t *__kmp_affinity_masks = NULL;
 unsigned __kmp_affinity_num_masks = 0;
 
 char *__kmp_cpuinfo_file = NULL;
+int __kmp_numa_local_state = TRUE;
 
 #endif /* KMP_AFFINITY_SUPPORTED */
 
@@ -308,6 +323,10 @@ kmp_uint64 __kmp_taskloop_min_tasks = 0;
 KMP_BUILD_ASSERT(sizeof(kmp_tasking_flags_t) == 4);
 
 int __kmp_task_stealing_constraint = 1; /* Constrain task stealing by default */
+int __kmp_task_deque_lockfree = KMP_USE_LOCKFREE_TASK_DEQUE;
+kmp_steal_policy_t __kmp_task_steal_policy = steal_random;
+int __kmp_task_continuation = FALSE;
+int __kmp_task_range_deps = FALSE;
 
 #ifdef DEBUG_SUSPEND
 int __kmp_suspend_count = 0;
@@ -876,6 +876,10 @@ void KMP_EXPAND_NAME(KMP_API_NAME_GOMP_TASK)(void (*func)(void *), void *data,
 #if OMP_40_ENABLED
                                              ,
                                              void **depend
+#endif
+#if OMP_45_ENABLED
+                                             ,
+                                             int priority
 #endif
                                              ) {
   MKLOC(loc, "GOMP_task");
@@ -893,6 +897,12 @@ void KMP_EXPAND_NAME(KMP_API_NAME_GOMP_TASK)(void (*func)(void *), void *data,
   if (gomp_flags & 2) {
     input_flags->final = 1;
   }
+#if OMP_45_ENABLED
+  // The fifth low-order bit is the "priority" flag
+  if (gomp_flags & 16) {
+    input_flags->priority_specified = 1;
+  }
+#endif
   input_flags->native = 1;
   // __kmp_task_alloc() sets up all other flags
 
@@ -903,6 +913,11 @@ void KMP_EXPAND_NAME(KMP_API_NAME_GOMP_TASK)(void (*func)(void *), void *data,
   kmp_task_t *task = __kmp_task_alloc(
       &loc, gtid, input_flags, sizeof(kmp_task_t),
       arg_size ? arg_size + arg_align - 1 : 0, (kmp_routine_entry_t)func);
+#if OMP_45_ENABLED
+  if (input_flags->priority_specified) {
+    task->data2.priority = priority;
+  }
+#endif
 
   if (arg_size > 0) {
     if (arg_align > 0) {
@@ -931,15 +946,43 @@ void KMP_EXPAND_NAME(KMP_API_NAME_GOMP_TASK)(void (*func)(void *), void *data,
 #if OMP_40_ENABLED
     if (gomp_flags & 8) {
       KMP_ASSERT(depend);
-      const size_t ndeps = (kmp_intptr_t)depend[0];
-      const size_t nout = (kmp_intptr_t)depend[1];
+      size_t ndeps = (kmp_intptr_t)depend[0];
+      size_t nout = (kmp_intptr_t)depend[1];
+      size_t nmtx = 0U, nin, offset = 2U;
+      if (ndeps == 0U) {
+        // Newer layout: {0, ndeps, nout, nmutexinoutset, nin, addresses...},
+        // the entries after the addresses point to depend objects
+        ndeps = (kmp_intptr_t)depend[1];
+        nout = (kmp_intptr_t)depend[2];
+        nmtx = (kmp_intptr_t)depend[3];
+        nin = (kmp_intptr_t)depend[4];
+        offset = 5U;
+      } else {
+        nin = ndeps - nout;
+      }
       kmp_depend_info_t dep_list[ndeps];
 
       for (size_t i = 0U; i < ndeps; i++) {
-        dep_list[i].base_addr = (kmp_intptr_t)depend[2U + i];
-        dep_list[i].len = 0U;
-        dep_list[i].flags.in = 1;
-        dep_list[i].flags.out = (i < nout);
+        kmp_depend_info_t *dep = &dep_list[i];
+        dep->len = 0U;
+        dep->flags.mtx = 0;
+        dep->flags.set = 0;
+        if (i < nout + nmtx + nin) {
+          dep->base_addr = (kmp_intptr_t)depend[offset + i];
+          dep->flags.mtx = (i >= nout && i < nout + nmtx);
+          dep->flags.in = !dep->flags.mtx;
+          dep->flags.out = (i < nout);
+        } else {
+          // depend object: the address and GOMP_DEPEND_IN (1), OUT (2),
+          // INOUT (3), MUTEXINOUTSET (4) or INOUTSET (5)
+          void **obj = (void **)depend[offset + i];
+          kmp_intptr_t kind = (kmp_intptr_t)obj[1];
+          dep->base_addr = (kmp_intptr_t)obj[0];
+          dep->flags.in = (kind >= 1 && kind <= 3);
+          dep->flags.out = (kind == 2 || kind == 3);
+          dep->flags.mtx = (kind == 4);
+          dep->flags.set = (kind == 5);
+        }
       }
       __kmpc_omp_task_with_deps(&loc, gtid, task, ndeps, dep_list, 0, NULL);
     } else {
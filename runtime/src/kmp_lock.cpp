@@ -2771,6 +2771,325 @@ void __kmp_spin_backoff(kmp_backoff_t *boff) {
   boff->step = (boff->step << 1 | 1) & (boff->max_backoff - 1);
 }
 
+// Lock contention profiling.
+// The table is allocated at initialization if KMP_LOCK_PROFILE is set. Entries
+// are claimed with a CAS on the key. When a lock is destroyed, or reinitialized
+// at another site, its counters are added to the totals of its site and its
+// entry is freed for other locks; freed entries keep their place in the probe
+// sequence of other keys.
+#define KMP_LOCK_PROF_FREED ((void *)1)
+
+static kmp_lock_prof_entry_t *__kmp_lock_prof_table = NULL;
+static volatile kmp_int32 __kmp_lock_prof_dropped = 0;
+
+typedef struct kmp_lock_prof_sum {
+  char const *psource;
+  void *site;
+  void *key;
+  kmp_int32 kind;
+  kmp_int32 locks;
+  kmp_uint64 acquires;
+  kmp_uint64 contended;
+  kmp_uint64 wait_ticks;
+  kmp_uint64 hold_ticks;
+} kmp_lock_prof_sum_t;
+
+// Totals of the sites of freed entries, under __kmp_lock_prof_sites_lock.
+static kmp_lock_prof_sum_t *__kmp_lock_prof_sites = NULL;
+static int __kmp_lock_prof_num_sites = 0;
+static kmp_bootstrap_lock_t __kmp_lock_prof_sites_lock =
+    KMP_BOOTSTRAP_LOCK_INITIALIZER(__kmp_lock_prof_sites_lock);
+
+void __kmp_init_lock_profile() {
+  if (!__kmp_lock_profile || __kmp_lock_prof_table != NULL)
+    return;
+  __kmp_lock_prof_table = (kmp_lock_prof_entry_t *)__kmp_allocate(
+      KMP_LOCK_PROF_TABLE_SIZE * sizeof(kmp_lock_prof_entry_t));
+  __kmp_lock_prof_sites = (kmp_lock_prof_sum_t *)__kmp_allocate(
+      KMP_LOCK_PROF_TABLE_SIZE * sizeof(kmp_lock_prof_sum_t));
+  __kmp_lock_prof_num_sites = 0;
+  __kmp_lock_prof_dropped = 0;
+  KA_TRACE(10, ("__kmp_init_lock_profile: %d entries\n",
+                KMP_LOCK_PROF_TABLE_SIZE));
+}
+
+void __kmp_cleanup_lock_profile() {
+  if (__kmp_lock_prof_table == NULL)
+    return;
+  __kmp_print_lock_profile();
+  __kmp_free(__kmp_lock_prof_table);
+  __kmp_lock_prof_table = NULL;
+  __kmp_free(__kmp_lock_prof_sites);
+  __kmp_lock_prof_sites = NULL;
+}
+
+kmp_uint64 __kmp_lock_prof_now() { return KMP_NOW(); }
+
+// Finds the entry of the lock at address key, claiming a free one if insert is
+// set. Only KMP_LOCK_PROF_MAX_PROBES entries are looked at, so a lookup costs
+// the same however full the table is. Returns NULL if the lock is not in the
+// table and cannot be added.
+static kmp_lock_prof_entry_t *__kmp_lock_prof_lookup(void *key, kmp_int32 kind,
+                                                     int insert) {
+  kmp_lock_prof_entry_t *table = __kmp_lock_prof_table;
+  if (table == NULL)
+    return NULL;
+  kmp_uint32 mask = KMP_LOCK_PROF_TABLE_SIZE - 1;
+  kmp_uint32 first =
+      (kmp_uint32)(((kmp_uint64)(kmp_uintptr_t)key * 0x9E3779B97F4A7C15ULL) >>
+                   32) &
+      mask;
+  for (;;) {
+    kmp_lock_prof_entry_t *slot = NULL; // first entry the key could take
+    kmp_uint32 i = first;
+    for (kmp_uint32 n = 0; n < KMP_LOCK_PROF_MAX_PROBES;
+         ++n, i = (i + 1) & mask) {
+      kmp_lock_prof_entry_t *e = &table[i];
+      void *k = TCR_PTR(e->key);
+      if (k == key)
+        return e;
+      if (k != NULL && k != KMP_LOCK_PROF_FREED)
+        continue;
+      if (slot == NULL)
+        slot = e;
+      if (k == NULL) // the key would be here or before
+        break;
+    }
+    if (!insert)
+      return NULL;
+    if (slot == NULL) {
+      KMP_TEST_THEN_INC32(&__kmp_lock_prof_dropped);
+      return NULL;
+    }
+    void *old = TCR_PTR(slot->key);
+    if ((old == NULL || old == KMP_LOCK_PROF_FREED) &&
+        KMP_COMPARE_AND_STORE_PTR(&slot->key, old, key)) {
+      slot->kind = kind;
+      return slot;
+    }
+    // Another lock took the entry first; look again.
+  }
+}
+
+// Locks of the same kind created at the same site are reported together.
+static int __kmp_lock_prof_same_site(kmp_lock_prof_sum_t const *s,
+                                     kmp_int32 kind, void *site,
+                                     char const *psource) {
+  if (s->kind != kind)
+    return FALSE;
+  if (s->site != NULL || site != NULL)
+    return s->site == site;
+  if (s->psource != NULL && psource != NULL)
+    return strcmp(s->psource, psource) == 0;
+  return FALSE;
+}
+
+// Adds the counters in e to the totals of its site in sums, which holds *n of
+// at most size sites. Returns FALSE if the site is new and there is no room.
+static int __kmp_lock_prof_add(kmp_lock_prof_sum_t *sums, int *n, int size,
+                               kmp_lock_prof_sum_t const *e) {
+  int j;
+  for (j = 0; j < *n; ++j)
+    if (__kmp_lock_prof_same_site(&sums[j], e->kind, e->site, e->psource))
+      break;
+  if (j == *n) {
+    if (*n == size)
+      return FALSE;
+    memset(&sums[j], 0, sizeof(sums[j]));
+    sums[j].psource = e->psource;
+    sums[j].site = e->site;
+    sums[j].key = e->key;
+    sums[j].kind = e->kind;
+    (*n)++;
+  }
+  sums[j].locks += e->locks;
+  sums[j].acquires += e->acquires;
+  sums[j].contended += e->contended;
+  sums[j].wait_ticks += e->wait_ticks;
+  sums[j].hold_ticks += e->hold_ticks;
+  return TRUE;
+}
+
+static void __kmp_lock_prof_entry_sum(kmp_lock_prof_sum_t *s,
+                                      kmp_lock_prof_entry_t const *e) {
+  s->psource = e->psource;
+  s->site = e->site;
+  s->key = e->key;
+  s->kind = e->kind;
+  s->locks = 1;
+  s->acquires = e->acquires;
+  s->contended = e->contended;
+  s->wait_ticks = e->wait_ticks;
+  s->hold_ticks = e->hold_ticks;
+}
+
+// Moves the counters of e to the totals of its site and frees e.
+static void __kmp_lock_prof_free(kmp_lock_prof_entry_t *e) {
+  if (e->acquires != 0) {
+    kmp_lock_prof_sum_t s;
+    __kmp_lock_prof_entry_sum(&s, e);
+    __kmp_acquire_bootstrap_lock(&__kmp_lock_prof_sites_lock);
+    if (!__kmp_lock_prof_add(__kmp_lock_prof_sites, &__kmp_lock_prof_num_sites,
+                             KMP_LOCK_PROF_TABLE_SIZE, &s))
+      KMP_TEST_THEN_INC32(&__kmp_lock_prof_dropped);
+    __kmp_release_bootstrap_lock(&__kmp_lock_prof_sites_lock);
+  }
+  e->psource = NULL;
+  e->site = NULL;
+  e->depth = 0;
+  e->acquires = e->contended = 0;
+  e->wait_ticks = e->hold_ticks = 0;
+  KMP_MB();
+  TCW_PTR(e->key, KMP_LOCK_PROF_FREED);
+}
+
+// Records the site that initialized a user lock.
+void __kmp_lock_prof_init(void *key, kmp_int32 kind, void *site) {
+  kmp_lock_prof_entry_t *e = __kmp_lock_prof_lookup(key, kind, TRUE);
+  if (e == NULL)
+    return;
+  if (e->acquires != 0 && (e->site != site || e->kind != kind)) {
+    __kmp_lock_prof_free(e);
+    e = __kmp_lock_prof_lookup(key, kind, TRUE);
+    if (e == NULL)
+      return;
+  }
+  e->kind = kind;
+  e->site = site;
+  e->depth = 0;
+}
+
+// Called when a user lock is destroyed.
+void __kmp_lock_prof_destroy(void *key) {
+  kmp_lock_prof_entry_t *e = __kmp_lock_prof_lookup(key, 0, FALSE);
+  if (e != NULL)
+    __kmp_lock_prof_free(e);
+}
+
+// Called by the new owner; start is the time the acquisition began and
+// contended tells whether the lock was busy at that time. The thread remembers
+// the entry, so that releasing the lock does not need to look it up again.
+void __kmp_lock_prof_acquired(void *key, kmp_int32 gtid, kmp_int32 kind,
+                              ident_t const *loc, kmp_uint64 start,
+                              int contended) {
+  kmp_uint64 now = KMP_NOW();
+  kmp_lock_prof_entry_t *e = __kmp_lock_prof_lookup(key, kind, TRUE);
+  if (e == NULL)
+    return;
+  if (gtid >= 0)
+    __kmp_threads[gtid]->th.th_lock_prof_held =
+        (kmp_int32)(e - __kmp_lock_prof_table) + 1;
+  if (e->depth++ > 0)
+    return;
+  if (e->psource == NULL && loc != NULL)
+    e->psource = loc->psource;
+  e->acquires++;
+  if (contended)
+    e->contended++;
+  e->wait_ticks += now - start;
+  e->hold_start = now;
+}
+
+// Called by the owner before it releases the lock.
+void __kmp_lock_prof_released(void *key, kmp_int32 gtid) {
+  kmp_lock_prof_entry_t *table = __kmp_lock_prof_table;
+  kmp_lock_prof_entry_t *e = NULL;
+  if (table == NULL)
+    return;
+  if (gtid >= 0) {
+    kmp_int32 held = __kmp_threads[gtid]->th.th_lock_prof_held;
+    if (held != 0 && TCR_PTR(table[held - 1].key) == key)
+      e = &table[held - 1];
+  }
+  if (e == NULL)
+    e = __kmp_lock_prof_lookup(key, 0, FALSE);
+  if (e == NULL || e->depth == 0)
+    return;
+  if (--e->depth == 0)
+    e->hold_ticks += KMP_NOW() - e->hold_start;
+}
+
+static int __kmp_lock_prof_compare(const void *a, const void *b) {
+  kmp_lock_prof_sum_t const *sa = (kmp_lock_prof_sum_t const *)a;
+  kmp_lock_prof_sum_t const *sb = (kmp_lock_prof_sum_t const *)b;
+  if (sa->wait_ticks != sb->wait_ticks)
+    return sa->wait_ticks > sb->wait_ticks ? -1 : 1;
+  if (sa->hold_ticks != sb->hold_ticks)
+    return sa->hold_ticks > sb->hold_ticks ? -1 : 1;
+  return 0;
+}
+
+// Reports are appended to KMP_LOCK_PROFILE_FILE, or go to stderr.
+static FILE *__kmp_open_lock_profile_file() {
+  if (__kmp_lock_profile_file == NULL)
+    return stderr;
+  FILE *result = fopen(__kmp_lock_profile_file, "a");
+  return result ? result : stderr;
+}
+
+// Prints the statistics gathered so far, sorted by wait time. Counters of
+// locks that are in use are read without synchronization, so the numbers are
+// approximate unless the program is quiescent.
+void __kmp_print_lock_profile() {
+  static char const *kinds[] = {"lock", "nest_lock", "critical"};
+  kmp_lock_prof_entry_t *table = __kmp_lock_prof_table;
+  if (table == NULL)
+    return;
+
+  // Room for the sites of the freed entries and one site per live entry
+  kmp_lock_prof_sum_t *sums = (kmp_lock_prof_sum_t *)KMP_INTERNAL_MALLOC(
+      2 * KMP_LOCK_PROF_TABLE_SIZE * sizeof(kmp_lock_prof_sum_t));
+  if (sums == NULL)
+    return;
+  __kmp_acquire_bootstrap_lock(&__kmp_lock_prof_sites_lock);
+  int n = __kmp_lock_prof_num_sites;
+  KMP_MEMCPY(sums, __kmp_lock_prof_sites, n * sizeof(*sums));
+  __kmp_release_bootstrap_lock(&__kmp_lock_prof_sites_lock);
+  for (int i = 0; i < KMP_LOCK_PROF_TABLE_SIZE; ++i) {
+    kmp_lock_prof_entry_t *e = &table[i];
+    void *k = TCR_PTR(e->key);
+    if (k == NULL || k == KMP_LOCK_PROF_FREED || e->acquires == 0)
+      continue;
+    kmp_lock_prof_sum_t s;
+    __kmp_lock_prof_entry_sum(&s, e);
+    __kmp_lock_prof_add(sums, &n, 2 * KMP_LOCK_PROF_TABLE_SIZE, &s);
+  }
+  qsort(sums, n, sizeof(*sums), __kmp_lock_prof_compare);
+
+  FILE *f = __kmp_open_lock_profile_file();
+#if KMP_OS_UNIX && (KMP_ARCH_X86 || KMP_ARCH_X86_64)
+  fprintf(f, "Lock contention profile (wait and hold times in TSC ticks)\n");
+#else
+  fprintf(f, "Lock contention profile (wait and hold times in nsec)\n");
+#endif
+  fprintf(f, "%-9s %6s %12s %12s %16s %16s  %s\n", "kind", "locks",
+          "acquires", "contended", "wait", "hold", "location");
+  for (int j = 0; j < n; ++j) {
+    kmp_lock_prof_sum_t *s = &sums[j];
+    fprintf(f, "%-9s %6d %12llu %12llu %16llu %16llu  ", kinds[s->kind],
+            s->locks, (unsigned long long)s->acquires,
+            (unsigned long long)s->contended,
+            (unsigned long long)s->wait_ticks,
+            (unsigned long long)s->hold_ticks);
+    if (s->site != NULL) {
+      fprintf(f, "initialized from %p\n", s->site);
+    } else if (s->psource != NULL) {
+      kmp_str_loc_t loc = __kmp_str_loc_init(s->psource, 0);
+      fprintf(f, "%s:%d %s\n", loc.file ? loc.file : "unknown", loc.line,
+              loc.func ? loc.func : "unknown");
+      __kmp_str_loc_free(&loc);
+    } else {
+      fprintf(f, "%p\n", s->key);
+    }
+  }
+  if (__kmp_lock_prof_dropped)
+    fprintf(f, "%d lock operations were not profiled (table full)\n",
+            (int)__kmp_lock_prof_dropped);
+  if (f != stderr)
+    fclose(f);
+  KMP_INTERNAL_FREE(sums);
+}
+
 #if KMP_USE_DYNAMIC_LOCK
 
 // Direct lock initializers. It simply writes a tag to the low 8 bits of the
@@ -2908,6 +3227,523 @@ static int __kmp_test_rtm_lock_with_checks(kmp_queuing_lock_t *lck,
 
 #endif // KMP_USE_TSX
 
+// NUMA cohort locks
+
+kmp_uint32 __kmp_cohort_lock_batch = 64;
+
+static kmp_int32 __kmp_get_cohort_lock_owner(kmp_cohort_lock_t *lck) {
+  return lck->lk.owner_id - 1;
+}
+
+static inline kmp_cohort_node_lock_t *
+__kmp_get_cohort_node_lock(kmp_cohort_lock_t *lck, kmp_int32 *node) {
+  // The node count may have changed since the lock was initialized.
+  *node = __kmp_get_numa_node();
+  if (*node >= lck->lk.num_nodes)
+    *node = 0;
+  return &lck->lk.nodes[*node];
+}
+
+int __kmp_acquire_cohort_lock(kmp_cohort_lock_t *lck, kmp_int32 gtid) {
+  kmp_int32 node;
+  kmp_cohort_node_lock_t *nlck = __kmp_get_cohort_node_lock(lck, &node);
+  kmp_uint32 my_ticket = std::atomic_fetch_add_explicit(
+      &nlck->next_ticket, 1U, std::memory_order_relaxed);
+
+  if (std::atomic_load_explicit(&nlck->now_serving,
+                                std::memory_order_acquire) != my_ticket) {
+    KMP_WAIT_YIELD_PTR(&nlck->now_serving, my_ticket, __kmp_bakery_check, lck);
+  }
+  // The node lock is ours; take the global one unless it came along with it.
+  if (!nlck->has_global) {
+    my_ticket = std::atomic_fetch_add_explicit(&lck->lk.next_ticket, 1U,
+                                               std::memory_order_relaxed);
+    if (std::atomic_load_explicit(&lck->lk.now_serving,
+                                  std::memory_order_acquire) != my_ticket) {
+      KMP_WAIT_YIELD_PTR(&lck->lk.now_serving, my_ticket, __kmp_bakery_check,
+                         lck);
+    }
+  }
+  lck->lk.owner_node = node;
+  KA_TRACE(1000, ("__kmp_acquire_cohort_lock: T#%d acquired lock %p on node "
+                  "%d (batch %u)\n",
+                  gtid, lck, node, nlck->batch));
+  return KMP_LOCK_ACQUIRED_FIRST;
+}
+
+static int __kmp_acquire_cohort_lock_with_checks(kmp_cohort_lock_t *lck,
+                                                 kmp_int32 gtid) {
+  char const *const func = "omp_set_lock";
+  if (lck->lk.initialized != lck) {
+    KMP_FATAL(LockIsUninitialized, func);
+  }
+  if ((gtid >= 0) && (__kmp_get_cohort_lock_owner(lck) == gtid)) {
+    KMP_FATAL(LockIsAlreadyOwned, func);
+  }
+
+  __kmp_acquire_cohort_lock(lck, gtid);
+
+  lck->lk.owner_id = gtid + 1;
+  return KMP_LOCK_ACQUIRED_FIRST;
+}
+
+int __kmp_test_cohort_lock(kmp_cohort_lock_t *lck, kmp_int32 gtid) {
+  kmp_int32 node;
+  kmp_cohort_node_lock_t *nlck = __kmp_get_cohort_node_lock(lck, &node);
+  kmp_uint32 my_ticket = std::atomic_load_explicit(&nlck->next_ticket,
+                                                   std::memory_order_relaxed);
+
+  if (std::atomic_load_explicit(&nlck->now_serving,
+                                std::memory_order_acquire) != my_ticket ||
+      !std::atomic_compare_exchange_strong_explicit(
+          &nlck->next_ticket, &my_ticket, my_ticket + 1,
+          std::memory_order_acquire, std::memory_order_acquire)) {
+    return FALSE;
+  }
+  if (!nlck->has_global) {
+    kmp_uint32 ticket = std::atomic_load_explicit(&lck->lk.next_ticket,
+                                                  std::memory_order_relaxed);
+    if (std::atomic_load_explicit(&lck->lk.now_serving,
+                                  std::memory_order_acquire) != ticket ||
+        !std::atomic_compare_exchange_strong_explicit(
+            &lck->lk.next_ticket, &ticket, ticket + 1,
+            std::memory_order_acquire, std::memory_order_acquire)) {
+      // Give the node lock back; its next owner takes the global lock itself.
+      std::atomic_store_explicit(&nlck->now_serving, my_ticket + 1,
+                                 std::memory_order_release);
+      return FALSE;
+    }
+  }
+  lck->lk.owner_node = node;
+  return TRUE;
+}
+
+static int __kmp_test_cohort_lock_with_checks(kmp_cohort_lock_t *lck,
+                                              kmp_int32 gtid) {
+  char const *const func = "omp_test_lock";
+  if (lck->lk.initialized != lck) {
+    KMP_FATAL(LockIsUninitialized, func);
+  }
+
+  int retval = __kmp_test_cohort_lock(lck, gtid);
+
+  if (retval) {
+    lck->lk.owner_id = gtid + 1;
+  }
+  return retval;
+}
+
+int __kmp_release_cohort_lock(kmp_cohort_lock_t *lck, kmp_int32 gtid) {
+  kmp_cohort_node_lock_t *nlck = &lck->lk.nodes[lck->lk.owner_node];
+  kmp_uint32 serving =
+      std::atomic_load_explicit(&nlck->now_serving, std::memory_order_relaxed);
+  kmp_uint32 waiting = std::atomic_load_explicit(&nlck->next_ticket,
+                                                 std::memory_order_relaxed) -
+                       serving - 1;
+
+  // Pass the global lock on within the node while somebody there waits,
+  // until the batch is used up.
+  if (waiting > 0 && nlck->batch < __kmp_cohort_lock_batch) {
+    nlck->batch++;
+    nlck->has_global = TRUE;
+  } else {
+    nlck->batch = 0;
+    nlck->has_global = FALSE;
+    std::atomic_fetch_add_explicit(&lck->lk.now_serving, 1U,
+                                   std::memory_order_release);
+  }
+  std::atomic_store_explicit(&nlck->now_serving, serving + 1,
+                             std::memory_order_release);
+  return KMP_LOCK_RELEASED;
+}
+
+static int __kmp_release_cohort_lock_with_checks(kmp_cohort_lock_t *lck,
+                                                 kmp_int32 gtid) {
+  char const *const func = "omp_unset_lock";
+  KMP_MB(); /* in case another processor initialized lock */
+  if (lck->lk.initialized != lck) {
+    KMP_FATAL(LockIsUninitialized, func);
+  }
+  if (__kmp_get_cohort_lock_owner(lck) == -1) {
+    KMP_FATAL(LockUnsettingFree, func);
+  }
+  if ((gtid >= 0) && (__kmp_get_cohort_lock_owner(lck) >= 0) &&
+      (__kmp_get_cohort_lock_owner(lck) != gtid)) {
+    KMP_FATAL(LockUnsettingSetByAnother, func);
+  }
+  lck->lk.owner_id = 0;
+  return __kmp_release_cohort_lock(lck, gtid);
+}
+
+void __kmp_init_cohort_lock(kmp_cohort_lock_t *lck) {
+  lck->lk.location = NULL;
+  lck->lk.flags = 0;
+  lck->lk.num_nodes = __kmp_num_numa_nodes;
+  lck->lk.nodes = (kmp_cohort_node_lock_t *)__kmp_allocate(
+      lck->lk.num_nodes * sizeof(kmp_cohort_node_lock_t));
+  lck->lk.next_ticket = 0;
+  lck->lk.now_serving = 0;
+  lck->lk.owner_id = 0; // no thread owns the lock.
+  lck->lk.owner_node = 0;
+  lck->lk.depth_locked = -1;
+  lck->lk.initialized = lck;
+
+  KA_TRACE(1000, ("__kmp_init_cohort_lock: lock %p initialized, %d nodes\n",
+                  lck, lck->lk.num_nodes));
+}
+
+void __kmp_destroy_cohort_lock(kmp_cohort_lock_t *lck) {
+  lck->lk.initialized = NULL;
+  lck->lk.location = NULL;
+  if (lck->lk.nodes != NULL) {
+    __kmp_free(lck->lk.nodes);
+    lck->lk.nodes = NULL;
+  }
+  lck->lk.num_nodes = 0;
+  lck->lk.next_ticket = 0;
+  lck->lk.now_serving = 0;
+  lck->lk.owner_id = 0;
+  lck->lk.owner_node = 0;
+}
+
+static const ident_t *__kmp_get_cohort_lock_location(kmp_cohort_lock_t *lck) {
+  return lck->lk.location;
+}
+
+static void __kmp_set_cohort_lock_location(kmp_cohort_lock_t *lck,
+                                           const ident_t *loc) {
+  lck->lk.location = loc;
+}
+
+static kmp_lock_flags_t __kmp_get_cohort_lock_flags(kmp_cohort_lock_t *lck) {
+  return lck->lk.flags;
+}
+
+static void __kmp_set_cohort_lock_flags(kmp_cohort_lock_t *lck,
+                                        kmp_lock_flags_t flags) {
+  lck->lk.flags = flags;
+}
+
+// Reader-writer locks
+
+static kmp_int32 __kmp_get_rw_lock_owner(kmp_rw_lock_t *lck) {
+  return KMP_ATOMIC_LD_RLX(&lck->lk.writer) - 1;
+}
+
+static inline void __kmp_rw_lock_yield(kmp_uint32 *spins) {
+  if (TCR_4(__kmp_nth) > (__kmp_avail_proc ? __kmp_avail_proc : __kmp_xproc)) {
+    KMP_YIELD(TRUE);
+  } else {
+    KMP_YIELD_SPIN(*spins);
+  }
+}
+
+int __kmp_acquire_rw_lock_shared(kmp_rw_lock_t *lck, kmp_int32 reader) {
+  std::atomic<kmp_int32> *readers =
+      &lck->lk.slots[reader & (lck->lk.num_slots - 1)].readers;
+  kmp_uint32 spins;
+
+  for (;;) {
+    // Count in first, then look for a writer; the writer does it the other way
+    // round, so at least one of the two sees the other.
+    readers->fetch_add(1, std::memory_order_seq_cst);
+    if (lck->lk.writer.load(std::memory_order_seq_cst) == 0)
+      return KMP_LOCK_ACQUIRED_FIRST;
+    // A writer holds the lock or waits for the readers; get out of its way.
+    readers->fetch_sub(1, std::memory_order_release);
+    KMP_INIT_YIELD(spins);
+    while (KMP_ATOMIC_LD_RLX(&lck->lk.writer) != 0)
+      __kmp_rw_lock_yield(&spins);
+  }
+}
+
+int __kmp_release_rw_lock_shared(kmp_rw_lock_t *lck, kmp_int32 reader) {
+  lck->lk.slots[reader & (lck->lk.num_slots - 1)].readers.fetch_sub(
+      1, std::memory_order_release);
+  return KMP_LOCK_RELEASED;
+}
+
+// Waits until all readers are gone; the writer word is already set.
+static void __kmp_wait_rw_lock_readers(kmp_rw_lock_t *lck) {
+  kmp_uint32 i, spins;
+  KMP_INIT_YIELD(spins);
+  for (i = 0; i < lck->lk.num_slots; ++i) {
+    while (lck->lk.slots[i].readers.load(std::memory_order_seq_cst) != 0)
+      __kmp_rw_lock_yield(&spins);
+  }
+}
+
+int __kmp_acquire_rw_lock(kmp_rw_lock_t *lck, kmp_int32 gtid) {
+  kmp_int32 rw_free = 0;
+  kmp_uint32 spins;
+
+  if (KMP_ATOMIC_LD_RLX(&lck->lk.writer) != 0 ||
+      !lck->lk.writer.compare_exchange_strong(rw_free, gtid + 1,
+                                              std::memory_order_seq_cst)) {
+    KMP_INIT_YIELD(spins);
+    do {
+      __kmp_rw_lock_yield(&spins);
+      rw_free = 0;
+    } while (KMP_ATOMIC_LD_RLX(&lck->lk.writer) != 0 ||
+             !lck->lk.writer.compare_exchange_strong(
+                 rw_free, gtid + 1, std::memory_order_seq_cst));
+  }
+  __kmp_wait_rw_lock_readers(lck);
+  return KMP_LOCK_ACQUIRED_FIRST;
+}
+
+static int __kmp_acquire_rw_lock_with_checks(kmp_rw_lock_t *lck,
+                                             kmp_int32 gtid) {
+  char const *const func = "omp_set_lock";
+  if (lck->lk.initialized != lck) {
+    KMP_FATAL(LockIsUninitialized, func);
+  }
+  if ((gtid >= 0) && (__kmp_get_rw_lock_owner(lck) == gtid)) {
+    KMP_FATAL(LockIsAlreadyOwned, func);
+  }
+  return __kmp_acquire_rw_lock(lck, gtid);
+}
+
+int __kmp_test_rw_lock(kmp_rw_lock_t *lck, kmp_int32 gtid) {
+  kmp_int32 rw_free = 0;
+  kmp_uint32 i;
+
+  if (KMP_ATOMIC_LD_RLX(&lck->lk.writer) != 0 ||
+      !lck->lk.writer.compare_exchange_strong(rw_free, gtid + 1,
+                                              std::memory_order_seq_cst)) {
+    return FALSE;
+  }
+  for (i = 0; i < lck->lk.num_slots; ++i) {
+    if (lck->lk.slots[i].readers.load(std::memory_order_seq_cst) != 0) {
+      lck->lk.writer.store(0, std::memory_order_release);
+      return FALSE;
+    }
+  }
+  return TRUE;
+}
+
+static int __kmp_test_rw_lock_with_checks(kmp_rw_lock_t *lck, kmp_int32 gtid) {
+  char const *const func = "omp_test_lock";
+  if (lck->lk.initialized != lck) {
+    KMP_FATAL(LockIsUninitialized, func);
+  }
+  return __kmp_test_rw_lock(lck, gtid);
+}
+
+int __kmp_release_rw_lock(kmp_rw_lock_t *lck, kmp_int32 gtid) {
+  lck->lk.writer.store(0, std::memory_order_release);
+  return KMP_LOCK_RELEASED;
+}
+
+static int __kmp_release_rw_lock_with_checks(kmp_rw_lock_t *lck,
+                                             kmp_int32 gtid) {
+  char const *const func = "omp_unset_lock";
+  KMP_MB(); /* in case another processor initialized lock */
+  if (lck->lk.initialized != lck) {
+    KMP_FATAL(LockIsUninitialized, func);
+  }
+  if (__kmp_get_rw_lock_owner(lck) == -1) {
+    KMP_FATAL(LockUnsettingFree, func);
+  }
+  if ((gtid >= 0) && (__kmp_get_rw_lock_owner(lck) != gtid)) {
+    KMP_FATAL(LockUnsettingSetByAnother, func);
+  }
+  return __kmp_release_rw_lock(lck, gtid);
+}
+
+void __kmp_init_rw_lock(kmp_rw_lock_t *lck) {
+  kmp_uint32 num_slots = 1;
+  while (num_slots < (kmp_uint32)__kmp_xproc &&
+         num_slots < KMP_RW_LOCK_MAX_SLOTS)
+    num_slots <<= 1;
+  lck->lk.location = NULL;
+  lck->lk.flags = 0;
+  lck->lk.num_slots = num_slots;
+  lck->lk.slots = (kmp_rw_lock_slot_t *)__kmp_allocate(
+      num_slots * sizeof(kmp_rw_lock_slot_t));
+  lck->lk.writer = 0;
+  lck->lk.depth_locked = -1;
+  lck->lk.initialized = lck;
+
+  KA_TRACE(1000, ("__kmp_init_rw_lock: lock %p initialized, %u slots\n", lck,
+                  num_slots));
+}
+
+void __kmp_destroy_rw_lock(kmp_rw_lock_t *lck) {
+  lck->lk.initialized = NULL;
+  lck->lk.location = NULL;
+  if (lck->lk.slots != NULL) {
+    __kmp_free(lck->lk.slots);
+    lck->lk.slots = NULL;
+  }
+  lck->lk.num_slots = 0;
+  lck->lk.writer = 0;
+}
+
+static const ident_t *__kmp_get_rw_lock_location(kmp_rw_lock_t *lck) {
+  return lck->lk.location;
+}
+
+static void __kmp_set_rw_lock_location(kmp_rw_lock_t *lck,
+                                       const ident_t *loc) {
+  lck->lk.location = loc;
+}
+
+static kmp_lock_flags_t __kmp_get_rw_lock_flags(kmp_rw_lock_t *lck) {
+  return lck->lk.flags;
+}
+
+static void __kmp_set_rw_lock_flags(kmp_rw_lock_t *lck,
+                                    kmp_lock_flags_t flags) {
+  lck->lk.flags = flags;
+}
+
+// Morphing locks
+
+kmp_uint32 __kmp_morph_lock_upgrade = 8;
+kmp_uint32 __kmp_morph_lock_downgrade = 1024;
+
+#if KMP_USE_FUTEX
+#define KMP_MORPH_WAITERS(op) __kmp_##op##_futex_lock
+#else
+#define KMP_MORPH_WAITERS(op) __kmp_##op##_queuing_lock
+#endif
+
+static kmp_int32 __kmp_get_morph_lock_owner(kmp_morph_lock_t *lck) {
+  return __kmp_get_tas_lock_owner(&lck->lk.tas);
+}
+
+// Called by the new owner: every contended acquisition raises the score and
+// every uncontended one lowers it, so only lasting contention switches modes.
+static inline void __kmp_morph_lock_acquired(kmp_morph_lock_t *lck,
+                                             int contended) {
+  kmp_int32 upgrade = (kmp_int32)__kmp_morph_lock_upgrade;
+  if (contended) {
+    lck->lk.quiet = 0;
+    if (lck->lk.hot < upgrade && ++lck->lk.hot == upgrade &&
+        !KMP_ATOMIC_LD_RLX(&lck->lk.queued)) {
+      KMP_ATOMIC_ST_RLX(&lck->lk.queued, TRUE);
+      KA_TRACE(1000, ("__kmp_morph_lock_acquired: lock %p queued\n", lck));
+    }
+  } else {
+    if (lck->lk.hot > 0)
+      lck->lk.hot--;
+    if (KMP_ATOMIC_LD_RLX(&lck->lk.queued) &&
+        ++lck->lk.quiet >= __kmp_morph_lock_downgrade) {
+      KMP_ATOMIC_ST_RLX(&lck->lk.queued, FALSE);
+      lck->lk.quiet = 0;
+      lck->lk.hot = 0;
+      KA_TRACE(1000, ("__kmp_morph_lock_acquired: lock %p unqueued\n", lck));
+    }
+  }
+}
+
+int __kmp_acquire_morph_lock(kmp_morph_lock_t *lck, kmp_int32 gtid) {
+  if (__kmp_test_tas_lock(&lck->lk.tas, gtid)) {
+    __kmp_morph_lock_acquired(lck, FALSE);
+    return KMP_LOCK_ACQUIRED_FIRST;
+  }
+  if (KMP_ATOMIC_LD_RLX(&lck->lk.queued)) {
+    // Only one contender at a time competes for the lock word
+    KMP_MORPH_WAITERS(acquire)(&lck->lk.waiters, gtid);
+    __kmp_acquire_tas_lock(&lck->lk.tas, gtid);
+    KMP_MORPH_WAITERS(release)(&lck->lk.waiters, gtid);
+  } else {
+    __kmp_acquire_tas_lock(&lck->lk.tas, gtid);
+  }
+  __kmp_morph_lock_acquired(lck, TRUE);
+  return KMP_LOCK_ACQUIRED_FIRST;
+}
+
+static int __kmp_acquire_morph_lock_with_checks(kmp_morph_lock_t *lck,
+                                                kmp_int32 gtid) {
+  char const *const func = "omp_set_lock";
+  if (lck->lk.initialized != lck) {
+    KMP_FATAL(LockIsUninitialized, func);
+  }
+  if ((gtid >= 0) && (__kmp_get_morph_lock_owner(lck) == gtid)) {
+    KMP_FATAL(LockIsAlreadyOwned, func);
+  }
+  return __kmp_acquire_morph_lock(lck, gtid);
+}
+
+int __kmp_test_morph_lock(kmp_morph_lock_t *lck, kmp_int32 gtid) {
+  if (__kmp_test_tas_lock(&lck->lk.tas, gtid)) {
+    __kmp_morph_lock_acquired(lck, FALSE);
+    return TRUE;
+  }
+  return FALSE;
+}
+
+static int __kmp_test_morph_lock_with_checks(kmp_morph_lock_t *lck,
+                                             kmp_int32 gtid) {
+  char const *const func = "omp_test_lock";
+  if (lck->lk.initialized != lck) {
+    KMP_FATAL(LockIsUninitialized, func);
+  }
+  return __kmp_test_morph_lock(lck, gtid);
+}
+
+int __kmp_release_morph_lock(kmp_morph_lock_t *lck, kmp_int32 gtid) {
+  return __kmp_release_tas_lock(&lck->lk.tas, gtid);
+}
+
+static int __kmp_release_morph_lock_with_checks(kmp_morph_lock_t *lck,
+                                                kmp_int32 gtid) {
+  char const *const func = "omp_unset_lock";
+  KMP_MB(); /* in case another processor initialized lock */
+  if (lck->lk.initialized != lck) {
+    KMP_FATAL(LockIsUninitialized, func);
+  }
+  if (__kmp_get_morph_lock_owner(lck) == -1) {
+    KMP_FATAL(LockUnsettingFree, func);
+  }
+  if ((gtid >= 0) && (__kmp_get_morph_lock_owner(lck) != gtid)) {
+    KMP_FATAL(LockUnsettingSetByAnother, func);
+  }
+  return __kmp_release_morph_lock(lck, gtid);
+}
+
+void __kmp_init_morph_lock(kmp_morph_lock_t *lck) {
+  lck->lk.location = NULL;
+  lck->lk.flags = 0;
+  __kmp_init_tas_lock(&lck->lk.tas);
+  KMP_MORPH_WAITERS(init)(&lck->lk.waiters);
+  lck->lk.queued = FALSE;
+  lck->lk.hot = 0;
+  lck->lk.quiet = 0;
+  lck->lk.depth_locked = -1;
+  lck->lk.initialized = lck;
+
+  KA_TRACE(1000, ("__kmp_init_morph_lock: lock %p initialized\n", lck));
+}
+
+void __kmp_destroy_morph_lock(kmp_morph_lock_t *lck) {
+  lck->lk.initialized = NULL;
+  lck->lk.location = NULL;
+  __kmp_destroy_tas_lock(&lck->lk.tas);
+  KMP_MORPH_WAITERS(destroy)(&lck->lk.waiters);
+  lck->lk.queued = FALSE;
+}
+
+static const ident_t *__kmp_get_morph_lock_location(kmp_morph_lock_t *lck) {
+  return lck->lk.location;
+}
+
+static void __kmp_set_morph_lock_location(kmp_morph_lock_t *lck,
+                                          const ident_t *loc) {
+  lck->lk.location = loc;
+}
+
+static kmp_lock_flags_t __kmp_get_morph_lock_flags(kmp_morph_lock_t *lck) {
+  return lck->lk.flags;
+}
+
+static void __kmp_set_morph_lock_flags(kmp_morph_lock_t *lck,
+                                       kmp_lock_flags_t flags) {
+  lck->lk.flags = flags;
+}
+
 // Entry functions for indirect locks (first element of direct lock jump tables)
 static void __kmp_init_indirect_lock(kmp_dyna_lock_t *l,
                                      kmp_dyna_lockseq_t tag);
@@ -3201,6 +4037,51 @@ static int __kmp_test_indirect_lock_with_checks(kmp_dyna_lock_t *lock,
   return KMP_I_LOCK_FUNC(l, test)(l->lock, gtid);
 }
 
+// Reader side of rw locks. Any other lock is simply acquired and released.
+// Reader id of the current task of gtid for the slots of rw locks: the gtid it
+// first took a shared lock on, wherever it runs now.
+static inline kmp_int32 __kmp_rw_lock_reader(kmp_int32 gtid) {
+  kmp_taskdata_t *task = __kmp_threads[gtid]->th.th_current_task;
+  if (task->td_rw_reader == 0)
+    task->td_rw_reader = gtid + 1;
+  return task->td_rw_reader - 1;
+}
+
+int __kmp_set_lock_shared(kmp_dyna_lock_t *lock, kmp_int32 gtid) {
+  if (KMP_EXTRACT_D_TAG(lock) == 0) {
+    kmp_indirect_lock_t *l =
+        __kmp_lookup_indirect_lock((void **)lock, "omp_set_lock");
+    if (l->type == locktag_rw) {
+      kmp_rw_lock_t *lck = (kmp_rw_lock_t *)l->lock;
+      if (__kmp_env_consistency_check) {
+        if (lck->lk.initialized != lck) {
+          KMP_FATAL(LockIsUninitialized, "omp_set_lock");
+        }
+        if (__kmp_get_rw_lock_owner(lck) == gtid) {
+          KMP_FATAL(LockIsAlreadyOwned, "omp_set_lock");
+        }
+      }
+      return __kmp_acquire_rw_lock_shared(lck, __kmp_rw_lock_reader(gtid));
+    }
+  }
+  return __kmp_direct_set[KMP_EXTRACT_D_TAG(lock)](lock, gtid);
+}
+
+int __kmp_unset_lock_shared(kmp_dyna_lock_t *lock, kmp_int32 gtid) {
+  if (KMP_EXTRACT_D_TAG(lock) == 0) {
+    kmp_indirect_lock_t *l =
+        __kmp_lookup_indirect_lock((void **)lock, "omp_unset_lock");
+    if (l->type == locktag_rw) {
+      kmp_rw_lock_t *lck = (kmp_rw_lock_t *)l->lock;
+      if (__kmp_env_consistency_check && lck->lk.initialized != lck) {
+        KMP_FATAL(LockIsUninitialized, "omp_unset_lock");
+      }
+      return __kmp_release_rw_lock_shared(lck, __kmp_rw_lock_reader(gtid));
+    }
+  }
+  return __kmp_direct_unset[KMP_EXTRACT_D_TAG(lock)](lock, gtid);
+}
+
 kmp_dyna_lockseq_t __kmp_user_lock_seq = lockseq_queuing;
 
 // This is used only in kmp_error.cpp when consistency checking is on.
@@ -3226,6 +4107,12 @@ kmp_int32 __kmp_get_user_lock_owner(kmp_user_lock_p lck, kmp_uint32 seq) {
   case lockseq_drdpa:
   case lockseq_nested_drdpa:
     return __kmp_get_drdpa_lock_owner((kmp_drdpa_lock_t *)lck);
+  case lockseq_cohort:
+    return __kmp_get_cohort_lock_owner((kmp_cohort_lock_t *)lck);
+  case lockseq_rw:
+    return __kmp_get_rw_lock_owner((kmp_rw_lock_t *)lck);
+  case lockseq_morph:
+    return __kmp_get_morph_lock_owner((kmp_morph_lock_t *)lck);
   default:
     return 0;
   }
@@ -3270,6 +4157,9 @@ void __kmp_init_dynamic_user_locks() {
   __kmp_indirect_lock_size[locktag_adaptive] = sizeof(kmp_adaptive_lock_t);
 #endif
   __kmp_indirect_lock_size[locktag_drdpa] = sizeof(kmp_drdpa_lock_t);
+  __kmp_indirect_lock_size[locktag_cohort] = sizeof(kmp_cohort_lock_t);
+  __kmp_indirect_lock_size[locktag_rw] = sizeof(kmp_rw_lock_t);
+  __kmp_indirect_lock_size[locktag_morph] = sizeof(kmp_morph_lock_t);
 #if KMP_USE_TSX
   __kmp_indirect_lock_size[locktag_rtm] = sizeof(kmp_queuing_lock_t);
 #endif
@@ -3294,12 +4184,18 @@ void __kmp_init_dynamic_user_locks() {
   {                                                                            \
     fill_jumps(table, expand, _);                                              \
     table[locktag_adaptive] = expand(queuing);                                 \
+    table[locktag_cohort] = expand(cohort);                                    \
+    table[locktag_rw] = expand(rw);                                            \
+    table[locktag_morph] = expand(morph);                                      \
     fill_jumps(table, expand, _nested_);                                       \
   }
 #else
 #define fill_table(table, expand)                                              \
   {                                                                            \
     fill_jumps(table, expand, _);                                              \
+    table[locktag_cohort] = expand(cohort);                                    \
+    table[locktag_rw] = expand(rw);                                            \
+    table[locktag_morph] = expand(morph);                                      \
     fill_jumps(table, expand, _nested_);                                       \
   }
 #endif // KMP_USE_ADAPTIVE_LOCKS
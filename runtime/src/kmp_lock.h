@@ -20,6 +20,10 @@
 #include "kmp_debug.h"
 #include "kmp_os.h"
 
+#if KMP_COMPILER_MSVC
+#include <intrin.h> // _ReturnAddress
+#endif
+
 #ifdef __cplusplus
 #include <atomic>
 
@@ -503,6 +507,180 @@ extern int __kmp_release_nested_drdpa_lock(kmp_drdpa_lock_t *lck,
 extern void __kmp_init_nested_drdpa_lock(kmp_drdpa_lock_t *lck);
 extern void __kmp_destroy_nested_drdpa_lock(kmp_drdpa_lock_t *lck);
 
+#if KMP_USE_DYNAMIC_LOCK
+
+// ----------------------------------------------------------------------------
+// NUMA cohort locks.
+//
+// A global ticket lock plus one ticket lock per NUMA node. A thread first gets
+// the lock of its own node; whoever holds that one either inherited the global
+// lock from the previous owner on the same node or takes it. On release, the
+// owner passes the global lock on to the next waiter on its node, at most
+// __kmp_cohort_lock_batch times in a row, before it lets other nodes have it.
+// This keeps the lock and the data it protects on one node for a while instead
+// of moving them between sockets at almost every hand-off.
+struct KMP_ALIGN_CACHE kmp_cohort_node_lock {
+  std::atomic<kmp_uint32> next_ticket;
+  std::atomic<kmp_uint32> now_serving;
+  // The following are only accessed by the holder of this node lock.
+  kmp_uint32 batch; // # of hand-offs within the node since the global lock
+  // was taken
+  kmp_int32 has_global; // the global lock was passed on with the node lock
+};
+
+typedef struct kmp_cohort_node_lock kmp_cohort_node_lock_t;
+
+struct kmp_base_cohort_lock {
+  // initialized must be the first entry in the lock data structure!
+  KMP_ALIGN_CACHE
+  volatile union kmp_cohort_lock
+      *initialized; // points to the lock union if in initialized state
+  ident_t const *location; // Source code location of omp_init_lock().
+  kmp_cohort_node_lock_t *nodes; // one lock per NUMA node
+  kmp_int32 num_nodes;
+  kmp_lock_flags_t flags; // lock specifics, e.g. critical section lock
+
+  // The global lock, on its own cache line.
+  KMP_ALIGN_CACHE
+  std::atomic<kmp_uint32> next_ticket;
+  std::atomic<kmp_uint32> now_serving;
+
+  // Only written by the owner.
+  KMP_ALIGN_CACHE
+  volatile kmp_int32 owner_id; // (gtid+1) of owning thread, 0 if unlocked
+  kmp_int32 owner_node; // node lock held by the owner
+  kmp_int32 depth_locked; // -1 for simple locks, no nested cohort locks
+};
+
+typedef struct kmp_base_cohort_lock kmp_base_cohort_lock_t;
+
+union KMP_ALIGN_CACHE kmp_cohort_lock {
+  kmp_base_cohort_lock_t lk;
+  kmp_lock_pool_t pool;
+  double lk_align; // use worst case alignment
+  char lk_pad[KMP_PAD(kmp_base_cohort_lock_t, CACHE_LINE)];
+};
+
+typedef union kmp_cohort_lock kmp_cohort_lock_t;
+
+// Max # of consecutive hand-offs of a cohort lock within a NUMA node.
+extern kmp_uint32 __kmp_cohort_lock_batch;
+
+extern int __kmp_acquire_cohort_lock(kmp_cohort_lock_t *lck, kmp_int32 gtid);
+extern int __kmp_test_cohort_lock(kmp_cohort_lock_t *lck, kmp_int32 gtid);
+extern int __kmp_release_cohort_lock(kmp_cohort_lock_t *lck, kmp_int32 gtid);
+extern void __kmp_init_cohort_lock(kmp_cohort_lock_t *lck);
+extern void __kmp_destroy_cohort_lock(kmp_cohort_lock_t *lck);
+
+// ----------------------------------------------------------------------------
+// Reader-writer locks.
+//
+// omp_set_lock and friends take the lock exclusively (as a writer),
+// __kmpc_set_lock_shared takes it as a reader. Readers count themselves in on
+// one of several cache-line-sized slots, so readers on different slots do not
+// share any cache line. The slot is picked by a reader id the holding task
+// keeps (td_rw_reader), so an untied task that moves to another thread
+// releases the slot it took. A writer first claims the
+// writer word, which keeps new readers out, and then waits for every slot to
+// drain.
+#define KMP_RW_LOCK_MAX_SLOTS 64
+
+struct KMP_ALIGN_CACHE kmp_rw_lock_slot {
+  std::atomic<kmp_int32> readers; // # of readers in this slot
+};
+
+typedef struct kmp_rw_lock_slot kmp_rw_lock_slot_t;
+
+struct kmp_base_rw_lock {
+  // initialized must be the first entry in the lock data structure!
+  KMP_ALIGN_CACHE
+  volatile union kmp_rw_lock
+      *initialized; // points to the lock union if in initialized state
+  ident_t const *location; // Source code location of omp_init_lock().
+  kmp_rw_lock_slot_t *slots; // reader indicators
+  kmp_uint32 num_slots; // must be power of 2
+  kmp_lock_flags_t flags; // lock specifics, e.g. critical section lock
+
+  KMP_ALIGN_CACHE
+  std::atomic<kmp_int32> writer; // (gtid+1) of the writer, 0 if none
+  kmp_int32 depth_locked; // -1 for simple locks, no nested rw locks
+};
+
+typedef struct kmp_base_rw_lock kmp_base_rw_lock_t;
+
+union KMP_ALIGN_CACHE kmp_rw_lock {
+  kmp_base_rw_lock_t lk;
+  kmp_lock_pool_t pool;
+  double lk_align; // use worst case alignment
+  char lk_pad[KMP_PAD(kmp_base_rw_lock_t, CACHE_LINE)];
+};
+
+typedef union kmp_rw_lock kmp_rw_lock_t;
+
+extern int __kmp_acquire_rw_lock(kmp_rw_lock_t *lck, kmp_int32 gtid);
+extern int __kmp_test_rw_lock(kmp_rw_lock_t *lck, kmp_int32 gtid);
+extern int __kmp_release_rw_lock(kmp_rw_lock_t *lck, kmp_int32 gtid);
+extern void __kmp_init_rw_lock(kmp_rw_lock_t *lck);
+extern void __kmp_destroy_rw_lock(kmp_rw_lock_t *lck);
+
+extern int __kmp_acquire_rw_lock_shared(kmp_rw_lock_t *lck, kmp_int32 reader);
+extern int __kmp_release_rw_lock_shared(kmp_rw_lock_t *lck, kmp_int32 reader);
+
+// ----------------------------------------------------------------------------
+// Morphing locks.
+//
+// The lock word is a test and set lock, so an uncontended acquisition costs a
+// single CAS. The owner keeps a contention score in the lock; once contention
+// persists, the lock switches to queued mode, in which contenders first wait
+// on a futex lock (a queuing lock where futexes are unavailable) and only the
+// owner of that lock spins on the lock word. After a run of uncontended
+// acquisitions the lock switches back. Only the lock word decides ownership,
+// so a switch never has to drain the waiters.
+struct kmp_base_morph_lock {
+  // initialized must be the first entry in the lock data structure!
+  KMP_ALIGN_CACHE
+  volatile union kmp_morph_lock
+      *initialized; // points to the lock union if in initialized state
+  ident_t const *location; // Source code location of omp_init_lock().
+  kmp_lock_flags_t flags; // lock specifics, e.g. critical section lock
+  kmp_tas_lock_t tas; // the lock word
+  std::atomic<kmp_int32> queued; // TRUE if contenders go through waiters
+  kmp_int32 hot; // contention score, changed by the owner only
+  kmp_uint32 quiet; // uncontended acquisitions in a row while queued
+  kmp_int32 depth_locked; // -1 for simple locks, no nested morph locks
+
+  KMP_ALIGN_CACHE
+#if KMP_USE_FUTEX
+  kmp_futex_lock_t waiters;
+#else
+  kmp_queuing_lock_t waiters;
+#endif
+};
+
+typedef struct kmp_base_morph_lock kmp_base_morph_lock_t;
+
+union KMP_ALIGN_CACHE kmp_morph_lock {
+  kmp_base_morph_lock_t lk;
+  kmp_lock_pool_t pool;
+  double lk_align; // use worst case alignment
+  char lk_pad[KMP_PAD(kmp_base_morph_lock_t, CACHE_LINE)];
+};
+
+typedef union kmp_morph_lock kmp_morph_lock_t;
+
+// Contention score that switches a morph lock to queued mode (0: never), and
+// # of uncontended acquisitions in a row that switch it back.
+extern kmp_uint32 __kmp_morph_lock_upgrade;
+extern kmp_uint32 __kmp_morph_lock_downgrade;
+
+extern int __kmp_acquire_morph_lock(kmp_morph_lock_t *lck, kmp_int32 gtid);
+extern int __kmp_test_morph_lock(kmp_morph_lock_t *lck, kmp_int32 gtid);
+extern int __kmp_release_morph_lock(kmp_morph_lock_t *lck, kmp_int32 gtid);
+extern void __kmp_init_morph_lock(kmp_morph_lock_t *lck);
+extern void __kmp_destroy_morph_lock(kmp_morph_lock_t *lck);
+
+#endif // KMP_USE_DYNAMIC_LOCK
+
 // ============================================================================
 // Lock purposes.
 // ============================================================================
@@ -593,6 +771,11 @@ enum kmp_lock_kind {
   lk_ticket,
   lk_queuing,
   lk_drdpa,
+#if KMP_USE_DYNAMIC_LOCK
+  lk_cohort,
+  lk_rw,
+  lk_morph,
+#endif
 #if KMP_USE_ADAPTIVE_LOCKS
   lk_adaptive
 #endif // KMP_USE_ADAPTIVE_LOCKS
@@ -1064,29 +1247,31 @@ extern void __kmp_cleanup_user_locks();
 #if KMP_USE_FUTEX
 #define KMP_FOREACH_D_LOCK(m, a) m(tas, a) m(futex, a) m(hle, a)
 #define KMP_FOREACH_I_LOCK(m, a)                                               \
-  m(ticket, a) m(queuing, a) m(adaptive, a) m(drdpa, a) m(rtm, a)              \
-      m(nested_tas, a) m(nested_futex, a) m(nested_ticket, a)                  \
-          m(nested_queuing, a) m(nested_drdpa, a)
+  m(ticket, a) m(queuing, a) m(adaptive, a) m(drdpa, a) m(cohort, a) m(rw, a)  \
+      m(morph, a) m(rtm, a) m(nested_tas, a) m(nested_futex, a)                \
+          m(nested_ticket, a) m(nested_queuing, a) m(nested_drdpa, a)
 #else
 #define KMP_FOREACH_D_LOCK(m, a) m(tas, a) m(hle, a)
 #define KMP_FOREACH_I_LOCK(m, a)                                               \
-  m(ticket, a) m(queuing, a) m(adaptive, a) m(drdpa, a) m(rtm, a)              \
-      m(nested_tas, a) m(nested_ticket, a) m(nested_queuing, a)                \
-          m(nested_drdpa, a)
+  m(ticket, a) m(queuing, a) m(adaptive, a) m(drdpa, a) m(cohort, a) m(rw, a)  \
+      m(morph, a) m(rtm, a) m(nested_tas, a) m(nested_ticket, a)               \
+          m(nested_queuing, a) m(nested_drdpa, a)
 #endif // KMP_USE_FUTEX
 #define KMP_LAST_D_LOCK lockseq_hle
 #else
 #if KMP_USE_FUTEX
 #define KMP_FOREACH_D_LOCK(m, a) m(tas, a) m(futex, a)
 #define KMP_FOREACH_I_LOCK(m, a)                                               \
-  m(ticket, a) m(queuing, a) m(drdpa, a) m(nested_tas, a) m(nested_futex, a)   \
-      m(nested_ticket, a) m(nested_queuing, a) m(nested_drdpa, a)
+  m(ticket, a) m(queuing, a) m(drdpa, a) m(cohort, a) m(rw, a) m(morph, a)     \
+      m(nested_tas, a) m(nested_futex, a) m(nested_ticket, a)                  \
+          m(nested_queuing, a) m(nested_drdpa, a)
 #define KMP_LAST_D_LOCK lockseq_futex
 #else
 #define KMP_FOREACH_D_LOCK(m, a) m(tas, a)
 #define KMP_FOREACH_I_LOCK(m, a)                                               \
-  m(ticket, a) m(queuing, a) m(drdpa, a) m(nested_tas, a) m(nested_ticket, a)  \
-      m(nested_queuing, a) m(nested_drdpa, a)
+  m(ticket, a) m(queuing, a) m(drdpa, a) m(cohort, a) m(rw, a) m(morph, a)     \
+      m(nested_tas, a) m(nested_ticket, a) m(nested_queuing, a)                \
+          m(nested_drdpa, a)
 #define KMP_LAST_D_LOCK lockseq_tas
 #endif // KMP_USE_FUTEX
 #endif // KMP_USE_TSX
@@ -1201,6 +1386,11 @@ __kmp_allocate_indirect_lock(void **, kmp_int32, kmp_indirect_locktag_t);
 // Cleans up global states and data structures for managing dynamic user locks.
 extern void __kmp_cleanup_indirect_user_locks();
 
+// Shared (reader) acquire and release of a dynamic user lock. Lock kinds other
+// than rw are acquired and released exclusively.
+extern int __kmp_set_lock_shared(kmp_dyna_lock_t *lock, kmp_int32 gtid);
+extern int __kmp_unset_lock_shared(kmp_dyna_lock_t *lock, kmp_int32 gtid);
+
 // Default user lock sequence when not using hinted locks.
 extern kmp_dyna_lockseq_t __kmp_user_lock_seq;
 
@@ -1276,6 +1466,50 @@ extern kmp_int32 __kmp_get_user_lock_owner(kmp_user_lock_p, kmp_uint32);
 
 #endif // KMP_USE_DYNAMIC_LOCK
 
+// Lock contention profiling (KMP_LOCK_PROFILE).
+// Statistics are kept per lock object in a fixed-size table keyed by the lock
+// address (the critical name for critical sections). Counters are updated only
+// by the thread that holds the lock, so plain stores are enough. Destroying a
+// lock folds its counters into the totals of its site and frees its entry.
+#define KMP_LOCK_PROF_TABLE_SIZE 4096 // must be a power of 2
+#define KMP_LOCK_PROF_MAX_PROBES 16 // entries looked at before giving up
+
+enum kmp_lock_prof_kind {
+  kmp_lock_prof_lock,
+  kmp_lock_prof_nest_lock,
+  kmp_lock_prof_critical
+};
+
+typedef struct KMP_ALIGN_CACHE kmp_lock_prof_entry {
+  void *volatile key; // lock address, NULL if the entry is unused
+  char const *psource; // location of the critical construct or lock call
+  void *site; // caller of omp_init_lock, if known
+  kmp_int32 kind; // kmp_lock_prof_kind
+  kmp_int32 depth; // nesting depth of the current owner
+  kmp_uint64 acquires; // outermost acquisitions
+  kmp_uint64 contended; // acquisitions that found the lock busy
+  kmp_uint64 wait_ticks;
+  kmp_uint64 hold_ticks;
+  kmp_uint64 hold_start;
+} kmp_lock_prof_entry_t;
+
+#if KMP_COMPILER_MSVC
+#define KMP_LOCK_PROF_CALLER() _ReturnAddress()
+#else
+#define KMP_LOCK_PROF_CALLER() __builtin_return_address(0)
+#endif
+
+extern void __kmp_init_lock_profile(void);
+extern void __kmp_cleanup_lock_profile(void);
+extern void __kmp_print_lock_profile(void);
+extern kmp_uint64 __kmp_lock_prof_now(void);
+extern void __kmp_lock_prof_init(void *key, kmp_int32 kind, void *site);
+extern void __kmp_lock_prof_destroy(void *key);
+extern void __kmp_lock_prof_acquired(void *key, kmp_int32 gtid,
+                                     kmp_int32 kind, ident_t const *loc,
+                                     kmp_uint64 start, int contended);
+extern void __kmp_lock_prof_released(void *key, kmp_int32 gtid);
+
 // data structure for using backoff within spin locks.
 typedef struct {
   kmp_uint32 step; // current step
@@ -100,8 +100,16 @@ static int __kmp_unregister_root_other_thread(int gtid);
 #endif
 static void __kmp_unregister_library(void); // called by __kmp_internal_end()
 static void __kmp_reap_thread(kmp_info_t *thread, int is_root);
+static void __kmp_create_workers(void);
+static void __kmp_prespawn_workers(void);
 kmp_info_t *__kmp_thread_pool_insert_pt = NULL;
 
+/* Workers set up by __kmp_allocate_thread whose OS threads are not created
+   yet, in allocation order. Protected by __kmp_forkjoin_lock. */
+static kmp_info_t *__kmp_spawn_head = NULL;
+static kmp_info_t *__kmp_spawn_tail = NULL;
+static int __kmp_spawn_count = 0;
+
 /* Calculate the identifier of the current thread */
 /* fast (and somewhat portable) way to get unique identifier of executing
    thread. Returns KMP_GTID_DNE if we haven't been assigned a gtid. */
@@ -242,14 +250,18 @@ int __kmp_get_global_thread_id_reg() {
              ("__kmp_get_global_thread_id_reg: Encountered new root thread. "
               "Registering a new gtid.\n"));
     __kmp_acquire_bootstrap_lock(&__kmp_initz_lock);
+    int prespawn = FALSE;
     if (!__kmp_init_serial) {
       __kmp_do_serial_initialize();
       gtid = __kmp_gtid_get_specific();
+      prespawn = __kmp_prespawn;
     } else {
       gtid = __kmp_register_root(FALSE);
     }
     __kmp_release_bootstrap_lock(&__kmp_initz_lock);
     /*__kmp_printf( "+++ %d\n", gtid ); */ /* GROO */
+    if (prespawn)
+      __kmp_prespawn_workers();
   }
 
   KMP_DEBUG_ASSERT(gtid >= 0);
@@ -985,6 +997,59 @@ static int __kmp_reserve_threads(kmp_root_t *root, kmp_team_t *parent_team,
   return new_nthreads;
 }
 
+#if KMP_NESTED_HOT_TEAMS
+// Number of nesting levels the th_hot_teams arrays have room for.
+static inline int __kmp_hot_teams_depth() {
+  if (__kmp_hot_teams_adaptive && __kmp_hot_teams_max_level > 0 &&
+      __kmp_hot_teams_max_level < KMP_HOT_TEAMS_ADAPTIVE_LEVELS)
+    return KMP_HOT_TEAMS_ADAPTIVE_LEVELS;
+  return __kmp_hot_teams_max_level;
+}
+
+// Reserve nth more workers for adaptive hot teams if they fit in the budget.
+static int __kmp_hot_teams_reserve(int nth) {
+  kmp_int32 budget = __kmp_hot_teams_budget ? __kmp_hot_teams_budget
+                                            : __kmp_xproc;
+  kmp_int32 old = KMP_ATOMIC_LD_RLX(&__kmp_hot_teams_reserved);
+  do {
+    if (old + nth > budget)
+      return FALSE;
+  } while (!__kmp_hot_teams_reserved.compare_exchange_weak(old, old + nth));
+  return TRUE;
+}
+
+// Decide whether the team just forked at adaptive hot level "level" (at or
+// beyond KMP_HOT_TEAMS_MAX_LEVEL) stays the master's hot team for that level.
+// The master must have forked there KMP_HOT_TEAMS_ADAPTIVE times, the enclosing
+// team must be hot itself (so that freeing a hot team frees all hot teams
+// nested in it), and the new workers must fit in KMP_HOT_TEAMS_BUDGET.
+static int __kmp_hot_teams_promote(kmp_info_t *master_th, kmp_team_t *team,
+                                   int level) {
+  kmp_hot_team_ptr_t *hot_teams = master_th->th.th_hot_teams;
+#if OMP_40_ENABLED
+  if (master_th->th.th_teams_microtask)
+    return FALSE;
+#endif
+  if (hot_teams[level].hot_team_forks < __kmp_hot_teams_adaptive)
+    ++hot_teams[level].hot_team_forks;
+  if (hot_teams[level].hot_team_forks < __kmp_hot_teams_adaptive)
+    return FALSE;
+  kmp_team_t *parent_team = team->t.t_parent;
+  kmp_info_t *parent_master = parent_team->t.t_threads[0];
+  if (parent_team->t.t_serialized || !parent_master->th.th_hot_teams ||
+      parent_master->th.th_hot_teams[level - 1].hot_team != parent_team)
+    return FALSE;
+  if (!__kmp_hot_teams_reserve(team->t.t_nproc - 1))
+    return FALSE;
+  KA_TRACE(20, ("__kmp_hot_teams_promote: T#%d keeps team %d of %d threads hot "
+                "at level %d\n",
+                __kmp_gtid_from_thread(master_th), team->t.t_id,
+                team->t.t_nproc, level));
+  hot_teams[level].hot_team_forks = 0;
+  return TRUE;
+}
+#endif // KMP_NESTED_HOT_TEAMS
+
 /* Allocate threads from the thread pool and assign them to the new team. We are
    assured that there are enough threads available, because we checked on that
    earlier within critical section forkjoin */
@@ -1033,6 +1098,18 @@ static void __kmp_fork_team_threads(kmp_root_t *root, kmp_team_t *team,
         hot_teams[level].hot_team = team; // remember new hot team
         hot_teams[level].hot_team_nth = team->t.t_nproc;
       }
+    } else if (level < __kmp_hot_teams_depth()) {
+      // adaptive hot team level
+      if (hot_teams[level].hot_team) {
+        KMP_DEBUG_ASSERT(hot_teams[level].hot_team == team);
+        use_hot_team = 1;
+      } else {
+        use_hot_team = 0;
+        if (__kmp_hot_teams_promote(master_th, team, level)) {
+          hot_teams[level].hot_team = team;
+          hot_teams[level].hot_team_nth = team->t.t_nproc;
+        }
+      }
     } else {
       use_hot_team = 0;
     }
@@ -1078,6 +1155,7 @@ static void __kmp_fork_team_threads(kmp_root_t *root, kmp_team_t *team,
         }
       }
     }
+    __kmp_create_workers();
 
 #if OMP_40_ENABLED && KMP_AFFINITY_SUPPORTED
     __kmp_partition_places(team);
@@ -1491,7 +1569,7 @@ int __kmp_fork_call(ident_t *loc, int gtid,
     p_hot_teams = &master_th->th.th_hot_teams;
     if (*p_hot_teams == NULL && __kmp_hot_teams_max_level > 0) {
       *p_hot_teams = (kmp_hot_team_ptr_t *)__kmp_allocate(
-          sizeof(kmp_hot_team_ptr_t) * __kmp_hot_teams_max_level);
+          sizeof(kmp_hot_team_ptr_t) * __kmp_hot_teams_depth());
       (*p_hot_teams)[0].hot_team = root->r.r_hot_team;
       // it is either actual or not needed (when active_level > 0)
       (*p_hot_teams)[0].hot_team_nth = 1;
@@ -2123,7 +2201,8 @@ int __kmp_fork_call(ident_t *loc, int gtid,
             master_th->th.th_task_state;
         master_th->th.th_task_state_top++;
 #if KMP_NESTED_HOT_TEAMS
-        if (team == master_th->th.th_hot_teams[active_level].hot_team) {
+        if (active_level < __kmp_hot_teams_depth() &&
+            team == master_th->th.th_hot_teams[active_level].hot_team) {
           // Restore master's nested state if nested hot team
           master_th->th.th_task_state =
               master_th->th
@@ -3862,6 +3941,10 @@ static int __kmp_free_hot_teams(kmp_root_t *root, kmp_info_t *thr, int level,
     }
   }
   __kmp_free_team(root, team, NULL);
+  if (level >= __kmp_hot_teams_max_level) // adaptive hot team
+    KMP_ATOMIC_SUB(&__kmp_hot_teams_reserved, nth - 1);
+  hot_teams[level].hot_team = NULL;
+  hot_teams[level].hot_team_nth = 0;
   return n;
 }
 #endif
@@ -3886,8 +3969,8 @@ static int __kmp_reset_root(int gtid, kmp_root_t *root) {
       0) { // need to free nested hot teams and their threads if any
     for (i = 0; i < hot_team->t.t_nproc; ++i) {
       kmp_info_t *th = hot_team->t.t_threads[i];
-      if (__kmp_hot_teams_max_level > 1) {
-        n += __kmp_free_hot_teams(root, th, 1, __kmp_hot_teams_max_level);
+      if (__kmp_hot_teams_depth() > 1) {
+        n += __kmp_free_hot_teams(root, th, 1, __kmp_hot_teams_depth());
       }
       if (th->th.th_hot_teams) {
         __kmp_free(th->th.th_hot_teams);
@@ -4273,8 +4356,12 @@ kmp_info_t *__kmp_allocate_thread(kmp_root_t *root, kmp_team_t *team,
     KMP_DEBUG_ASSERT(new_gtid < __kmp_threads_capacity);
   }
 
-  /* allocate space for it. */
-  new_thr = (kmp_info_t *)__kmp_allocate(sizeof(kmp_info_t));
+  /* allocate space for it. Whole pages, so that the worker can move its
+     descriptor and barrier flags to its own NUMA node once it is bound (see
+     __kmp_localize_thread_state) without moving anybody else's data. */
+  new_thr = (kmp_info_t *)__kmp_page_allocate(
+      (sizeof(kmp_info_t) + KMP_GET_PAGE_SIZE() - 1) &
+      ~(size_t)(KMP_GET_PAGE_SIZE() - 1));
 
   TCW_SYNC_PTR(__kmp_threads[new_gtid], new_thr);
 
@@ -4377,11 +4464,24 @@ kmp_info_t *__kmp_allocate_thread(kmp_root_t *root, kmp_team_t *team,
 #endif /* KMP_ADJUST_BLOCKTIME */
 
   /* actually fork it and create the new worker thread */
-  KF_TRACE(
-      10, ("__kmp_allocate_thread: before __kmp_create_worker: %p\n", new_thr));
-  __kmp_create_worker(new_gtid, new_thr, __kmp_stksize);
-  KF_TRACE(10,
-           ("__kmp_allocate_thread: after __kmp_create_worker: %p\n", new_thr));
+  if (__kmp_spawn_branch > 0) {
+    // Queue it for __kmp_create_workers, which the caller runs once it has
+    // allocated all the threads it needs.
+    new_thr->th.th_info.ds.ds_gtid = new_gtid;
+    new_thr->th.th_spawn_next = NULL;
+    if (__kmp_spawn_tail)
+      __kmp_spawn_tail->th.th_spawn_next = new_thr;
+    else
+      __kmp_spawn_head = new_thr;
+    __kmp_spawn_tail = new_thr;
+    __kmp_spawn_count++;
+  } else {
+    KF_TRACE(10, ("__kmp_allocate_thread: before __kmp_create_worker: %p\n",
+                  new_thr));
+    __kmp_create_worker(new_gtid, new_thr, __kmp_stksize);
+    KF_TRACE(10, ("__kmp_allocate_thread: after __kmp_create_worker: %p\n",
+                  new_thr));
+  }
 
   KA_TRACE(20, ("__kmp_allocate_thread: T#%d forked T#%d\n", __kmp_get_gtid(),
                 new_gtid));
@@ -4389,6 +4489,101 @@ kmp_info_t *__kmp_allocate_thread(kmp_root_t *root, kmp_team_t *team,
   return new_thr;
 }
 
+// Create the OS threads of the workers in the list linked by th_spawn_next.
+static void __kmp_create_worker_list(kmp_info_t *thr) {
+  while (thr) {
+    kmp_info_t *next = thr->th.th_spawn_next;
+    thr->th.th_spawn_next = NULL;
+    KF_TRACE(10, ("__kmp_create_worker_list: T#%d creates T#%d\n",
+                  __kmp_get_gtid(), thr->th.th_info.ds.ds_gtid));
+    __kmp_create_worker(thr->th.th_info.ds.ds_gtid, thr, __kmp_stksize);
+    KMP_MB();
+    TCW_4(thr->th.th_spawn_pending, 0);
+    thr = next;
+  }
+}
+
+/* Create the workers queued by __kmp_allocate_thread. Thread creation is slow
+   and does not depend on the creating thread, so with KMP_SPAWN_BRANCH=k the
+   caller creates only k of the n new workers and every new worker creates up
+   to k others as soon as it starts (__kmp_spawn_children). All of them exist
+   after about log_k(n) rounds of creation instead of n.
+   Caller must hold __kmp_forkjoin_lock. */
+static void __kmp_create_workers(void) {
+  int n = __kmp_spawn_count;
+  int k = __kmp_spawn_branch;
+  int i;
+  kmp_info_t *thr;
+
+  if (n == 0)
+    return;
+  kmp_info_t **thrs = (kmp_info_t **)KMP_ALLOCA(n * sizeof(kmp_info_t *));
+  for (i = 0, thr = __kmp_spawn_head; i < n; ++i, thr = thr->th.th_spawn_next)
+    thrs[i] = thr;
+  __kmp_spawn_head = __kmp_spawn_tail = NULL;
+  __kmp_spawn_count = 0;
+
+  // Numbering the caller 0 and the new workers from 1, worker i creates
+  // workers i * k + 1 .. i * k + k.
+  for (i = 1; i <= n; ++i) {
+    thr = thrs[i - 1];
+    thr->th.th_spawn_child = i * k < n ? thrs[i * k] : NULL;
+    thr->th.th_spawn_next = i % k && i < n ? thrs[i] : NULL;
+    TCW_4(thr->th.th_spawn_pending, 1);
+  }
+  KA_TRACE(20, ("__kmp_create_workers: T#%d creates %d workers, %d at a time\n",
+                __kmp_get_gtid(), n, k));
+  KMP_MB();
+  __kmp_create_worker_list(thrs[0]);
+}
+
+// Called by a new worker before anything else.
+void __kmp_spawn_children(kmp_info_t *th) {
+  kmp_info_t *child = th->th.th_spawn_child;
+  if (child) {
+    th->th.th_spawn_child = NULL;
+    __kmp_create_worker_list(child);
+  }
+}
+
+/* KMP_PRESPAWN: right after serial initialization create the workers of the
+   default team and put them in the thread pool, where the first parallel
+   region finds them instead of creating them. */
+static void __kmp_prespawn_workers(void) {
+  int gtid, i, n;
+  kmp_info_t *master;
+  kmp_root_t *root;
+  kmp_team_t *hot_team;
+
+  __kmp_parallel_initialize();
+  gtid = __kmp_get_gtid();
+  master = __kmp_threads[gtid];
+  root = master->th.th_root;
+  hot_team = root->r.r_hot_team;
+
+  __kmp_acquire_bootstrap_lock(&__kmp_forkjoin_lock);
+  n = __kmp_dflt_team_nth - 1 - __kmp_thread_pool_nth;
+  if (n > __kmp_max_nth - __kmp_nth)
+    n = __kmp_max_nth - __kmp_nth;
+  if (n > __kmp_threads_capacity - __kmp_all_nth - 1)
+    n = __kmp_threads_capacity - __kmp_all_nth - 1;
+  if (root->r.r_active || hot_team->t.t_nproc > 1 ||
+      n >= hot_team->t.t_max_nproc)
+    n = 0;
+  KA_TRACE(10, ("__kmp_prespawn_workers: T#%d prespawns %d workers\n", gtid,
+                n > 0 ? n : 0));
+  if (n > 0) {
+    kmp_info_t **thrs = (kmp_info_t **)KMP_ALLOCA(n * sizeof(kmp_info_t *));
+    // Set the workers up as members of the idle hot team, then retire them.
+    for (i = 0; i < n; ++i)
+      thrs[i] = __kmp_allocate_thread(root, hot_team, i + 1);
+    for (i = 0; i < n; ++i)
+      __kmp_free_thread(thrs[i]);
+    __kmp_create_workers();
+  }
+  __kmp_release_bootstrap_lock(&__kmp_forkjoin_lock);
+}
+
 /* Reinitialize team for reuse.
    The hot team code calls this case at every fork barrier, so EPCC barrier
    test are extremely sensitive to changes in it, esp. writes to the team
@@ -4449,6 +4644,8 @@ static void __kmp_initialize_team(kmp_team_t *team, int new_nproc,
 #endif /* KMP_ARCH_X86 || KMP_ARCH_X86_64 */
 
   team->t.t_construct = 0;
+  team->t.t_split_arrived = 0;
+  team->t.t_split_tasks = FALSE;
 
   team->t.t_ordered.dt.t_value = 0;
   team->t.t_master_active = FALSE;
@@ -4857,10 +5054,25 @@ __kmp_allocate_team(kmp_root_t *root, int new_nproc, int max_nproc,
       }
     }
     hot_teams = master->th.th_hot_teams;
-    if (level < __kmp_hot_teams_max_level && hot_teams &&
+    if (level < __kmp_hot_teams_depth() && hot_teams &&
         hot_teams[level]
             .hot_team) { // hot team has already been allocated for given level
       use_hot_team = 1;
+      if (level >= __kmp_hot_teams_max_level &&
+          new_nproc > hot_teams[level].hot_team_nth &&
+          !__kmp_hot_teams_reserve(new_nproc - hot_teams[level].hot_team_nth)) {
+        // An adaptive hot team cannot grow beyond the budget: give it up along
+        // with the hot teams nested in it and allocate a regular team.
+        KA_TRACE(20, ("__kmp_allocate_team: T#%d drops hot team %d at level "
+                      "%d\n",
+                      __kmp_gtid_from_thread(master),
+                      hot_teams[level].hot_team->t.t_id, level));
+        // The master still runs in its current team, keep its task team.
+        kmp_task_team_t *task_team = master->th.th_task_team;
+        __kmp_free_hot_teams(root, master, level, __kmp_hot_teams_depth());
+        master->th.th_task_team = task_team;
+        use_hot_team = 0;
+      }
     } else {
       use_hot_team = 0;
     }
@@ -4939,6 +5151,9 @@ __kmp_allocate_team(kmp_root_t *root, int new_nproc, int max_nproc,
         // mode, can be bigger in mode 1, when hot team has threads in reserve
         KMP_DEBUG_ASSERT(hot_teams[level].hot_team_nth == team->t.t_nproc);
         hot_teams[level].hot_team_nth = new_nproc;
+        if (level >= __kmp_hot_teams_max_level) // adaptive hot team
+          KMP_ATOMIC_SUB(&__kmp_hot_teams_reserved,
+                         team->t.t_nproc - new_nproc);
 #endif // KMP_NESTED_HOT_TEAMS
         /* release the extra threads we don't need any more */
         for (f = new_nproc; f < team->t.t_nproc; f++) {
@@ -5083,6 +5298,7 @@ __kmp_allocate_team(kmp_root_t *root, int new_nproc, int max_nproc,
             }
           }
         }
+        __kmp_create_workers();
 
 #if KMP_OS_LINUX && KMP_AFFINITY_SUPPORTED
         if (KMP_AFFINITY_CAPABLE()) {
@@ -5351,6 +5567,9 @@ void __kmp_free_team(kmp_root_t *root,
     if (level < __kmp_hot_teams_max_level) {
       KMP_DEBUG_ASSERT(team == hot_teams[level].hot_team);
       use_hot_team = 1;
+    } else if (level < __kmp_hot_teams_depth() &&
+               team == hot_teams[level].hot_team) { // adaptive hot team
+      use_hot_team = 1;
     }
   }
 #endif // KMP_NESTED_HOT_TEAMS
@@ -5443,6 +5662,7 @@ kmp_team_t *__kmp_reap_team(kmp_team_t *team) {
   /* TODO clean the threads that are a part of this? */
 
   /* free stuff */
+  __kmp_barrier_tune_free(team);
   __kmp_free_team_arrays(team);
   if (team->t.t_argv != &team->t.t_inline_argv[0])
     __kmp_free((void *)team->t.t_argv);
@@ -5769,6 +5989,9 @@ static void __kmp_reap_thread(kmp_info_t *thread, int is_root) {
   gtid = thread->th.th_info.ds.ds_gtid;
 
   if (!is_root) {
+    // Its creation may still be up to another new worker; wait for that
+    // worker to create this one only.
+    KMP_WAIT_YIELD(&thread->th.th_spawn_pending, 0, KMP_EQ, NULL);
 
     if (__kmp_dflt_blocktime != KMP_MAX_BLOCKTIME) {
       /* Assume the threads are at the fork barrier here */
@@ -5808,6 +6031,10 @@ static void __kmp_reap_thread(kmp_info_t *thread, int is_root) {
 
   __kmp_free_implicit_task(thread);
 
+#if OMP_40_ENABLED
+  __kmp_reap_dep_pools(thread);
+#endif
+
 // Free the fast memory for tasking
 #if USE_FAST_MEMORY
   __kmp_free_fast_memory(thread);
@@ -6430,18 +6657,8 @@ static void __kmp_do_serial_initialize(void) {
   __kmp_init_queuing_lock(&__kmp_dispatch_lock);
   __kmp_init_lock(&__kmp_debug_lock);
   __kmp_init_atomic_lock(&__kmp_atomic_lock);
-  __kmp_init_atomic_lock(&__kmp_atomic_lock_1i);
-  __kmp_init_atomic_lock(&__kmp_atomic_lock_2i);
-  __kmp_init_atomic_lock(&__kmp_atomic_lock_4i);
-  __kmp_init_atomic_lock(&__kmp_atomic_lock_4r);
-  __kmp_init_atomic_lock(&__kmp_atomic_lock_8i);
-  __kmp_init_atomic_lock(&__kmp_atomic_lock_8r);
-  __kmp_init_atomic_lock(&__kmp_atomic_lock_8c);
-  __kmp_init_atomic_lock(&__kmp_atomic_lock_10r);
-  __kmp_init_atomic_lock(&__kmp_atomic_lock_16r);
-  __kmp_init_atomic_lock(&__kmp_atomic_lock_16c);
-  __kmp_init_atomic_lock(&__kmp_atomic_lock_20c);
-  __kmp_init_atomic_lock(&__kmp_atomic_lock_32c);
+  for (i = 0; i < KMP_ATOMIC_LOCK_TABLE_SIZE; ++i)
+    __kmp_init_atomic_lock(&__kmp_atomic_lock_table[i]);
   __kmp_init_bootstrap_lock(&__kmp_forkjoin_lock);
   __kmp_init_bootstrap_lock(&__kmp_exit_lock);
 #if KMP_USE_MONITOR
@@ -6570,6 +6787,8 @@ static void __kmp_do_serial_initialize(void) {
   __kmp_env_free(&val);
 #endif
 
+  __kmp_init_lock_profile();
+
   __kmp_threads_capacity =
       __kmp_initial_threads_capacity(__kmp_dflt_team_nth_ub);
   // Moved here from __kmp_env_initialize() "KMP_ALL_THREADPRIVATE" part
@@ -6679,6 +6898,8 @@ void __kmp_serial_initialize(void) {
   }
   __kmp_do_serial_initialize();
   __kmp_release_bootstrap_lock(&__kmp_initz_lock);
+  if (__kmp_prespawn)
+    __kmp_prespawn_workers();
 }
 
 static void __kmp_do_middle_initialize(void) {
@@ -7336,6 +7557,13 @@ void __kmp_cleanup(void) {
     TCW_4(__kmp_init_middle, FALSE);
   }
 
+  __kmp_cleanup_barrier_tuning();
+
+#if OMP_40_ENABLED
+  __kmp_cleanup_dep_pools();
+  __kmp_cleanup_tdgs();
+#endif
+
   KA_TRACE(10, ("__kmp_cleanup: go serial cleanup\n"));
 
   if (__kmp_init_serial) {
@@ -7374,6 +7602,7 @@ void __kmp_cleanup(void) {
   __kmp_print_speculative_stats();
 #endif
 #endif
+  __kmp_cleanup_lock_profile();
   KMP_INTERNAL_FREE(__kmp_nested_nth.nth);
   __kmp_nested_nth.nth = NULL;
   __kmp_nested_nth.size = 0;
@@ -668,6 +668,27 @@ static void __kmp_stg_print_blocktime(kmp_str_buf_t *buffer, char const *name,
   __kmp_stg_print_int(buffer, name, __kmp_dflt_blocktime);
 } // __kmp_stg_print_blocktime
 
+// -----------------------------------------------------------------------------
+// KMP_FUTEX_SLEEP
+
+static void __kmp_stg_parse_futex_sleep(char const *name, char const *value,
+                                        void *data) {
+  __kmp_stg_parse_bool(name, value, &__kmp_futex_sleep);
+#if KMP_USE_FUTEX
+  if (__kmp_futex_sleep && !__kmp_futex_determine_capable()) {
+#else
+  if (__kmp_futex_sleep) {
+#endif
+    KMP_WARNING(FutexNotSupported, name, value);
+    __kmp_futex_sleep = FALSE;
+  }
+} // __kmp_stg_parse_futex_sleep
+
+static void __kmp_stg_print_futex_sleep(kmp_str_buf_t *buffer,
+                                        char const *name, void *data) {
+  __kmp_stg_print_bool(buffer, name, __kmp_futex_sleep);
+} // __kmp_stg_print_futex_sleep
+
 // -----------------------------------------------------------------------------
 // KMP_DUPLICATE_LIB_OK
 
@@ -850,6 +871,29 @@ static void __kmp_stg_print_stackpad(kmp_str_buf_t *buffer, char const *name,
   __kmp_stg_print_int(buffer, name, __kmp_stkpadding);
 } // __kmp_stg_print_stackpad
 
+// -----------------------------------------------------------------------------
+// KMP_SPAWN_BRANCH, KMP_PRESPAWN
+
+static void __kmp_stg_parse_spawn_branch(char const *name, char const *value,
+                                         void *data) {
+  __kmp_stg_parse_int(name, value, 0, 1024, &__kmp_spawn_branch);
+} // __kmp_stg_parse_spawn_branch
+
+static void __kmp_stg_print_spawn_branch(kmp_str_buf_t *buffer,
+                                         char const *name, void *data) {
+  __kmp_stg_print_int(buffer, name, __kmp_spawn_branch);
+} // __kmp_stg_print_spawn_branch
+
+static void __kmp_stg_parse_prespawn(char const *name, char const *value,
+                                     void *data) {
+  __kmp_stg_parse_bool(name, value, &__kmp_prespawn);
+} // __kmp_stg_parse_prespawn
+
+static void __kmp_stg_print_prespawn(kmp_str_buf_t *buffer, char const *name,
+                                     void *data) {
+  __kmp_stg_print_bool(buffer, name, __kmp_prespawn);
+} // __kmp_stg_print_prespawn
+
 // -----------------------------------------------------------------------------
 // KMP_STACKOFFSET
 
@@ -1156,6 +1200,55 @@ static void __kmp_stg_print_task_stealing(kmp_str_buf_t *buffer,
   __kmp_stg_print_int(buffer, name, __kmp_task_stealing_constraint);
 } // __kmp_stg_print_task_stealing
 
+static void __kmp_stg_parse_task_deque_lockfree(char const *name,
+                                               char const *value, void *data) {
+  __kmp_stg_parse_bool(name, value, &__kmp_task_deque_lockfree);
+} // __kmp_stg_parse_task_deque_lockfree
+
+static void __kmp_stg_print_task_deque_lockfree(kmp_str_buf_t *buffer,
+                                               char const *name, void *data) {
+  __kmp_stg_print_bool(buffer, name, __kmp_task_deque_lockfree);
+} // __kmp_stg_print_task_deque_lockfree
+
+static void __kmp_stg_parse_task_steal_policy(char const *name,
+                                              char const *value, void *data) {
+  if (!__kmp_strcasecmp_with_sentinel("random", value, 0)) {
+    __kmp_task_steal_policy = steal_random;
+  } else if (!__kmp_strcasecmp_with_sentinel("hierarchical", value, 0)) {
+    __kmp_task_steal_policy = steal_hierarchical;
+  } else {
+    KMP_WARNING(StgInvalidValue, name, value);
+  }
+} // __kmp_stg_parse_task_steal_policy
+
+static void __kmp_stg_print_task_steal_policy(kmp_str_buf_t *buffer,
+                                              char const *name, void *data) {
+  __kmp_stg_print_str(buffer, name,
+                      __kmp_task_steal_policy == steal_hierarchical
+                          ? "hierarchical"
+                          : "random");
+} // __kmp_stg_print_task_steal_policy
+
+static void __kmp_stg_parse_task_continuation(char const *name,
+                                              char const *value, void *data) {
+  __kmp_stg_parse_bool(name, value, &__kmp_task_continuation);
+} // __kmp_stg_parse_task_continuation
+
+static void __kmp_stg_print_task_continuation(kmp_str_buf_t *buffer,
+                                              char const *name, void *data) {
+  __kmp_stg_print_bool(buffer, name, __kmp_task_continuation);
+} // __kmp_stg_print_task_continuation
+
+static void __kmp_stg_parse_task_range_deps(char const *name,
+                                            char const *value, void *data) {
+  __kmp_stg_parse_bool(name, value, &__kmp_task_range_deps);
+} // __kmp_stg_parse_task_range_deps
+
+static void __kmp_stg_print_task_range_deps(kmp_str_buf_t *buffer,
+                                            char const *name, void *data) {
+  __kmp_stg_print_bool(buffer, name, __kmp_task_range_deps);
+} // __kmp_stg_print_task_range_deps
+
 static void __kmp_stg_parse_max_active_levels(char const *name,
                                               char const *value, void *data) {
   __kmp_stg_parse_int(name, value, 0, KMP_MAX_ACTIVE_LEVELS_LIMIT,
@@ -1269,7 +1362,8 @@ static void __kmp_stg_print_disp_buffers(kmp_str_buf_t *buffer,
 
 #if KMP_NESTED_HOT_TEAMS
 // -----------------------------------------------------------------------------
-// KMP_HOT_TEAMS_MAX_LEVEL, KMP_HOT_TEAMS_MODE
+// KMP_HOT_TEAMS_MAX_LEVEL, KMP_HOT_TEAMS_MODE, KMP_HOT_TEAMS_ADAPTIVE,
+// KMP_HOT_TEAMS_BUDGET
 
 static void __kmp_stg_parse_hot_teams_level(char const *name, char const *value,
                                             void *data) {
@@ -1301,6 +1395,35 @@ static void __kmp_stg_print_hot_teams_mode(kmp_str_buf_t *buffer,
   __kmp_stg_print_int(buffer, name, __kmp_hot_teams_mode);
 } // __kmp_stg_print_hot_teams_mode
 
+static void __kmp_stg_parse_hot_teams_adaptive(char const *name,
+                                               char const *value, void *data) {
+  if (TCR_4(__kmp_init_parallel)) {
+    KMP_WARNING(EnvParallelWarn, name);
+    return;
+  } // read value before first parallel only
+  __kmp_stg_parse_int(name, value, 0, KMP_MAX_HOT_TEAMS_ADAPTIVE_FORKS,
+                      &__kmp_hot_teams_adaptive);
+} // __kmp_stg_parse_hot_teams_adaptive
+
+static void __kmp_stg_print_hot_teams_adaptive(kmp_str_buf_t *buffer,
+                                               char const *name, void *data) {
+  __kmp_stg_print_int(buffer, name, __kmp_hot_teams_adaptive);
+} // __kmp_stg_print_hot_teams_adaptive
+
+static void __kmp_stg_parse_hot_teams_budget(char const *name,
+                                             char const *value, void *data) {
+  if (TCR_4(__kmp_init_parallel)) {
+    KMP_WARNING(EnvParallelWarn, name);
+    return;
+  } // read value before first parallel only
+  __kmp_stg_parse_int(name, value, 0, KMP_MAX_NTH, &__kmp_hot_teams_budget);
+} // __kmp_stg_parse_hot_teams_budget
+
+static void __kmp_stg_print_hot_teams_budget(kmp_str_buf_t *buffer,
+                                             char const *name, void *data) {
+  __kmp_stg_print_int(buffer, name, __kmp_hot_teams_budget);
+} // __kmp_stg_print_hot_teams_budget
+
 #endif // KMP_NESTED_HOT_TEAMS
 
 // -----------------------------------------------------------------------------
@@ -1588,6 +1711,19 @@ static void __kmp_stg_print_barrier_pattern(kmp_str_buf_t *buffer,
   }
 } // __kmp_stg_print_barrier_pattern
 
+// -----------------------------------------------------------------------------
+// KMP_BARRIER_TUNING
+
+static void __kmp_stg_parse_barrier_tuning(char const *name, char const *value,
+                                           void *data) {
+  __kmp_stg_parse_int(name, value, 0, 10000, &__kmp_barrier_tuning);
+} // __kmp_stg_parse_barrier_tuning
+
+static void __kmp_stg_print_barrier_tuning(kmp_str_buf_t *buffer,
+                                           char const *name, void *data) {
+  __kmp_stg_print_int(buffer, name, __kmp_barrier_tuning);
+} // __kmp_stg_print_barrier_tuning
+
 // -----------------------------------------------------------------------------
 // KMP_ABORT_DELAY
 
@@ -3057,6 +3193,19 @@ static void __kmp_stg_print_topology_method(kmp_str_buf_t *buffer,
   }
 } // __kmp_stg_print_topology_method
 
+// -----------------------------------------------------------------------------
+// KMP_NUMA_LOCAL_STATE
+
+static void __kmp_stg_parse_numa_local_state(char const *name,
+                                             char const *value, void *data) {
+  __kmp_stg_parse_bool(name, value, &__kmp_numa_local_state);
+} // __kmp_stg_parse_numa_local_state
+
+static void __kmp_stg_print_numa_local_state(kmp_str_buf_t *buffer,
+                                             char const *name, void *data) {
+  __kmp_stg_print_bool(buffer, name, __kmp_numa_local_state);
+} // __kmp_stg_print_numa_local_state
+
 #endif /* KMP_AFFINITY_SUPPORTED */
 
 #if OMP_40_ENABLED
@@ -3951,6 +4100,23 @@ static void __kmp_stg_parse_lock_kind(char const *name, char const *value,
     __kmp_user_lock_kind = lk_drdpa;
     KMP_STORE_LOCK_SEQ(drdpa);
   }
+#if KMP_USE_DYNAMIC_LOCK
+  else if (__kmp_str_match("cohort", 1, value)) {
+    __kmp_user_lock_kind = lk_cohort;
+    KMP_STORE_LOCK_SEQ(cohort);
+  }
+  else if (__kmp_str_match("rw", 2, value) ||
+           __kmp_str_match("reader writer", 2, value) ||
+           __kmp_str_match("reader_writer", 2, value) ||
+           __kmp_str_match("reader-writer", 2, value)) {
+    __kmp_user_lock_kind = lk_rw;
+    KMP_STORE_LOCK_SEQ(rw);
+  }
+  else if (__kmp_str_match("morph", 1, value)) {
+    __kmp_user_lock_kind = lk_morph;
+    KMP_STORE_LOCK_SEQ(morph);
+  }
+#endif
 #if KMP_USE_ADAPTIVE_LOCKS
   else if (__kmp_str_match("adaptive", 1, value)) {
     if (__kmp_cpuinfo.rtm) { // ??? Is cpuinfo available here?
@@ -4023,6 +4189,19 @@ static void __kmp_stg_print_lock_kind(kmp_str_buf_t *buffer, char const *name,
   case lk_drdpa:
     value = "drdpa";
     break;
+#if KMP_USE_DYNAMIC_LOCK
+  case lk_cohort:
+    value = "cohort";
+    break;
+
+  case lk_rw:
+    value = "rw";
+    break;
+
+  case lk_morph:
+    value = "morph";
+    break;
+#endif
 #if KMP_USE_ADAPTIVE_LOCKS
   case lk_adaptive:
     value = "adaptive";
@@ -4131,6 +4310,54 @@ static void __kmp_stg_print_spin_backoff_params(kmp_str_buf_t *buffer,
                       __kmp_spin_backoff_params.min_tick);
 }
 
+#if KMP_USE_DYNAMIC_LOCK
+
+// -----------------------------------------------------------------------------
+// KMP_COHORT_LOCK_BATCH
+
+static void __kmp_stg_parse_cohort_lock_batch(char const *name,
+                                              char const *value, void *data) {
+  int batch = __kmp_cohort_lock_batch;
+  __kmp_stg_parse_int(name, value, 0, KMP_INT_MAX, &batch);
+  __kmp_cohort_lock_batch = batch;
+} // __kmp_stg_parse_cohort_lock_batch
+
+static void __kmp_stg_print_cohort_lock_batch(kmp_str_buf_t *buffer,
+                                              char const *name, void *data) {
+  __kmp_stg_print_int(buffer, name, __kmp_cohort_lock_batch);
+} // __kmp_stg_print_cohort_lock_batch
+
+// -----------------------------------------------------------------------------
+// KMP_MORPH_LOCK_UPGRADE, KMP_MORPH_LOCK_DOWNGRADE
+
+static void __kmp_stg_parse_morph_lock_upgrade(char const *name,
+                                               char const *value, void *data) {
+  int upgrade = __kmp_morph_lock_upgrade;
+  __kmp_stg_parse_int(name, value, 0, KMP_INT_MAX, &upgrade);
+  __kmp_morph_lock_upgrade = upgrade;
+} // __kmp_stg_parse_morph_lock_upgrade
+
+static void __kmp_stg_print_morph_lock_upgrade(kmp_str_buf_t *buffer,
+                                               char const *name, void *data) {
+  __kmp_stg_print_int(buffer, name, __kmp_morph_lock_upgrade);
+} // __kmp_stg_print_morph_lock_upgrade
+
+static void __kmp_stg_parse_morph_lock_downgrade(char const *name,
+                                                 char const *value,
+                                                 void *data) {
+  int downgrade = __kmp_morph_lock_downgrade;
+  __kmp_stg_parse_int(name, value, 0, KMP_INT_MAX, &downgrade);
+  __kmp_morph_lock_downgrade = downgrade;
+} // __kmp_stg_parse_morph_lock_downgrade
+
+static void __kmp_stg_print_morph_lock_downgrade(kmp_str_buf_t *buffer,
+                                                 char const *name,
+                                                 void *data) {
+  __kmp_stg_print_int(buffer, name, __kmp_morph_lock_downgrade);
+} // __kmp_stg_print_morph_lock_downgrade
+
+#endif // KMP_USE_DYNAMIC_LOCK
+
 #if KMP_USE_ADAPTIVE_LOCKS
 
 // -----------------------------------------------------------------------------
@@ -4254,6 +4481,33 @@ static void __kmp_stg_print_speculative_statsfile(kmp_str_buf_t *buffer,
 
 #endif // KMP_USE_ADAPTIVE_LOCKS
 
+// -----------------------------------------------------------------------------
+// KMP_LOCK_PROFILE, KMP_LOCK_PROFILE_FILE
+
+static void __kmp_stg_parse_lock_profile(char const *name, char const *value,
+                                         void *data) {
+  __kmp_stg_parse_bool(name, value, &__kmp_lock_profile);
+} // __kmp_stg_parse_lock_profile
+
+static void __kmp_stg_print_lock_profile(kmp_str_buf_t *buffer,
+                                         char const *name, void *data) {
+  __kmp_stg_print_bool(buffer, name, __kmp_lock_profile);
+} // __kmp_stg_print_lock_profile
+
+static void __kmp_stg_parse_lock_profile_file(char const *name,
+                                              char const *value, void *data) {
+  __kmp_stg_parse_str(name, value, &__kmp_lock_profile_file);
+} // __kmp_stg_parse_lock_profile_file
+
+static void __kmp_stg_print_lock_profile_file(kmp_str_buf_t *buffer,
+                                              char const *name, void *data) {
+  if (__kmp_lock_profile_file == NULL) {
+    __kmp_stg_print_str(buffer, name, "stderr");
+  } else {
+    __kmp_stg_print_str(buffer, name, __kmp_lock_profile_file);
+  }
+} // __kmp_stg_print_lock_profile_file
+
 // -----------------------------------------------------------------------------
 // KMP_HW_SUBSET (was KMP_PLACE_THREADS)
 
@@ -4541,6 +4795,8 @@ static kmp_setting_t __kmp_stg_table[] = {
     {"KMP_ALL_THREADS", __kmp_stg_parse_device_thread_limit, NULL, NULL, 0, 0},
     {"KMP_BLOCKTIME", __kmp_stg_parse_blocktime, __kmp_stg_print_blocktime,
      NULL, 0, 0},
+    {"KMP_FUTEX_SLEEP", __kmp_stg_parse_futex_sleep,
+     __kmp_stg_print_futex_sleep, NULL, 0, 0},
     {"KMP_DUPLICATE_LIB_OK", __kmp_stg_parse_duplicate_lib_ok,
      __kmp_stg_print_duplicate_lib_ok, NULL, 0, 0},
     {"KMP_LIBRARY", __kmp_stg_parse_wait_policy, __kmp_stg_print_wait_policy,
@@ -4559,6 +4815,10 @@ static kmp_setting_t __kmp_stg_table[] = {
      NULL, 0, 0},
     {"KMP_STACKPAD", __kmp_stg_parse_stackpad, __kmp_stg_print_stackpad, NULL,
      0, 0},
+    {"KMP_SPAWN_BRANCH", __kmp_stg_parse_spawn_branch,
+     __kmp_stg_print_spawn_branch, NULL, 0, 0},
+    {"KMP_PRESPAWN", __kmp_stg_parse_prespawn, __kmp_stg_print_prespawn, NULL,
+     0, 0},
     {"KMP_VERSION", __kmp_stg_parse_version, __kmp_stg_print_version, NULL, 0,
      0},
     {"KMP_WARNINGS", __kmp_stg_parse_warnings, __kmp_stg_print_warnings, NULL,
@@ -4574,6 +4834,14 @@ static kmp_setting_t __kmp_stg_table[] = {
      0},
     {"KMP_TASK_STEALING_CONSTRAINT", __kmp_stg_parse_task_stealing,
      __kmp_stg_print_task_stealing, NULL, 0, 0},
+    {"KMP_TASK_DEQUE_LOCKFREE", __kmp_stg_parse_task_deque_lockfree,
+     __kmp_stg_print_task_deque_lockfree, NULL, 0, 0},
+    {"KMP_TASK_STEAL_POLICY", __kmp_stg_parse_task_steal_policy,
+     __kmp_stg_print_task_steal_policy, NULL, 0, 0},
+    {"KMP_TASK_CONTINUATION", __kmp_stg_parse_task_continuation,
+     __kmp_stg_print_task_continuation, NULL, 0, 0},
+    {"KMP_TASK_RANGE_DEPS", __kmp_stg_parse_task_range_deps,
+     __kmp_stg_print_task_range_deps, NULL, 0, 0},
     {"OMP_MAX_ACTIVE_LEVELS", __kmp_stg_parse_max_active_levels,
      __kmp_stg_print_max_active_levels, NULL, 0, 0},
 #if OMP_40_ENABLED
@@ -4603,6 +4871,10 @@ static kmp_setting_t __kmp_stg_table[] = {
      __kmp_stg_print_hot_teams_level, NULL, 0, 0},
     {"KMP_HOT_TEAMS_MODE", __kmp_stg_parse_hot_teams_mode,
      __kmp_stg_print_hot_teams_mode, NULL, 0, 0},
+    {"KMP_HOT_TEAMS_ADAPTIVE", __kmp_stg_parse_hot_teams_adaptive,
+     __kmp_stg_print_hot_teams_adaptive, NULL, 0, 0},
+    {"KMP_HOT_TEAMS_BUDGET", __kmp_stg_parse_hot_teams_budget,
+     __kmp_stg_print_hot_teams_budget, NULL, 0, 0},
 #endif // KMP_NESTED_HOT_TEAMS
 
 #if KMP_HANDLE_SIGNALS
@@ -4670,6 +4942,8 @@ static kmp_setting_t __kmp_stg_table[] = {
     {"KMP_REDUCTION_BARRIER_PATTERN", __kmp_stg_parse_barrier_pattern,
      __kmp_stg_print_barrier_pattern, NULL, 0, 0},
 #endif
+    {"KMP_BARRIER_TUNING", __kmp_stg_parse_barrier_tuning,
+     __kmp_stg_print_barrier_tuning, NULL, 0, 0},
 
     {"KMP_ABORT_DELAY", __kmp_stg_parse_abort_delay,
      __kmp_stg_print_abort_delay, NULL, 0, 0},
@@ -4705,6 +4979,8 @@ static kmp_setting_t __kmp_stg_table[] = {
 
     {"KMP_TOPOLOGY_METHOD", __kmp_stg_parse_topology_method,
      __kmp_stg_print_topology_method, NULL, 0, 0},
+    {"KMP_NUMA_LOCAL_STATE", __kmp_stg_parse_numa_local_state,
+     __kmp_stg_print_numa_local_state, NULL, 0, 0},
 
 #else
 
@@ -4760,6 +5036,14 @@ static kmp_setting_t __kmp_stg_table[] = {
      NULL, 0, 0},
     {"KMP_SPIN_BACKOFF_PARAMS", __kmp_stg_parse_spin_backoff_params,
      __kmp_stg_print_spin_backoff_params, NULL, 0, 0},
+#if KMP_USE_DYNAMIC_LOCK
+    {"KMP_COHORT_LOCK_BATCH", __kmp_stg_parse_cohort_lock_batch,
+     __kmp_stg_print_cohort_lock_batch, NULL, 0, 0},
+    {"KMP_MORPH_LOCK_UPGRADE", __kmp_stg_parse_morph_lock_upgrade,
+     __kmp_stg_print_morph_lock_upgrade, NULL, 0, 0},
+    {"KMP_MORPH_LOCK_DOWNGRADE", __kmp_stg_parse_morph_lock_downgrade,
+     __kmp_stg_print_morph_lock_downgrade, NULL, 0, 0},
+#endif
 #if KMP_USE_ADAPTIVE_LOCKS
     {"KMP_ADAPTIVE_LOCK_PROPS", __kmp_stg_parse_adaptive_lock_props,
      __kmp_stg_print_adaptive_lock_props, NULL, 0, 0},
@@ -4768,6 +5052,10 @@ static kmp_setting_t __kmp_stg_table[] = {
      __kmp_stg_print_speculative_statsfile, NULL, 0, 0},
 #endif
 #endif // KMP_USE_ADAPTIVE_LOCKS
+    {"KMP_LOCK_PROFILE", __kmp_stg_parse_lock_profile,
+     __kmp_stg_print_lock_profile, NULL, 0, 0},
+    {"KMP_LOCK_PROFILE_FILE", __kmp_stg_parse_lock_profile_file,
+     __kmp_stg_print_lock_profile_file, NULL, 0, 0},
     {"KMP_PLACE_THREADS", __kmp_stg_parse_hw_subset, __kmp_stg_print_hw_subset,
      NULL, 0, 0},
     {"KMP_HW_SUBSET", __kmp_stg_parse_hw_subset, __kmp_stg_print_hw_subset,
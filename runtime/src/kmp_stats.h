@@ -96,6 +96,7 @@ enum stats_state_e {
   macro(OMP_FOR_dynamic, 0, arg)                                               \
   macro(OMP_DISTRIBUTE, 0, arg)                                                \
   macro(OMP_BARRIER, 0, arg)                                                   \
+  macro(OMP_SPLIT_BARRIER, 0, arg)                                             \
   macro(OMP_CRITICAL, 0, arg)                                                  \
   macro(OMP_SINGLE, 0, arg)                                                    \
   macro(OMP_MASTER, 0, arg)                                                    \
@@ -104,11 +105,22 @@ enum stats_state_e {
   macro(OMP_test_lock, 0, arg)                                                 \
   macro(REDUCE_wait, 0, arg)                                                   \
   macro(REDUCE_nowait, 0, arg)                                                 \
+  macro(REDUCE_fused, 0, arg)                                                  \
+  macro(ICV_copy, 0, arg)                                                      \
   macro(OMP_TASKYIELD, 0, arg)                                                 \
   macro(OMP_TASKLOOP, 0, arg)                                                  \
   macro(TASK_executed, 0, arg)                                                 \
   macro(TASK_cancelled, 0, arg)                                                \
-  macro(TASK_stolen, 0, arg)
+  macro(TASK_stolen, 0, arg)                                                   \
+  macro(TASK_stolen_near, 0, arg)                                              \
+  macro(TASK_stolen_mid, 0, arg)                                               \
+  macro(TASK_stolen_far, 0, arg)                                               \
+  macro(TASK_continued, 0, arg)                                                \
+  macro(FAST_ALLOC_self_hit, 0, arg)                                           \
+  macro(FAST_ALLOC_sync_hit, 0, arg)                                           \
+  macro(FAST_ALLOC_miss, 0, arg)                                               \
+  macro(FAST_FREE_remote, 0, arg)                                              \
+  macro(FAST_FREE_remote_batch, 0, arg)
 // clang-format on
 
 /*!
@@ -142,6 +154,7 @@ enum stats_state_e {
     macro (OMP_plain_barrier, stats_flags_e::logEvent, arg)                    \
     macro (OMP_fork_barrier, stats_flags_e::logEvent, arg)                     \
     macro (OMP_join_barrier, stats_flags_e::logEvent, arg)                     \
+    macro (OMP_split_barrier, stats_flags_e::logEvent, arg)                    \
     macro (OMP_parallel, stats_flags_e::logEvent, arg)                         \
     macro (OMP_task_immediate, 0, arg)                                         \
     macro (OMP_task_taskwait, 0, arg)                                          \
@@ -163,6 +176,8 @@ enum stats_state_e {
            stats_flags_e::noUnits | stats_flags_e::noTotal, arg)               \
     macro (FOR_static_steal_chunks,                                            \
            stats_flags_e::noUnits | stats_flags_e::noTotal, arg)               \
+    macro (TASK_dephash_chain,                                                 \
+           stats_flags_e::noUnits | stats_flags_e::noTotal, arg)               \
     KMP_FOREACH_DEVELOPER_TIMER(macro, arg)
 // clang-format on
 
@@ -179,6 +194,7 @@ enum stats_state_e {
 // OMP_plain_barrier      -- Time spent in a barrier construct
 // OMP_fork_join_barrier  -- Time spent in a the fork-join barrier surrounding a
 //                           parallel region
+// OMP_split_barrier      -- Time spent waiting at a split barrier after arriving
 // OMP_parallel           -- Time spent inside a parallel construct
 // OMP_task_immediate     -- Time spent executing non-deferred tasks
 // OMP_task_taskwait      -- Time spent executing tasks inside a taskwait
@@ -201,6 +217,8 @@ enum stats_state_e {
 //                           Both adjust for any chunking, so if there were an
 //                           iteration count of 20 but a chunk size of 10, we'd
 //                           record 2.
+// TASK_dephash_chain     -- Number of entries visited in a dependence hash
+//                           bucket to look up a dependence address
 
 #if (KMP_DEVELOPER_STATS)
 // Timers which are of interest to runtime library developers, not end users.
@@ -218,11 +236,15 @@ enum stats_state_e {
 // KMP_tree_release       -- time in __kmp_tree_barrier_release
 // KMP_hyper_gather       -- time in __kmp_hyper_barrier_gather
 // KMP_hyper_release      -- time in __kmp_hyper_barrier_release
+// KMP_dist_gather        -- time in __kmp_dist_barrier_gather
+// KMP_dist_release       -- time in __kmp_dist_barrier_release
 // clang-format off
 #define KMP_FOREACH_DEVELOPER_TIMER(macro, arg)                                \
   macro(KMP_fork_call, 0, arg)                                                 \
   macro(KMP_join_call, 0, arg)                                                 \
   macro(KMP_end_split_barrier, 0, arg)                                         \
+  macro(KMP_dist_gather, 0, arg)                                               \
+  macro(KMP_dist_release, 0, arg)                                              \
   macro(KMP_hier_gather, 0, arg)                                               \
   macro(KMP_hier_release, 0, arg)                                              \
   macro(KMP_hyper_gather, 0, arg)                                              \
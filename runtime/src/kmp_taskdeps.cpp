@@ -15,6 +15,7 @@
 
 #include "kmp.h"
 #include "kmp_io.h"
+#include "kmp_stats.h"
 #include "kmp_wait_release.h"
 #if OMPT_SUPPORT
 #include "ompt-specific.h"
@@ -22,8 +23,6 @@
 
 #if OMP_40_ENABLED
 
-// TODO: Improve memory allocation? keep a list of pre-allocated structures?
-// allocate in blocks? re-use list finished list entries?
 // TODO: don't use atomic ref counters for stack-allocated nodes.
 // TODO: find an alternate to atomic refs for heap-allocated nodes?
 // TODO: Finish graph output support
@@ -35,13 +34,165 @@
 static std::atomic<kmp_int32> kmp_node_id_seed = ATOMIC_VAR_INIT(0);
 #endif
 
+// Depnodes and depnode list entries come from per-thread pools. A pool keeps
+// the chunks of objects it allocated and every object remembers its pool: an
+// object freed by another thread goes back to its pool through a lock-free
+// return list, as in __kmp_fast_free, so a thread that keeps freeing the
+// objects of another one does not make memory grow. The pool of a reaped
+// thread, with whatever is still returned to it, is adopted by the next thread
+// that needs one; chunks and pools are only released at library shutdown.
+enum { dep_pool_node = 0, dep_pool_list = 1 };
+#define KMP_DEP_POOL_CHUNK 64 // objects per chunk, the first one is the header
+
+struct kmp_dep_pool {
+  void *free[2]; // free objects of each kind, only used by the owner
+  std::atomic<void *> sync[2]; // objects freed by other threads
+  void *chunks; // chunks allocated by the pool, linked by first word
+  kmp_dep_pool_t *next; // all pools
+  kmp_dep_pool_t *next_orphan; // pools of reaped threads
+};
+
+static kmp_bootstrap_lock_t __kmp_dep_pool_lock =
+    KMP_BOOTSTRAP_LOCK_INITIALIZER(__kmp_dep_pool_lock);
+static kmp_dep_pool_t *__kmp_dep_pools = NULL; // all pools
+static kmp_dep_pool_t *__kmp_dep_pool_orphans = NULL; // from reaped threads
+
+// __kmp_dep_pool_owner: where an object of the given kind records its pool.
+// The first word of a free object links it in a list, the pool is kept apart.
+static inline kmp_dep_pool_t **__kmp_dep_pool_owner(int kind, void *obj) {
+  if (kind == dep_pool_node)
+    return &((kmp_depnode_t *)obj)->dn.pool;
+  return &((kmp_depnode_list_t *)obj)->pool;
+}
+
+// __kmp_dep_pool_get: give the thread a pool, reusing one of a reaped thread
+static kmp_dep_pool_t *__kmp_dep_pool_get(kmp_info_t *thread) {
+  kmp_dep_pool_t *pool;
+
+  __kmp_acquire_bootstrap_lock(&__kmp_dep_pool_lock);
+  pool = __kmp_dep_pool_orphans;
+  if (pool != NULL) {
+    __kmp_dep_pool_orphans = pool->next_orphan;
+  } else {
+    pool = (kmp_dep_pool_t *)__kmp_allocate(sizeof(kmp_dep_pool_t));
+    pool->next = __kmp_dep_pools;
+    __kmp_dep_pools = pool;
+  }
+  pool->next_orphan = NULL;
+  __kmp_release_bootstrap_lock(&__kmp_dep_pool_lock);
+
+  thread->th.th_dep_pool = pool;
+  return pool;
+}
+
+// __kmp_dep_pool_refill: refill the free list of the given kind of the
+// thread's pool, first with the objects returned by other threads, and return
+// its first object
+static void *__kmp_dep_pool_refill(kmp_info_t *thread, int kind, size_t size) {
+  kmp_dep_pool_t *pool = thread->th.th_dep_pool;
+  void *list;
+
+  if (pool == NULL)
+    pool = __kmp_dep_pool_get(thread);
+  list = pool->free[kind];
+  if (list != NULL)
+    return list;
+
+  list = pool->sync[kind].exchange(NULL);
+  if (list == NULL) {
+    char *chunk = (char *)__kmp_allocate(KMP_DEP_POOL_CHUNK * size);
+    *(void **)chunk = pool->chunks;
+    pool->chunks = chunk;
+    for (int i = KMP_DEP_POOL_CHUNK - 1; i > 0; i--) {
+      void *obj = chunk + i * size;
+      *__kmp_dep_pool_owner(kind, obj) = pool;
+      *(void **)obj = list;
+      list = obj;
+    }
+  }
+
+  KA_TRACE(40, ("__kmp_dep_pool_refill: T#%d refilled pool %d\n",
+                __kmp_gtid_from_thread(thread), kind));
+  pool->free[kind] = list;
+  return list;
+}
+
+static inline void *__kmp_dep_pool_alloc(kmp_info_t *thread, int kind,
+                                         size_t size) {
+  kmp_dep_pool_t *pool = thread->th.th_dep_pool;
+  void *obj;
+  if (UNLIKELY(pool == NULL || pool->free[kind] == NULL)) {
+    obj = __kmp_dep_pool_refill(thread, kind, size);
+    pool = thread->th.th_dep_pool;
+  } else {
+    obj = pool->free[kind];
+  }
+  pool->free[kind] = *(void **)obj;
+  return obj;
+}
+
+static inline void __kmp_dep_pool_free(kmp_info_t *thread, int kind,
+                                       void *obj) {
+  kmp_dep_pool_t *pool = *__kmp_dep_pool_owner(kind, obj);
+  if (pool == thread->th.th_dep_pool) {
+    *(void **)obj = pool->free[kind];
+    pool->free[kind] = obj;
+    return;
+  }
+  // Return the object to the pool it came from
+  void *old_head = pool->sync[kind].load(std::memory_order_relaxed);
+  do {
+    *(void **)obj = old_head;
+  } while (!pool->sync[kind].compare_exchange_weak(old_head, obj));
+}
+
+// __kmp_reap_dep_pools: hand the pool of a thread being reaped over to the
+// next thread that needs one
+void __kmp_reap_dep_pools(kmp_info_t *thread) {
+  kmp_dep_pool_t *pool = thread->th.th_dep_pool;
+  if (pool == NULL)
+    return;
+  __kmp_acquire_bootstrap_lock(&__kmp_dep_pool_lock);
+  pool->next_orphan = __kmp_dep_pool_orphans;
+  __kmp_dep_pool_orphans = pool;
+  __kmp_release_bootstrap_lock(&__kmp_dep_pool_lock);
+  thread->th.th_dep_pool = NULL;
+}
+
+// __kmp_cleanup_dep_pools: release all pools and their chunks at library
+// shutdown, after all threads have been reaped
+void __kmp_cleanup_dep_pools(void) {
+  kmp_dep_pool_t *next;
+  for (kmp_dep_pool_t *pool = __kmp_dep_pools; pool != NULL; pool = next) {
+    next = pool->next;
+    void *chunk = pool->chunks;
+    while (chunk != NULL) {
+      void *next_chunk = *(void **)chunk;
+      __kmp_free(chunk);
+      chunk = next_chunk;
+    }
+    __kmp_free(pool);
+  }
+  __kmp_dep_pools = NULL;
+  __kmp_dep_pool_orphans = NULL;
+}
+
+// References to a node taken by the thread processing its dependences are
+// counted in batches: nrefs is raised in advance and nrefs_credit hands the
+// references out, the unused ones are given back once by __kmp_check_deps.
+#define KMP_DEPNODE_REF_BATCH 16
+
 static void __kmp_init_node(kmp_depnode_t *node) {
   node->dn.task = NULL; // set to null initially, it will point to the right
   // task once dependences have been processed
   node->dn.successors = NULL;
   __kmp_init_lock(&node->dn.lock);
-  KMP_ATOMIC_ST_RLX(&node->dn.nrefs,
-                    1); // init creates the first reference to the node
+  // init creates the first reference to the node, plus a batch for
+  // __kmp_node_ref_own; nobody else sees the node yet
+  KMP_ATOMIC_ST_RLX(&node->dn.nrefs, 1 + KMP_DEPNODE_REF_BATCH);
+  node->dn.nrefs_credit = KMP_DEPNODE_REF_BATCH;
+  node->dn.tdg_index = -1;
+  node->dn.mtx_num_locks = 0;
 #ifdef KMP_SUPPORT_GRAPH_OUTPUT
   node->dn.id = KMP_ATOMIC_INC(&kmp_node_id_seed);
 #endif
@@ -52,6 +203,26 @@ static inline kmp_depnode_t *__kmp_node_ref(kmp_depnode_t *node) {
   return node;
 }
 
+// __kmp_node_ref_own: new reference to the node whose dependences the calling
+// thread is processing
+static inline kmp_depnode_t *__kmp_node_ref_own(kmp_depnode_t *node) {
+  if (node->dn.nrefs_credit == 0) {
+    KMP_ATOMIC_ADD(&node->dn.nrefs, KMP_DEPNODE_REF_BATCH);
+    node->dn.nrefs_credit = KMP_DEPNODE_REF_BATCH;
+  }
+  node->dn.nrefs_credit--;
+  return node;
+}
+
+// __kmp_node_ref_own_done: give back the references counted in advance but
+// not handed out. The caller still holds its own reference to the node.
+static inline void __kmp_node_ref_own_done(kmp_depnode_t *node) {
+  if (node->dn.nrefs_credit) {
+    KMP_ATOMIC_SUB(&node->dn.nrefs, node->dn.nrefs_credit);
+    node->dn.nrefs_credit = 0;
+  }
+}
+
 static inline void __kmp_node_deref(kmp_info_t *thread, kmp_depnode_t *node) {
   if (!node)
     return;
@@ -59,25 +230,97 @@ static inline void __kmp_node_deref(kmp_info_t *thread, kmp_depnode_t *node) {
   kmp_int32 n = KMP_ATOMIC_DEC(&node->dn.nrefs) - 1;
   if (n == 0) {
     KMP_ASSERT(node->dn.nrefs == 0);
-#if USE_FAST_MEMORY
-    __kmp_fast_free(thread, node);
-#else
-    __kmp_thread_free(thread, node);
-#endif
+    __kmp_dep_pool_free(thread, dep_pool_node, node);
+  }
+}
+
+static inline void __kmp_dep_mtx_deref(kmp_dep_mtx_t *mtx) {
+  if (KMP_ATOMIC_DEC(&mtx->nrefs) == 1) {
+    __kmp_destroy_lock(&mtx->lock);
+    __kmp_free(mtx);
+  }
+}
+
+// __kmp_add_mtx_dep: let node hold the mutexinoutset lock of info while its
+// task runs. Returns false if node has no room for another lock.
+static bool __kmp_add_mtx_dep(kmp_depnode_t *node, kmp_dephash_entry_t *info) {
+  kmp_dep_mtx_t *mtx = info->mtx_lock;
+  kmp_int32 n = node->dn.mtx_num_locks;
+  kmp_int32 m;
+
+  if (mtx == NULL) {
+    mtx = (kmp_dep_mtx_t *)__kmp_allocate(sizeof(kmp_dep_mtx_t));
+    __kmp_init_lock(&mtx->lock);
+    KMP_ATOMIC_ST_RLX(&mtx->nrefs, 1); // the entry's reference
+    info->mtx_lock = mtx;
+  }
+  for (m = 0; m < n && node->dn.mtx_locks[m] > mtx; m++)
+    ;
+  if (m < n && node->dn.mtx_locks[m] == mtx)
+    return true; // same address in both dependence lists
+  if (n == MAX_MTX_DEPS)
+    return false;
+  // keep the locks sorted so that tasks always take them in the same order
+  for (kmp_int32 i = n; i > m; i--)
+    node->dn.mtx_locks[i] = node->dn.mtx_locks[i - 1];
+  node->dn.mtx_locks[m] = mtx;
+  node->dn.mtx_num_locks = n + 1;
+  KMP_ATOMIC_INC(&mtx->nrefs);
+  return true;
+}
+
+// __kmp_acquire_mtx_deps: try to take the mutexinoutset locks of node before
+// its task runs. Returns false holding none of them if one is busy.
+bool __kmp_acquire_mtx_deps(kmp_int32 gtid, kmp_depnode_t *node) {
+  kmp_int32 n = node->dn.mtx_num_locks;
+  KMP_DEBUG_ASSERT(n > 0);
+  for (kmp_int32 i = 0; i < n; i++) {
+    if (!__kmp_test_lock(&node->dn.mtx_locks[i]->lock, gtid)) {
+      for (kmp_int32 j = i - 1; j >= 0; j--)
+        __kmp_release_lock(&node->dn.mtx_locks[j]->lock, gtid);
+      KA_TRACE(40, ("__kmp_acquire_mtx_deps: T#%d lock %d of %d busy for node "
+                    "%p\n",
+                    gtid, i, n, node));
+      return false;
+    }
   }
+  node->dn.mtx_num_locks = -n; // held
+  return true;
+}
+
+// __kmp_release_mtx_deps: drop the mutexinoutset locks of a finished task
+static void __kmp_release_mtx_deps(kmp_int32 gtid, kmp_depnode_t *node) {
+  kmp_int32 n = node->dn.mtx_num_locks;
+  if (n < 0) {
+    n = -n;
+    for (kmp_int32 i = n - 1; i >= 0; i--)
+      __kmp_release_lock(&node->dn.mtx_locks[i]->lock, gtid);
+  }
+  for (kmp_int32 i = 0; i < n; i++)
+    __kmp_dep_mtx_deref(node->dn.mtx_locks[i]);
+  node->dn.mtx_num_locks = 0;
 }
 
 #define KMP_ACQUIRE_DEPNODE(gtid, n) __kmp_acquire_lock(&(n)->dn.lock, (gtid))
 #define KMP_RELEASE_DEPNODE(gtid, n) __kmp_release_lock(&(n)->dn.lock, (gtid))
 
 static void __kmp_depnode_list_free(kmp_info_t *thread, kmp_depnode_list *list);
-
-enum { KMP_DEPHASH_OTHER_SIZE = 97, KMP_DEPHASH_MASTER_SIZE = 997 };
-
-static inline kmp_int32 __kmp_dephash_hash(kmp_intptr_t addr, size_t hsize) {
-  // TODO alternate to try: set = (((Addr64)(addrUsefulBits * 9.618)) %
-  // m_num_sets );
-  return ((addr >> 6) ^ (addr >> 2)) % hsize;
+static void __kmp_dep_ranges_free(kmp_info_t *thread, kmp_dephash_t *h);
+
+// Initial number of buckets, must be powers of 2. The table doubles whenever
+// it holds more entries than 3/4 of its buckets.
+enum { KMP_DEPHASH_OTHER_SIZE = 128, KMP_DEPHASH_MASTER_SIZE = 1024 };
+
+static inline size_t __kmp_dephash_hash(kmp_intptr_t addr, size_t hsize) {
+  // Mix all bits of the address into the low ones (finalizer of MurmurHash3),
+  // so that nearby and equally aligned addresses spread over the buckets
+  kmp_uint64 h = (kmp_uint64)addr;
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return (size_t)h & (hsize - 1);
 }
 
 static kmp_dephash_t *__kmp_dephash_create(kmp_info_t *thread,
@@ -100,11 +343,16 @@ static kmp_dephash_t *__kmp_dephash_create(kmp_info_t *thread,
   h = (kmp_dephash_t *)__kmp_thread_malloc(thread, size);
 #endif
   h->size = h_size;
+  h->nelements = 0;
+  h->nranges = 0;
+  h->ranges_size = 0;
+  h->ranges = NULL;
 
 #ifdef KMP_DEBUG
-  h->nelements = 0;
   h->nconflicts = 0;
+  h->max_chain = 0;
 #endif
+  // The initial buckets follow the table, larger ones are allocated apart
   h->buckets = (kmp_dephash_entry **)(h + 1);
 
   for (size_t i = 0; i < h_size; i++)
@@ -113,14 +361,70 @@ static kmp_dephash_t *__kmp_dephash_create(kmp_info_t *thread,
   return h;
 }
 
+// __kmp_dephash_extend: double the number of buckets of h and rehash its
+// entries. Only the thread owning the table accesses it, no locking required.
+static void __kmp_dephash_extend(kmp_info_t *thread, kmp_dephash_t *h) {
+  size_t new_size = h->size * 2;
+  kmp_dephash_entry_t **old_buckets = h->buckets;
+  kmp_dephash_entry_t **new_buckets;
+
+#if USE_FAST_MEMORY
+  new_buckets = (kmp_dephash_entry_t **)__kmp_fast_allocate(
+      thread, new_size * sizeof(kmp_dephash_entry_t *));
+#else
+  new_buckets = (kmp_dephash_entry_t **)__kmp_thread_malloc(
+      thread, new_size * sizeof(kmp_dephash_entry_t *));
+#endif
+  for (size_t i = 0; i < new_size; i++)
+    new_buckets[i] = 0;
+
+  for (size_t i = 0; i < h->size; i++) {
+    kmp_dephash_entry_t *next;
+    for (kmp_dephash_entry_t *entry = old_buckets[i]; entry; entry = next) {
+      size_t bucket = __kmp_dephash_hash(entry->addr, new_size);
+      next = entry->next_in_bucket;
+      entry->next_in_bucket = new_buckets[bucket];
+      new_buckets[bucket] = entry;
+    }
+  }
+
+  KA_TRACE(40, ("__kmp_dephash_extend: T#%d hash %p grows from %d to %d "
+                "buckets for %d entries\n",
+                __kmp_gtid_from_thread(thread), h, (int)h->size, (int)new_size,
+                (int)h->nelements));
+
+  h->buckets = new_buckets;
+  h->size = new_size;
+  if (old_buckets != (kmp_dephash_entry_t **)(h + 1)) {
+#if USE_FAST_MEMORY
+    __kmp_fast_free(thread, old_buckets);
+#else
+    __kmp_thread_free(thread, old_buckets);
+#endif
+  }
+}
+
 void __kmp_dephash_free_entries(kmp_info_t *thread, kmp_dephash_t *h) {
+  KA_TRACE(40, ("__kmp_dephash_free_entries: T#%d hash %p had %d entries in "
+                "%d buckets\n",
+                __kmp_gtid_from_thread(thread), h, (int)h->nelements,
+                (int)h->size));
+#ifdef KMP_DEBUG
+  KA_TRACE(40, ("__kmp_dephash_free_entries: T#%d hash %p had %d conflicts, "
+                "longest chain %d\n",
+                __kmp_gtid_from_thread(thread), h, (int)h->nconflicts,
+                (int)h->max_chain));
+#endif
   for (size_t i = 0; i < h->size; i++) {
     if (h->buckets[i]) {
       kmp_dephash_entry_t *next;
       for (kmp_dephash_entry_t *entry = h->buckets[i]; entry; entry = next) {
         next = entry->next_in_bucket;
         __kmp_depnode_list_free(thread, entry->last_ins);
+        __kmp_depnode_list_free(thread, entry->prev_set);
         __kmp_node_deref(thread, entry->last_out);
+        if (entry->mtx_lock)
+          __kmp_dep_mtx_deref(entry->mtx_lock);
 #if USE_FAST_MEMORY
         __kmp_fast_free(thread, entry);
 #else
@@ -130,27 +434,46 @@ void __kmp_dephash_free_entries(kmp_info_t *thread, kmp_dephash_t *h) {
       h->buckets[i] = 0;
     }
   }
+  h->nelements = 0;
+  if (h->nranges)
+    __kmp_dep_ranges_free(thread, h);
 }
 
 void __kmp_dephash_free(kmp_info_t *thread, kmp_dephash_t *h) {
   __kmp_dephash_free_entries(thread, h);
 #if USE_FAST_MEMORY
+  if (h->ranges)
+    __kmp_fast_free(thread, h->ranges);
+  if (h->buckets != (kmp_dephash_entry_t **)(h + 1))
+    __kmp_fast_free(thread, h->buckets);
   __kmp_fast_free(thread, h);
 #else
+  if (h->ranges)
+    __kmp_thread_free(thread, h->ranges);
+  if (h->buckets != (kmp_dephash_entry_t **)(h + 1))
+    __kmp_thread_free(thread, h->buckets);
   __kmp_thread_free(thread, h);
 #endif
 }
 
 static kmp_dephash_entry *
 __kmp_dephash_find(kmp_info_t *thread, kmp_dephash_t *h, kmp_intptr_t addr) {
-  kmp_int32 bucket = __kmp_dephash_hash(addr, h->size);
+  size_t bucket = __kmp_dephash_hash(addr, h->size);
+  kmp_uint32 chain = 0;
 
   kmp_dephash_entry_t *entry;
-  for (entry = h->buckets[bucket]; entry; entry = entry->next_in_bucket)
+  for (entry = h->buckets[bucket]; entry; entry = entry->next_in_bucket) {
+    ++chain;
     if (entry->addr == addr)
       break;
+  }
+  KMP_COUNT_VALUE(TASK_dephash_chain, chain);
 
   if (entry == NULL) {
+    if (h->nelements >= h->size - h->size / 4) {
+      __kmp_dephash_extend(thread, h);
+      bucket = __kmp_dephash_hash(addr, h->size);
+    }
 // create entry. This is only done by one thread so no locking required
 #if USE_FAST_MEMORY
     entry = (kmp_dephash_entry_t *)__kmp_fast_allocate(
@@ -162,36 +485,48 @@ __kmp_dephash_find(kmp_info_t *thread, kmp_dephash_t *h, kmp_intptr_t addr) {
     entry->addr = addr;
     entry->last_out = NULL;
     entry->last_ins = NULL;
+    entry->prev_set = NULL;
+    entry->last_flag = 0;
+    entry->mtx_lock = NULL;
     entry->next_in_bucket = h->buckets[bucket];
     h->buckets[bucket] = entry;
-#ifdef KMP_DEBUG
     h->nelements++;
+#ifdef KMP_DEBUG
     if (entry->next_in_bucket)
       h->nconflicts++;
+    if (chain >= h->max_chain)
+      h->max_chain = chain + 1;
 #endif
   }
   return entry;
 }
 
-static kmp_depnode_list_t *__kmp_add_node(kmp_info_t *thread,
-                                          kmp_depnode_list_t *list,
-                                          kmp_depnode_t *node) {
-  kmp_depnode_list_t *new_head;
-
-#if USE_FAST_MEMORY
-  new_head = (kmp_depnode_list_t *)__kmp_fast_allocate(
-      thread, sizeof(kmp_depnode_list_t));
-#else
-  new_head = (kmp_depnode_list_t *)__kmp_thread_malloc(
-      thread, sizeof(kmp_depnode_list_t));
-#endif
+static inline kmp_depnode_list_t *
+__kmp_new_list_entry(kmp_info_t *thread, kmp_depnode_list_t *list,
+                     kmp_depnode_t *node) {
+  kmp_depnode_list_t *new_head = (kmp_depnode_list_t *)__kmp_dep_pool_alloc(
+      thread, dep_pool_list, sizeof(kmp_depnode_list_t));
 
-  new_head->node = __kmp_node_ref(node);
+  new_head->node = node;
   new_head->next = list;
 
   return new_head;
 }
 
+static kmp_depnode_list_t *__kmp_add_node(kmp_info_t *thread,
+                                          kmp_depnode_list_t *list,
+                                          kmp_depnode_t *node) {
+  return __kmp_new_list_entry(thread, list, __kmp_node_ref(node));
+}
+
+// __kmp_add_own_node: same as __kmp_add_node for the node whose dependences
+// the calling thread is processing
+static inline kmp_depnode_list_t *__kmp_add_own_node(kmp_info_t *thread,
+                                                     kmp_depnode_list_t *list,
+                                                     kmp_depnode_t *node) {
+  return __kmp_new_list_entry(thread, list, __kmp_node_ref_own(node));
+}
+
 static void __kmp_depnode_list_free(kmp_info_t *thread,
                                     kmp_depnode_list *list) {
   kmp_depnode_list *next;
@@ -200,12 +535,295 @@ static void __kmp_depnode_list_free(kmp_info_t *thread,
     next = list->next;
 
     __kmp_node_deref(thread, list->node);
-#if USE_FAST_MEMORY
-    __kmp_fast_free(thread, list);
-#else
-    __kmp_thread_free(thread, list);
+    __kmp_dep_pool_free(thread, dep_pool_list, list);
+  }
+}
+
+// Task graph record and replay. A region between __kmpc_start_record_task
+// and __kmpc_end_record_task that creates the same tasks with the same
+// dependences every time it runs is recorded once: its tasks are numbered in
+// creation order and the edges found by __kmp_process_deps are kept. Later
+// runs of the region skip dependence processing altogether; the k-th task
+// created gets the k-th node of the graph, whose precomputed predecessor count
+// is decremented by each finishing predecessor.
+
+static kmp_bootstrap_lock_t __kmp_tdg_lock =
+    KMP_BOOTSTRAP_LOCK_INITIALIZER(__kmp_tdg_lock);
+static kmp_tdg_t *__kmp_tdgs = NULL; // all graphs, never freed before cleanup
+
+static kmp_tdg_t *__kmp_find_tdg(kmp_int32 tdg_id) {
+  kmp_tdg_t *tdg;
+  __kmp_acquire_bootstrap_lock(&__kmp_tdg_lock);
+  for (tdg = __kmp_tdgs; tdg; tdg = tdg->next_tdg)
+    if (tdg->id == tdg_id)
+      break;
+  if (tdg == NULL) {
+    tdg = (kmp_tdg_t *)__kmp_allocate(sizeof(kmp_tdg_t));
+    tdg->id = tdg_id;
+    KMP_ATOMIC_ST_RLX(&tdg->status, tdg_empty);
+    tdg->next_tdg = __kmp_tdgs;
+    __kmp_tdgs = tdg;
+  }
+  __kmp_release_bootstrap_lock(&__kmp_tdg_lock);
+  return tdg;
+}
+
+// __kmp_tdg_free_replay_data: drop what the graph needs for replaying
+static void __kmp_tdg_free_replay_data(kmp_tdg_t *tdg) {
+  if (tdg->npredecessors) {
+    __kmp_free(tdg->npredecessors);
+    tdg->npredecessors = NULL;
+  }
+  if (tdg->tasks) {
+    __kmp_free(tdg->tasks);
+    tdg->tasks = NULL;
+  }
+}
+
+void __kmp_cleanup_tdgs(void) {
+  kmp_tdg_t *next;
+  for (kmp_tdg_t *tdg = __kmp_tdgs; tdg; tdg = next) {
+    next = tdg->next_tdg;
+    __kmp_tdg_free_replay_data(tdg);
+    if (tdg->nodes)
+      __kmp_free(tdg->nodes);
+    if (tdg->deps)
+      __kmp_free(tdg->deps);
+    if (tdg->edges)
+      __kmp_free(tdg->edges);
+    __kmp_free(tdg);
+  }
+  __kmp_tdgs = NULL;
+}
+
+// __kmp_tdg_grow: double the size of a graph array of elements of elem_size
+// bytes, size elements of which are in use
+static void *__kmp_tdg_grow(void *array, kmp_int32 *size, size_t elem_size) {
+  kmp_int32 new_size = *size ? 2 * *size : 64;
+  void *new_array = __kmp_allocate(new_size * elem_size);
+  if (array) {
+    KMP_MEMCPY(new_array, array, *size * elem_size);
+    __kmp_free(array);
+  }
+  *size = new_size;
+  return new_array;
+}
+
+// __kmp_tdg_record_deps: keep a copy of the n dependences of a task
+static void __kmp_tdg_record_deps(kmp_tdg_t *tdg, kmp_int32 n,
+                                  const kmp_depend_info_t *dep_list) {
+  if (n == 0)
+    return;
+  while (tdg->ndeps + n > tdg->deps_size)
+    tdg->deps = (kmp_depend_info_t *)__kmp_tdg_grow(
+        tdg->deps, &tdg->deps_size, sizeof(kmp_depend_info_t));
+  KMP_MEMCPY(tdg->deps + tdg->ndeps, dep_list, n * sizeof(kmp_depend_info_t));
+  tdg->ndeps += n;
+}
+
+// __kmp_tdg_record_task: add the task being created to the graph recorded
+static void __kmp_tdg_record_task(kmp_tdg_t *tdg, ident_t *loc_ref,
+                                  kmp_taskdata_t *taskdata, kmp_depnode_t *node,
+                                  kmp_int32 ndeps, kmp_depend_info_t *dep_list,
+                                  kmp_int32 ndeps_noalias,
+                                  kmp_depend_info_t *noalias_dep_list) {
+  if (tdg->nnodes == tdg->nodes_size)
+    tdg->nodes = (kmp_tdg_node_t *)__kmp_tdg_grow(
+        tdg->nodes, &tdg->nodes_size, sizeof(kmp_tdg_node_t));
+  kmp_int32 i = tdg->nnodes++;
+  tdg->nodes[i].ident = loc_ref;
+  tdg->nodes[i].ndeps = ndeps + ndeps_noalias;
+  tdg->nodes[i].deps = tdg->ndeps;
+  __kmp_tdg_record_deps(tdg, ndeps, dep_list);
+  __kmp_tdg_record_deps(tdg, ndeps_noalias, noalias_dep_list);
+  node->dn.tdg_index = i;
+  taskdata->td_tdg = tdg;
+  taskdata->td_tdg_index = i;
+  // replayed tasks have no depnode to hold mutexinoutset locks
+  for (kmp_int32 k = tdg->nodes[i].deps; k < tdg->ndeps; k++)
+    if (tdg->deps[k].base_addr != 0 && tdg->deps[k].flags.mtx)
+      tdg->replayable = false;
+#if OMP_45_ENABLED
+  if (taskdata->td_flags.proxy == TASK_PROXY)
+    tdg->replayable = false; // completed outside of the runtime's control
 #endif
+  KMP_ATOMIC_INC(&tdg->nremaining);
+}
+
+// __kmp_tdg_record_edge: pred must finish before succ starts. Edges are
+// recorded even if pred has already finished, unlike successors.
+static void __kmp_tdg_record_edge(kmp_tdg_t *tdg, kmp_int32 pred,
+                                  kmp_int32 succ) {
+  kmp_int32 *edge;
+  if (tdg->nedges > 0) {
+    edge = tdg->edges + 2 * (tdg->nedges - 1);
+    if (edge[0] == pred && edge[1] == succ)
+      return;
+  }
+  if (2 * tdg->nedges == tdg->edges_size)
+    tdg->edges = (kmp_int32 *)__kmp_tdg_grow(tdg->edges, &tdg->edges_size,
+                                             sizeof(kmp_int32));
+  edge = tdg->edges + 2 * tdg->nedges++;
+  edge[0] = pred;
+  edge[1] = succ;
+}
+
+static int __kmp_tdg_compare_index(const void *a, const void *b) {
+  return *(const kmp_int32 *)a - *(const kmp_int32 *)b;
+}
+
+// __kmp_tdg_finalize: turn the recorded edges into the successor lists of the
+// nodes and count the predecessors
+static void __kmp_tdg_finalize(kmp_tdg_t *tdg) {
+  kmp_int32 n = tdg->nnodes;
+  kmp_int32 *succ = (kmp_int32 *)__kmp_allocate(
+      (tdg->nedges ? tdg->nedges : 1) * sizeof(kmp_int32));
+  kmp_int32 i, e, pos;
+
+  for (i = 0; i < n; i++) {
+    tdg->nodes[i].npredecessors = 0;
+    tdg->nodes[i].nsuccessors = 0;
+  }
+  for (e = 0; e < tdg->nedges; e++)
+    tdg->nodes[tdg->edges[2 * e]].nsuccessors++;
+  for (i = 0, pos = 0; i < n; i++) {
+    tdg->nodes[i].successors = pos;
+    pos += tdg->nodes[i].nsuccessors;
+    tdg->nodes[i].nsuccessors = 0;
+  }
+  for (e = 0; e < tdg->nedges; e++) {
+    kmp_tdg_node_t *pred = &tdg->nodes[tdg->edges[2 * e]];
+    succ[pred->successors + pred->nsuccessors++] = tdg->edges[2 * e + 1];
+  }
+  // drop duplicate edges, which come from several dependences on the same
+  // predecessor, and compact the lists
+  for (i = 0, pos = 0; i < n; i++) {
+    kmp_tdg_node_t *node = &tdg->nodes[i];
+    kmp_int32 *list = succ + node->successors;
+    kmp_int32 m = 0;
+    qsort(list, node->nsuccessors, sizeof(kmp_int32), __kmp_tdg_compare_index);
+    for (e = 0; e < node->nsuccessors; e++) {
+      if (m > 0 && succ[pos + m - 1] == list[e])
+        continue;
+      succ[pos + m++] = list[e];
+      tdg->nodes[list[e]].npredecessors++;
+    }
+    node->successors = pos;
+    node->nsuccessors = m;
+    pos += m;
   }
+  if (tdg->edges)
+    __kmp_free(tdg->edges);
+  tdg->edges = succ;
+  tdg->nedges = pos;
+  tdg->edges_size = pos;
+
+  tdg->npredecessors = (std::atomic<kmp_int32> *)__kmp_allocate(
+      n * sizeof(std::atomic<kmp_int32>));
+  tdg->tasks = (kmp_taskdata_t **)__kmp_allocate(n * sizeof(kmp_taskdata_t *));
+  KA_TRACE(20, ("__kmp_tdg_finalize: graph %d has %d tasks and %d edges\n",
+                tdg->id, n, pos));
+}
+
+// __kmp_tdg_wait: execute tasks until all tasks of the graph have finished
+static void __kmp_tdg_wait(kmp_int32 gtid, kmp_info_t *thread,
+                           kmp_tdg_t *tdg) {
+  int thread_finished = FALSE;
+  kmp_flag_32 flag((std::atomic<kmp_uint32> *)&tdg->nremaining, 0U);
+  while (KMP_ATOMIC_LD_ACQ(&tdg->nremaining) != 0) {
+    flag.execute_tasks(thread, gtid, FALSE,
+                       &thread_finished USE_ITT_BUILD_ARG(NULL),
+                       __kmp_task_stealing_constraint);
+  }
+}
+
+// __kmp_tdg_stop_replay: the region no longer creates the recorded tasks.
+// The tasks created so far only depend on each other, so once they are done
+// the rest of the region goes on with the usual dependence processing in a
+// hash of its own, as when recording, and __kmpc_end_record_task still waits
+// for its tasks. The region is recorded again next time.
+static void __kmp_tdg_stop_replay(kmp_int32 gtid, kmp_info_t *thread,
+                                  kmp_taskdata_t *current_task,
+                                  kmp_tdg_t *tdg) {
+  KA_TRACE(10, ("__kmp_tdg_stop_replay: T#%d graph %d diverged at task %d "
+                "of %d\n",
+                gtid, tdg->id, tdg->next, tdg->nnodes));
+  __kmp_tdg_wait(gtid, thread, tdg);
+  __kmp_tdg_free_replay_data(tdg);
+  tdg->nnodes = 0;
+  tdg->ndeps = 0;
+  tdg->nedges = 0;
+  if (tdg->edges) {
+    __kmp_free(tdg->edges);
+    tdg->edges = NULL;
+    tdg->edges_size = 0;
+  }
+  tdg->saved_dephash = current_task->td_dephash;
+  current_task->td_dephash = NULL;
+  KMP_ATOMIC_ST_REL(&tdg->status, tdg_diverged);
+}
+
+// __kmp_tdg_same_deps: check if the n dependences in dep_list are the ones
+// recorded at rec
+static bool __kmp_tdg_same_deps(const kmp_depend_info_t *rec, kmp_int32 n,
+                                const kmp_depend_info_t *dep_list) {
+  for (kmp_int32 k = 0; k < n; k++) {
+    if (rec[k].base_addr != dep_list[k].base_addr ||
+        rec[k].len != dep_list[k].len ||
+        rec[k].flags.in != dep_list[k].flags.in ||
+        rec[k].flags.out != dep_list[k].flags.out ||
+        rec[k].flags.mtx != dep_list[k].flags.mtx ||
+        rec[k].flags.set != dep_list[k].flags.set)
+      return false;
+  }
+  return true;
+}
+
+// __kmp_tdg_replay_task: give the task being created its node of the graph
+// replayed. Returns false if it does not match the recording, i.e. it comes
+// from another location or has other dependences, which stops the replay.
+static bool __kmp_tdg_replay_task(kmp_int32 gtid, kmp_info_t *thread,
+                                  kmp_taskdata_t *current_task, kmp_tdg_t *tdg,
+                                  ident_t *loc_ref, kmp_task_t *new_task,
+                                  kmp_int32 ndeps, kmp_depend_info_t *dep_list,
+                                  kmp_int32 ndeps_noalias,
+                                  kmp_depend_info_t *noalias_dep_list,
+                                  kmp_int32 *result) {
+  kmp_taskdata_t *new_taskdata = KMP_TASK_TO_TASKDATA(new_task);
+  kmp_int32 i = tdg->next;
+  const kmp_tdg_node_t *node = i < tdg->nnodes ? &tdg->nodes[i] : NULL;
+
+  if (node == NULL || node->ident != loc_ref ||
+      node->ndeps != ndeps + ndeps_noalias ||
+      !__kmp_tdg_same_deps(tdg->deps + node->deps, ndeps, dep_list) ||
+      !__kmp_tdg_same_deps(tdg->deps + node->deps + ndeps, ndeps_noalias,
+                           noalias_dep_list)
+#if OMP_45_ENABLED
+      || new_taskdata->td_flags.proxy == TASK_PROXY
+#endif
+      ) {
+    __kmp_tdg_stop_replay(gtid, thread, current_task, tdg);
+    return false;
+  }
+  tdg->next = i + 1;
+  new_taskdata->td_tdg = tdg;
+  new_taskdata->td_tdg_index = i;
+  tdg->tasks[i] = new_taskdata;
+  KMP_ATOMIC_INC(&tdg->nremaining);
+
+  // drop the reference that kept finishing predecessors from scheduling it
+  if (KMP_ATOMIC_DEC(&tdg->npredecessors[i]) == 1) {
+    KA_TRACE(20, ("__kmp_tdg_replay_task: T#%d task %p is node %d of graph %d, "
+                  "ready\n",
+                  gtid, new_taskdata, i, tdg->id));
+    *result = __kmp_omp_task(gtid, new_task, true);
+  } else {
+    KA_TRACE(20, ("__kmp_tdg_replay_task: T#%d task %p is node %d of graph %d, "
+                  "waiting\n",
+                  gtid, new_taskdata, i, tdg->id));
+    *result = TASK_CURRENT_NOT_QUEUED;
+  }
+  return true;
 }
 
 static inline void __kmp_track_dependence(kmp_depnode_t *source,
@@ -236,6 +854,280 @@ static inline void __kmp_track_dependence(kmp_depnode_t *source,
 #endif /* OMPT_SUPPORT && OMPT_OPTIONAL */
 }
 
+// __kmp_add_successor: make node a successor of pred if pred has not finished
+// yet. Returns 1 if pred is a new predecessor of node. Only the thread that
+// creates the sibling tasks adds successors, so if node was already added to
+// pred it is still at the head of the list.
+template <bool filter>
+static inline kmp_int32 __kmp_add_successor(kmp_int32 gtid, kmp_info_t *thread,
+                                            kmp_depnode_t *pred,
+                                            kmp_depnode_t *node,
+                                            kmp_task_t *task) {
+  kmp_int32 added = 0;
+  if (UNLIKELY(node->dn.tdg_index >= 0) && pred->dn.tdg_index >= 0)
+    __kmp_tdg_record_edge(KMP_TASK_TO_TASKDATA(task)->td_tdg,
+                          pred->dn.tdg_index, node->dn.tdg_index);
+  if (pred->dn.task) {
+    KMP_ACQUIRE_DEPNODE(gtid, pred);
+    if (pred->dn.task &&
+        (pred->dn.successors == NULL || pred->dn.successors->node != node)) {
+      __kmp_track_dependence(pred, node, task);
+      pred->dn.successors =
+          __kmp_add_own_node(thread, pred->dn.successors, node);
+      KA_TRACE(40, ("__kmp_process_deps<%d>: T#%d adding dependence from %p to "
+                    "%p\n",
+                    filter, gtid, KMP_TASK_TO_TASKDATA(pred->dn.task),
+                    KMP_TASK_TO_TASKDATA(task)));
+      added = 1;
+    }
+    KMP_RELEASE_DEPNODE(gtid, pred);
+  }
+  return added;
+}
+
+// __kmp_process_dep_state: make node depend on the tasks recorded for one
+// dependence address (or range segment) and record node there in turn.
+// Returns the number of predecessors found.
+template <bool filter>
+static inline kmp_int32
+__kmp_process_dep_state(kmp_int32 gtid, kmp_info_t *thread, kmp_depnode_t *node,
+                        kmp_depnode_t **last_out_p,
+                        kmp_depnode_list_t **last_ins_p, bool dep_barrier,
+                        bool out, kmp_task_t *task) {
+  kmp_int32 npredecessors = 0;
+  kmp_depnode_t *last_out = *last_out_p;
+
+  if (out && *last_ins_p) {
+    for (kmp_depnode_list_t *p = *last_ins_p; p; p = p->next)
+      npredecessors +=
+          __kmp_add_successor<filter>(gtid, thread, p->node, node, task);
+
+    __kmp_depnode_list_free(thread, *last_ins_p);
+    *last_ins_p = NULL;
+
+  } else if (last_out) {
+    npredecessors +=
+        __kmp_add_successor<filter>(gtid, thread, last_out, node, task);
+  }
+
+  if (dep_barrier) {
+    // if this is a sync point in the serial sequence, then the previous
+    // outputs are guaranteed to be completed after
+    // the execution of this task so the previous output nodes can be cleared.
+    __kmp_node_deref(thread, last_out);
+    *last_out_p = NULL;
+  } else {
+    if (out) {
+      __kmp_node_deref(thread, last_out);
+      *last_out_p = __kmp_node_ref_own(node);
+    } else
+      *last_ins_p = __kmp_add_own_node(thread, *last_ins_p, node);
+  }
+  return npredecessors;
+}
+
+// __kmp_dep_kind: kind of a dependence, KMP_DEP_OUT for both out and inout
+static inline kmp_uint8 __kmp_dep_kind(const kmp_depend_info_t *dep) {
+  if (dep->flags.mtx)
+    return KMP_DEP_MTX;
+  if (dep->flags.set)
+    return KMP_DEP_SET;
+  return dep->flags.out ? KMP_DEP_OUT : KMP_DEP_IN;
+}
+
+// __kmp_process_dep_entry: same as __kmp_process_dep_state for the dependence
+// hash entry of an address, which also tracks mutexinoutset and inoutset
+// dependences. Tasks of the same kind join the set in last_ins and only come
+// after last_out or the previous set; a task of another kind comes after the
+// whole set, which becomes the previous set of a new one.
+template <bool filter>
+static inline kmp_int32
+__kmp_process_dep_entry(kmp_int32 gtid, kmp_info_t *thread, kmp_depnode_t *node,
+                        kmp_dephash_entry_t *info, bool dep_barrier,
+                        kmp_uint8 kind, kmp_task_t *task) {
+  kmp_int32 npredecessors = 0;
+
+  if (kind == KMP_DEP_OUT || info->last_flag == 0 || info->last_flag == kind) {
+    npredecessors += __kmp_process_dep_state<filter>(
+        gtid, thread, node, &info->last_out, &info->last_ins, dep_barrier,
+        kind == KMP_DEP_OUT, task);
+    if (kind == KMP_DEP_OUT) {
+      // the set is gone, and its tasks came after the previous set
+      __kmp_depnode_list_free(thread, info->prev_set);
+      info->prev_set = NULL;
+      info->last_flag = 0;
+    } else {
+      for (kmp_depnode_list_t *p = info->prev_set; p; p = p->next)
+        npredecessors +=
+            __kmp_add_successor<filter>(gtid, thread, p->node, node, task);
+      if (dep_barrier) {
+        __kmp_depnode_list_free(thread, info->prev_set);
+        info->prev_set = NULL;
+      } else {
+        info->last_flag = kind;
+      }
+    }
+  } else {
+    for (kmp_depnode_list_t *p = info->last_ins; p; p = p->next)
+      npredecessors +=
+          __kmp_add_successor<filter>(gtid, thread, p->node, node, task);
+    __kmp_node_deref(thread, info->last_out);
+    info->last_out = NULL;
+    __kmp_depnode_list_free(thread, info->prev_set);
+    if (dep_barrier) {
+      // the set is complete once we are done waiting
+      __kmp_depnode_list_free(thread, info->last_ins);
+      info->prev_set = NULL;
+      info->last_flag = 0;
+    } else {
+      info->prev_set = info->last_ins;
+      info->last_flag = kind;
+    }
+    info->last_ins =
+        dep_barrier ? NULL : __kmp_add_own_node(thread, NULL, node);
+  }
+  return npredecessors;
+}
+
+// Interval index of array section dependences. Every dependence hash keeps a
+// sorted array of disjoint segments, each with the state of an exact address
+// entry. A section is matched by splitting the segments at its bounds and
+// processing the ones it covers; the uncovered parts get new segments.
+
+// __kmp_dep_ranges_insert: make room for a segment at index i of h->ranges
+static kmp_dep_range_t *__kmp_dep_ranges_insert(kmp_info_t *thread,
+                                                kmp_dephash_t *h, kmp_uint32 i,
+                                                kmp_intptr_t start,
+                                                kmp_intptr_t end) {
+  if (h->nranges == h->ranges_size) {
+    kmp_uint32 new_size = h->ranges_size ? 2 * h->ranges_size : 16;
+    kmp_dep_range_t *new_ranges;
+#if USE_FAST_MEMORY
+    new_ranges = (kmp_dep_range_t *)__kmp_fast_allocate(
+        thread, new_size * sizeof(kmp_dep_range_t));
+#else
+    new_ranges = (kmp_dep_range_t *)__kmp_thread_malloc(
+        thread, new_size * sizeof(kmp_dep_range_t));
+#endif
+    if (h->ranges) {
+      KMP_MEMCPY(new_ranges, h->ranges, h->nranges * sizeof(kmp_dep_range_t));
+#if USE_FAST_MEMORY
+      __kmp_fast_free(thread, h->ranges);
+#else
+      __kmp_thread_free(thread, h->ranges);
+#endif
+    }
+    h->ranges = new_ranges;
+    h->ranges_size = new_size;
+  }
+  memmove(&h->ranges[i + 1], &h->ranges[i],
+          (h->nranges - i) * sizeof(kmp_dep_range_t));
+  h->nranges++;
+
+  kmp_dep_range_t *range = &h->ranges[i];
+  range->start = start;
+  range->end = end;
+  range->last_out = NULL;
+  range->last_ins = NULL;
+  return range;
+}
+
+// __kmp_dep_ranges_split: split segment i of h->ranges at addr; both halves
+// keep the dependence state of the segment
+static void __kmp_dep_ranges_split(kmp_info_t *thread, kmp_dephash_t *h,
+                                   kmp_uint32 i, kmp_intptr_t addr) {
+  KMP_DEBUG_ASSERT(h->ranges[i].start < addr && addr < h->ranges[i].end);
+  kmp_dep_range_t *upper =
+      __kmp_dep_ranges_insert(thread, h, i + 1, addr, h->ranges[i].end);
+  kmp_dep_range_t *lower = &h->ranges[i];
+  lower->end = addr;
+  if (lower->last_out)
+    upper->last_out = __kmp_node_ref(lower->last_out);
+  for (kmp_depnode_list_t *p = lower->last_ins; p; p = p->next)
+    upper->last_ins = __kmp_add_node(thread, upper->last_ins, p->node);
+}
+
+// __kmp_dep_ranges_free: drop the dependence state of all segments
+static void __kmp_dep_ranges_free(kmp_info_t *thread, kmp_dephash_t *h) {
+  for (kmp_uint32 i = 0; i < h->nranges; i++) {
+    __kmp_depnode_list_free(thread, h->ranges[i].last_ins);
+    __kmp_node_deref(thread, h->ranges[i].last_out);
+  }
+  h->nranges = 0;
+}
+
+// __kmp_process_dep_range: process the dependence on the bytes
+// [start, start + len) for node. Returns the number of predecessors found.
+template <bool filter>
+static kmp_int32 __kmp_process_dep_range(kmp_int32 gtid, kmp_info_t *thread,
+                                         kmp_depnode_t *node, kmp_dephash_t *h,
+                                         const kmp_depend_info_t *dep,
+                                         bool dep_barrier, kmp_task_t *task) {
+  kmp_intptr_t start = dep->base_addr;
+  kmp_intptr_t end = start + dep->len;
+  // segments do not track sets, so mutexinoutset and inoutset work as inout
+  bool out = dep->flags.out || dep->flags.mtx || dep->flags.set;
+  kmp_intptr_t pos = start;
+  kmp_uint32 lo = 0, hi = h->nranges, i, first;
+  kmp_int32 npredecessors = 0;
+
+  // find the first segment that ends after start
+  while (lo < hi) {
+    kmp_uint32 mid = lo + (hi - lo) / 2;
+    if (h->ranges[mid].end <= start)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  i = lo;
+  if (i < h->nranges && h->ranges[i].start < start) {
+    __kmp_dep_ranges_split(thread, h, i, start);
+    i++;
+  }
+  first = i;
+
+  while (pos < end) {
+    if (i < h->nranges && h->ranges[i].start <= pos) {
+      KMP_DEBUG_ASSERT(h->ranges[i].start == pos);
+      if (h->ranges[i].end > end)
+        __kmp_dep_ranges_split(thread, h, i, end);
+    } else {
+      kmp_intptr_t gap_end = end;
+      if (i < h->nranges && h->ranges[i].start < end)
+        gap_end = h->ranges[i].start;
+      if (dep_barrier) { // nothing to wait for and nothing to record
+        pos = gap_end;
+        continue;
+      }
+      __kmp_dep_ranges_insert(thread, h, i, pos, gap_end);
+    }
+    npredecessors += __kmp_process_dep_state<filter>(
+        gtid, thread, node, &h->ranges[i].last_out, &h->ranges[i].last_ins,
+        dep_barrier, out, task);
+    pos = h->ranges[i].end;
+    i++;
+  }
+
+  if (out && !dep_barrier && i - first > 1) {
+    // all the segments now only hold node as last output; merge them
+    for (kmp_uint32 j = first + 1; j < i; j++) {
+      KMP_DEBUG_ASSERT(h->ranges[j].last_out == node &&
+                       h->ranges[j].last_ins == NULL);
+      __kmp_node_deref(thread, node);
+    }
+    h->ranges[first].end = end;
+    memmove(&h->ranges[first + 1], &h->ranges[i],
+            (h->nranges - i) * sizeof(kmp_dep_range_t));
+    h->nranges -= i - first - 1;
+  }
+
+  KA_TRACE(40, ("__kmp_process_deps<%d>: T#%d range [%p, %p) found %d "
+                "predecessors, %d segments in index\n",
+                filter, gtid, (void *)start, (void *)end, npredecessors,
+                (int)h->nranges));
+  return npredecessors;
+}
+
 template <bool filter>
 static inline kmp_int32
 __kmp_process_deps(kmp_int32 gtid, kmp_depnode_t *node, kmp_dephash_t *hash,
@@ -250,67 +1142,29 @@ __kmp_process_deps(kmp_int32 gtid, kmp_depnode_t *node, kmp_dephash_t *hash,
   for (kmp_int32 i = 0; i < ndeps; i++) {
     const kmp_depend_info_t *dep = &dep_list[i];
 
-    KMP_DEBUG_ASSERT(dep->flags.in);
+    KMP_DEBUG_ASSERT(dep->flags.in || dep->flags.mtx || dep->flags.set);
 
     if (filter && dep->base_addr == 0)
       continue; // skip filtered entries
 
-    kmp_dephash_entry_t *info =
-        __kmp_dephash_find(thread, hash, dep->base_addr);
-    kmp_depnode_t *last_out = info->last_out;
-
-    if (dep->flags.out && info->last_ins) {
-      for (kmp_depnode_list_t *p = info->last_ins; p; p = p->next) {
-        kmp_depnode_t *indep = p->node;
-        if (indep->dn.task) {
-          KMP_ACQUIRE_DEPNODE(gtid, indep);
-          if (indep->dn.task) {
-            __kmp_track_dependence(indep, node, task);
-            indep->dn.successors =
-                __kmp_add_node(thread, indep->dn.successors, node);
-            KA_TRACE(40, ("__kmp_process_deps<%d>: T#%d adding dependence from "
-                          "%p to %p\n",
-                          filter, gtid, KMP_TASK_TO_TASKDATA(indep->dn.task),
-                          KMP_TASK_TO_TASKDATA(task)));
-            npredecessors++;
-          }
-          KMP_RELEASE_DEPNODE(gtid, indep);
-        }
-      }
-
-      __kmp_depnode_list_free(thread, info->last_ins);
-      info->last_ins = NULL;
-
-    } else if (last_out && last_out->dn.task) {
-      KMP_ACQUIRE_DEPNODE(gtid, last_out);
-      if (last_out->dn.task) {
-        __kmp_track_dependence(last_out, node, task);
-        last_out->dn.successors =
-            __kmp_add_node(thread, last_out->dn.successors, node);
-        KA_TRACE(
-            40,
-            ("__kmp_process_deps<%d>: T#%d adding dependence from %p to %p\n",
-             filter, gtid, KMP_TASK_TO_TASKDATA(last_out->dn.task),
-             KMP_TASK_TO_TASKDATA(task)));
-
-        npredecessors++;
-      }
-      KMP_RELEASE_DEPNODE(gtid, last_out);
+    if (__kmp_task_range_deps && dep->len > 0) {
+      npredecessors += __kmp_process_dep_range<filter>(
+          gtid, thread, node, hash, dep, dep_barrier, task);
+      continue;
     }
 
+    kmp_dephash_entry_t *info =
+        __kmp_dephash_find(thread, hash, dep->base_addr);
+    kmp_uint8 kind = __kmp_dep_kind(dep);
     if (dep_barrier) {
-      // if this is a sync point in the serial sequence, then the previous
-      // outputs are guaranteed to be completed after
-      // the execution of this task so the previous output nodes can be cleared.
-      __kmp_node_deref(thread, last_out);
-      info->last_out = NULL;
-    } else {
-      if (dep->flags.out) {
-        __kmp_node_deref(thread, last_out);
-        info->last_out = __kmp_node_ref(node);
-      } else
-        info->last_ins = __kmp_add_node(thread, info->last_ins, node);
+      // waiting for the whole set is the same as waiting for its tasks
+      if (kind != KMP_DEP_IN)
+        kind = KMP_DEP_OUT;
+    } else if (kind == KMP_DEP_MTX && !__kmp_add_mtx_dep(node, info)) {
+      kind = KMP_DEP_OUT;
     }
+    npredecessors += __kmp_process_dep_entry<filter>(
+        gtid, thread, node, info, dep_barrier, kind, task);
   }
 
   KA_TRACE(30, ("__kmp_process_deps<%d>: T#%d found %d predecessors\n", filter,
@@ -345,8 +1199,15 @@ static bool __kmp_check_deps(kmp_int32 gtid, kmp_depnode_t *node,
     if (dep_list[i].base_addr != 0)
       for (int j = i + 1; j < ndeps; j++)
         if (dep_list[i].base_addr == dep_list[j].base_addr) {
-          dep_list[i].flags.in |= dep_list[j].flags.in;
-          dep_list[i].flags.out |= dep_list[j].flags.out;
+          if (__kmp_dep_kind(&dep_list[i]) != __kmp_dep_kind(&dep_list[j])) {
+            // different kinds of dependences on one address work as inout
+            dep_list[i].flags.in = 1;
+            dep_list[i].flags.out = 1;
+            dep_list[i].flags.mtx = 0;
+            dep_list[i].flags.set = 0;
+          }
+          if (dep_list[j].len > dep_list[i].len)
+            dep_list[i].len = dep_list[j].len;
           dep_list[j].base_addr = 0; // Mark j element as void
         }
   }
@@ -366,6 +1227,7 @@ static bool __kmp_check_deps(kmp_int32 gtid, kmp_depnode_t *node,
   npredecessors += __kmp_process_deps<false>(
       gtid, node, hash, dep_barrier, ndeps_noalias, noalias_dep_list, task);
 
+  __kmp_node_ref_own_done(node);
   node->dn.task = task;
   KMP_MB();
 
@@ -386,6 +1248,47 @@ static bool __kmp_check_deps(kmp_int32 gtid, kmp_depnode_t *node,
   return npredecessors > 0 ? true : false;
 }
 
+// __kmp_schedule_successor: queue next, a successor of the finished task whose
+// dependences are all fulfilled now
+static inline void __kmp_schedule_successor(kmp_int32 gtid, kmp_info_t *thread,
+                                            kmp_taskdata_t *task,
+                                            kmp_taskdata_t *next) {
+  if (thread->th.th_task_continuation_src == task &&
+      thread->th.th_task_continuation == NULL
+#if OMP_45_ENABLED
+      && next->td_flags.proxy != TASK_PROXY
+#endif
+      ) {
+    // Keep the first ready successor for this thread to run next, it
+    // likely reads what the finished task wrote. Others stay stealable.
+    KA_TRACE(20, ("__kmp_schedule_successor: T#%d successor %p of %p kept to "
+                  "run next.\n",
+                  gtid, next, task));
+    thread->th.th_task_continuation = next;
+  } else {
+    KA_TRACE(20, ("__kmp_schedule_successor: T#%d successor %p of %p "
+                  "scheduled for execution.\n",
+                  gtid, next, task));
+    __kmp_omp_task(gtid, KMP_TASKDATA_TO_TASK(next), false);
+  }
+}
+
+// __kmp_tdg_release: release the successors of a task of a replayed graph
+static void __kmp_tdg_release(kmp_int32 gtid, kmp_info_t *thread,
+                              kmp_taskdata_t *task) {
+  kmp_tdg_t *tdg = task->td_tdg;
+  kmp_tdg_node_t *node = &tdg->nodes[task->td_tdg_index];
+  kmp_int32 *successors = tdg->edges + node->successors;
+
+  for (kmp_int32 i = 0; i < node->nsuccessors; i++) {
+    kmp_int32 s = successors[i];
+    if (KMP_ATOMIC_DEC(&tdg->npredecessors[s]) == 1)
+      __kmp_schedule_successor(gtid, thread, task, tdg->tasks[s]);
+  }
+  // last, as the region may end and replay again once this reaches 0
+  KMP_ATOMIC_DEC(&tdg->nremaining);
+}
+
 void __kmp_release_deps(kmp_int32 gtid, kmp_taskdata_t *task) {
   kmp_info_t *thread = __kmp_threads[gtid];
   kmp_depnode_t *node = task->td_depnode;
@@ -398,9 +1301,19 @@ void __kmp_release_deps(kmp_int32 gtid, kmp_taskdata_t *task) {
     task->td_dephash = NULL;
   }
 
+  if (UNLIKELY(task->td_tdg != NULL) &&
+      KMP_ATOMIC_LD_RLX(&task->td_tdg->status) == tdg_replaying) {
+    KMP_DEBUG_ASSERT(node == NULL);
+    __kmp_tdg_release(gtid, thread, task);
+    return;
+  }
+
   if (!node)
     return;
 
+  if (node->dn.mtx_num_locks != 0)
+    __kmp_release_mtx_deps(gtid, node);
+
   KA_TRACE(20, ("__kmp_release_deps: T#%d notifying successors of task %p.\n",
                 gtid, task));
 
@@ -418,25 +1331,21 @@ void __kmp_release_deps(kmp_int32 gtid, kmp_taskdata_t *task) {
     // being processed
     if (npredecessors == 0) {
       KMP_MB();
-      if (successor->dn.task) {
-        KA_TRACE(20, ("__kmp_release_deps: T#%d successor %p of %p scheduled "
-                      "for execution.\n",
-                      gtid, successor->dn.task, task));
-        __kmp_omp_task(gtid, successor->dn.task, false);
-      }
+      if (successor->dn.task)
+        __kmp_schedule_successor(gtid, thread, task,
+                                 KMP_TASK_TO_TASKDATA(successor->dn.task));
     }
 
     next = p->next;
     __kmp_node_deref(thread, p->node);
-#if USE_FAST_MEMORY
-    __kmp_fast_free(thread, p);
-#else
-    __kmp_thread_free(thread, p);
-#endif
+    __kmp_dep_pool_free(thread, dep_pool_list, p);
   }
 
   __kmp_node_deref(thread, node);
 
+  if (UNLIKELY(task->td_tdg != NULL)) // recording, or the replay stopped
+    KMP_ATOMIC_DEC(&task->td_tdg->nremaining);
+
   KA_TRACE(
       20,
       ("__kmp_release_deps: T#%d all successors of %p notified of completion\n",
@@ -507,7 +1416,9 @@ kmp_int32 __kmpc_omp_task_with_deps(ident_t *loc_ref, kmp_int32 gtid,
     for (i = 0; i < ndeps; i++) {
       new_taskdata->ompt_task_info.deps[i].variable_addr =
           (void *)dep_list[i].base_addr;
-      if (dep_list[i].flags.in && dep_list[i].flags.out)
+      // OMPT has no types for mutexinoutset and inoutset, report inout
+      if ((dep_list[i].flags.in && dep_list[i].flags.out) ||
+          dep_list[i].flags.mtx || dep_list[i].flags.set)
         new_taskdata->ompt_task_info.deps[i].dependence_flags =
             ompt_task_dependence_type_inout;
       else if (dep_list[i].flags.out)
@@ -520,7 +1431,8 @@ kmp_int32 __kmpc_omp_task_with_deps(ident_t *loc_ref, kmp_int32 gtid,
     for (i = 0; i < ndeps_noalias; i++) {
       new_taskdata->ompt_task_info.deps[ndeps + i].variable_addr =
           (void *)noalias_dep_list[i].base_addr;
-      if (noalias_dep_list[i].flags.in && noalias_dep_list[i].flags.out)
+      if ((noalias_dep_list[i].flags.in && noalias_dep_list[i].flags.out) ||
+          noalias_dep_list[i].flags.mtx || noalias_dep_list[i].flags.set)
         new_taskdata->ompt_task_info.deps[ndeps + i].dependence_flags =
             ompt_task_dependence_type_inout;
       else if (noalias_dep_list[i].flags.out)
@@ -551,20 +1463,38 @@ kmp_int32 __kmpc_omp_task_with_deps(ident_t *loc_ref, kmp_int32 gtid,
 #endif
 
   if (!serial && (ndeps > 0 || ndeps_noalias > 0)) {
+    kmp_tdg_t *tdg = current_task->td_tdg_region;
+    if (UNLIKELY(tdg != NULL) &&
+        KMP_ATOMIC_LD_RLX(&tdg->status) == tdg_replaying) {
+      kmp_int32 ret;
+      if (__kmp_tdg_replay_task(gtid, thread, current_task, tdg, loc_ref,
+                                new_task, ndeps, dep_list, ndeps_noalias,
+                                noalias_dep_list, &ret)) {
+        KA_TRACE(10, ("__kmpc_omp_task_with_deps(exit): T#%d task replayed "
+                      "from graph %d: loc=%p task=%p\n",
+                      gtid, tdg->id, loc_ref, new_taskdata));
+#if OMPT_SUPPORT
+        if (ompt_enabled.enabled) {
+          current_task->ompt_task_info.frame.enter_frame = NULL;
+        }
+#endif
+        return ret;
+      }
+      // the replay stopped, the task is tracked like the rest of the region
+    }
+
     /* if no dependencies have been tracked yet, create the dependence hash */
     if (current_task->td_dephash == NULL)
       current_task->td_dephash = __kmp_dephash_create(thread, current_task);
 
-#if USE_FAST_MEMORY
-    kmp_depnode_t *node =
-        (kmp_depnode_t *)__kmp_fast_allocate(thread, sizeof(kmp_depnode_t));
-#else
-    kmp_depnode_t *node =
-        (kmp_depnode_t *)__kmp_thread_malloc(thread, sizeof(kmp_depnode_t));
-#endif
+    kmp_depnode_t *node = (kmp_depnode_t *)__kmp_dep_pool_alloc(
+        thread, dep_pool_node, sizeof(kmp_depnode_t));
 
     __kmp_init_node(node);
     new_taskdata->td_depnode = node;
+    if (UNLIKELY(tdg != NULL))
+      __kmp_tdg_record_task(tdg, loc_ref, new_taskdata, node, ndeps, dep_list,
+                            ndeps_noalias, noalias_dep_list);
 
     if (__kmp_check_deps(gtid, node, new_task, current_task->td_dephash,
                          NO_DEP_BARRIER, ndeps, dep_list, ndeps_noalias,
@@ -627,6 +1557,18 @@ void __kmpc_omp_wait_deps(ident_t *loc_ref, kmp_int32 gtid, kmp_int32 ndeps,
   kmp_info_t *thread = __kmp_threads[gtid];
   kmp_taskdata_t *current_task = thread->th.th_current_task;
 
+  if (UNLIKELY(current_task->td_tdg_region != NULL)) {
+    kmp_tdg_t *tdg = current_task->td_tdg_region;
+    if (KMP_ATOMIC_LD_RLX(&tdg->status) == tdg_replaying) {
+      // the recording did not wait here
+      __kmp_tdg_stop_replay(gtid, thread, current_task, tdg);
+    } else {
+      // the wait is resolved against the graph recorded, which a replay
+      // could not do
+      tdg->replayable = false;
+    }
+  }
+
   // We can return immediately as:
   // - dependences are not computed in serial teams (except with proxy tasks)
   // - if the dephash is not yet created it means we have nothing to wait for
@@ -670,4 +1612,125 @@ void __kmpc_omp_wait_deps(ident_t *loc_ref, kmp_int32 gtid, kmp_int32 ndeps,
                 gtid, loc_ref));
 }
 
+/*!
+@ingroup TASKING
+@param loc_ref location of the region
+@param gtid Global Thread ID of encountering thread
+@param input_flags reserved, must be 0
+@param tdg_id identifier of the task graph of the region
+
+@return 1 if the tasks the region creates are recorded, 0 otherwise
+
+Start a region whose tasks with dependences form the same graph every time it
+runs. The first run records the graph; later runs skip the dependence
+processing of the tasks and use the recorded graph instead, as long as they
+create the same tasks in the same order. The tasks of the region only depend
+on each other, and __kmpc_end_record_task waits for all of them.
+*/
+kmp_int32 __kmpc_start_record_task(ident_t *loc_ref, kmp_int32 gtid,
+                                   kmp_int32 input_flags, kmp_int32 tdg_id) {
+  kmp_info_t *thread = __kmp_threads[gtid];
+  kmp_taskdata_t *current_task = thread->th.th_current_task;
+
+  KA_TRACE(10, ("__kmpc_start_record_task(enter): T#%d graph %d loc=%p\n",
+                gtid, tdg_id, loc_ref));
+
+  // dependences are not computed in serial teams, and regions do not nest
+  if (current_task->td_flags.team_serial ||
+      current_task->td_flags.tasking_ser || current_task->td_flags.final ||
+      current_task->td_tdg_region != NULL)
+    return 0;
+
+  kmp_tdg_t *tdg = __kmp_find_tdg(tdg_id);
+  kmp_int32 status = KMP_ATOMIC_LD_ACQ(&tdg->status);
+
+  if (status == tdg_ready &&
+      tdg->status.compare_exchange_strong(status, tdg_replaying)) {
+    for (kmp_int32 i = 0; i < tdg->nnodes; i++)
+      KMP_ATOMIC_ST_RLX(&tdg->npredecessors[i],
+                        tdg->nodes[i].npredecessors + 1);
+    tdg->next = 0;
+    current_task->td_tdg_region = tdg;
+    KA_TRACE(10, ("__kmpc_start_record_task(exit): T#%d replaying graph %d\n",
+                  gtid, tdg_id));
+    return 0;
+  }
+  if (status == tdg_empty &&
+      tdg->status.compare_exchange_strong(status, tdg_recording)) {
+    tdg->replayable = true;
+    tdg->nnodes = 0;
+    tdg->ndeps = 0;
+    tdg->nedges = 0;
+    if (tdg->edges) { // successor lists of an earlier recording
+      __kmp_free(tdg->edges);
+      tdg->edges = NULL;
+      tdg->edges_size = 0;
+    }
+    // record with a dependence hash of the region's own
+    tdg->saved_dephash = current_task->td_dephash;
+    current_task->td_dephash = NULL;
+    current_task->td_tdg_region = tdg;
+    KA_TRACE(10, ("__kmpc_start_record_task(exit): T#%d recording graph %d\n",
+                  gtid, tdg_id));
+    return 1;
+  }
+  // the graph cannot replay, or another region is using it
+  KA_TRACE(10, ("__kmpc_start_record_task(exit): T#%d graph %d not used\n",
+                gtid, tdg_id));
+  return 0;
+}
+
+/*!
+@ingroup TASKING
+@param loc_ref location of the region
+@param gtid Global Thread ID of encountering thread
+@param input_flags reserved, must be 0
+@param tdg_id identifier of the task graph of the region
+
+End a region started by __kmpc_start_record_task, waiting for the tasks with
+dependences it created.
+*/
+void __kmpc_end_record_task(ident_t *loc_ref, kmp_int32 gtid,
+                            kmp_int32 input_flags, kmp_int32 tdg_id) {
+  kmp_info_t *thread = __kmp_threads[gtid];
+  kmp_taskdata_t *current_task = thread->th.th_current_task;
+  kmp_tdg_t *tdg = current_task->td_tdg_region;
+
+  KA_TRACE(10, ("__kmpc_end_record_task(enter): T#%d graph %d loc=%p\n", gtid,
+                tdg_id, loc_ref));
+
+  if (tdg == NULL || tdg->id != tdg_id)
+    return; // the region ran without a graph
+
+  __kmp_tdg_wait(gtid, thread, tdg);
+  current_task->td_tdg_region = NULL;
+
+  kmp_int32 status = KMP_ATOMIC_LD_RLX(&tdg->status);
+  if (status == tdg_recording || status == tdg_diverged) {
+    if (current_task->td_dephash)
+      __kmp_dephash_free(thread, current_task->td_dephash);
+    current_task->td_dephash = tdg->saved_dephash;
+    tdg->saved_dephash = NULL;
+    if (status == tdg_diverged) {
+      KMP_ATOMIC_ST_REL(&tdg->status, tdg_empty);
+    } else if (!tdg->replayable) {
+      KMP_ATOMIC_ST_REL(&tdg->status, tdg_disabled);
+    } else if (tdg->nnodes == 0) {
+      KMP_ATOMIC_ST_REL(&tdg->status, tdg_empty);
+    } else {
+      __kmp_tdg_finalize(tdg);
+      KMP_ATOMIC_ST_REL(&tdg->status, tdg_ready);
+    }
+  } else if (tdg->next == tdg->nnodes) {
+    KMP_ATOMIC_ST_REL(&tdg->status, tdg_ready);
+  } else {
+    // fewer tasks than recorded, record again next time
+    __kmp_tdg_free_replay_data(tdg);
+    KMP_ATOMIC_ST_REL(&tdg->status, tdg_empty);
+  }
+
+  KA_TRACE(10, ("__kmpc_end_record_task(exit): T#%d graph %d status %d\n",
+                gtid, tdg_id, (int)KMP_ATOMIC_LD_RLX(&tdg->status)));
+}
+
 #endif /* OMP_40_ENABLED */
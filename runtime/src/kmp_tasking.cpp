@@ -28,6 +28,8 @@ static void __kmp_enable_tasking(kmp_task_team_t *task_team,
                                  kmp_info_t *this_thr);
 static void __kmp_alloc_task_deque(kmp_info_t *thread,
                                    kmp_thread_data_t *thread_data);
+static void __kmp_realloc_task_deque(kmp_info_t *thread,
+                                     kmp_thread_data_t *thread_data);
 static int __kmp_realloc_task_threads_data(kmp_info_t *thread,
                                            kmp_task_team_t *task_team);
 
@@ -250,6 +252,355 @@ static void __kmp_pop_task_stack(kmp_int32 gtid, kmp_info_t *thread,
 }
 #endif /* BUILD_TIED_TASK_STACK */
 
+// __kmp_task_has_mutexinoutset: check if the locks of the mutexinoutset
+// dependences of taskdata still have to be taken before it runs
+static inline bool
+__kmp_task_has_mutexinoutset(const kmp_taskdata_t *taskdata) {
+#if OMP_40_ENABLED
+  kmp_depnode_t *node = taskdata->td_depnode;
+  return UNLIKELY(node != NULL && node->dn.mtx_num_locks > 0);
+#else
+  return false;
+#endif
+}
+
+// __kmp_task_acquire_mutexinoutset: try to take the locks of the
+// mutexinoutset dependences of taskdata once it has been taken to be executed.
+// Fails holding none of them if one is busy, the caller then queues the task
+// again.
+static inline bool __kmp_task_acquire_mutexinoutset(kmp_int32 gtid,
+                                                    kmp_taskdata_t *taskdata) {
+#if OMP_40_ENABLED
+  if (__kmp_task_has_mutexinoutset(taskdata))
+    return __kmp_acquire_mtx_deps(gtid, taskdata->td_depnode);
+#endif
+  return true;
+}
+
+// __kmp_task_is_allowed: check if the task scheduling constraint (TSC) allows
+// the calling thread to execute taskdata now. Only descendants of all deferred
+// tied tasks can be scheduled; checking the last one is enough, as it in turn
+// is the descendant of all others.
+static bool __kmp_task_is_allowed(kmp_int32 gtid, kmp_int32 is_constrained,
+                                  const kmp_taskdata_t *taskdata) {
+  if (is_constrained && taskdata->td_flags.tiedness == TASK_TIED) {
+    const kmp_taskdata_t *current =
+        __kmp_threads[gtid]->th.th_current_task->td_last_tied;
+    KMP_DEBUG_ASSERT(current != NULL);
+    // check if last tied task is not suspended on barrier
+    if (current->td_flags.tasktype == TASK_EXPLICIT ||
+        current->td_taskwait_thread > 0) { // <= 0 on barrier
+      kmp_int32 level = current->td_level;
+      const kmp_taskdata_t *parent = taskdata->td_parent;
+      while (parent != current && parent->td_level > level) {
+        // check generation up to the level of the current task
+        parent = parent->td_parent;
+        KMP_DEBUG_ASSERT(parent != NULL);
+      }
+      if (parent != current)
+        return false;
+    }
+  }
+  return true;
+}
+
+// Lock-free task deque, after Chase & Lev, "Dynamic Circular Work-Stealing
+// Deque" (SPAA 2005), with the memory orderings of Le et al., "Correct and
+// Efficient Work-Stealing for Weak Memory Models" (PPoPP 2013). Only the owner
+// touches td_cl_bottom and replaces td_cl_array; a task is taken from the top
+// end only by a successful CAS on td_cl_top.
+
+// __kmp_alloc_task_cl_array: allocate an array of size slots
+static kmp_task_cl_array_t *__kmp_alloc_task_cl_array(kmp_int64 size) {
+  kmp_task_cl_array_t *array = (kmp_task_cl_array_t *)__kmp_allocate(
+      sizeof(kmp_task_cl_array_t) +
+      (size - 1) * sizeof(std::atomic<kmp_taskdata_t *>));
+  array->cla_size = size;
+  return array;
+}
+
+// __kmp_task_cl_ntasks: number of tasks in the lock-free deque. The value is
+// only a snapshot, so it is used as a hint, the same as td_deque_ntasks.
+static inline kmp_int32 __kmp_task_cl_ntasks(kmp_thread_data_t *thread_data) {
+  kmp_int64 size = KMP_ATOMIC_LD_RLX(&thread_data->td.td_cl_bottom) -
+                   KMP_ATOMIC_LD_RLX(&thread_data->td.td_cl_top);
+  return size > 0 ? (kmp_int32)size : 0;
+}
+
+// __kmp_task_deque_ntasks: number of tasks queued on a thread in either deque
+static inline kmp_int32
+__kmp_task_deque_ntasks(kmp_thread_data_t *thread_data) {
+  kmp_int32 ntasks = TCR_4(thread_data->td.td_deque_ntasks);
+  if (__kmp_task_deque_lockfree)
+    ntasks += __kmp_task_cl_ntasks(thread_data);
+  return ntasks;
+}
+
+// __kmp_realloc_task_cl_array: double the size of the owner's lock-free
+// deque. Like __kmp_realloc_task_deque, the live tasks keep their order; they
+// also keep their logical indices so concurrent thieves are not disturbed.
+static kmp_task_cl_array_t *
+__kmp_realloc_task_cl_array(kmp_info_t *thread, kmp_thread_data_t *thread_data,
+                            kmp_task_cl_array_t *array, kmp_int64 top,
+                            kmp_int64 bottom) {
+  kmp_int64 size = array->cla_size;
+  kmp_task_cl_array_t *new_array = __kmp_alloc_task_cl_array(2 * size);
+
+  KE_TRACE(10, ("__kmp_realloc_task_cl_array: T#%d reallocating lock-free "
+                "deque[from %d to %d] for thread_data %p\n",
+                __kmp_gtid_from_thread(thread), (int)size, (int)(2 * size),
+                thread_data));
+
+  for (kmp_int64 i = top; i < bottom; ++i)
+    KMP_ATOMIC_ST_RLX(&new_array->cla_tasks[i & (2 * size - 1)],
+                      KMP_ATOMIC_LD_RLX(&array->cla_tasks[i & (size - 1)]));
+  new_array->cla_retired = array;
+  KMP_ATOMIC_ST_REL(&thread_data->td.td_cl_array, new_array);
+  return new_array;
+}
+
+// __kmp_free_retired_task_cl_arrays: free the arrays the lock-free deques of
+// task_team have replaced. No thread may be stealing from task_team.
+static void __kmp_free_retired_task_cl_arrays(kmp_task_team_t *task_team) {
+  kmp_thread_data_t *threads_data = task_team->tt.tt_threads_data;
+  if (threads_data == NULL)
+    return;
+  for (kmp_int32 i = 0; i < task_team->tt.tt_max_threads; i++) {
+    kmp_task_cl_array_t *array =
+        KMP_ATOMIC_LD_RLX(&threads_data[i].td.td_cl_array);
+    if (array == NULL)
+      continue;
+    kmp_task_cl_array_t *retired = array->cla_retired;
+    array->cla_retired = NULL;
+    while (retired != NULL) {
+      KE_TRACE(10, ("__kmp_free_retired_task_cl_arrays: freeing lock-free "
+                    "deque[%d] of task_team %p\n",
+                    (int)retired->cla_size, task_team));
+      array = retired->cla_retired;
+      __kmp_free(retired);
+      retired = array;
+    }
+  }
+}
+
+// __kmp_task_cl_push: owner pushes taskdata at the bottom of its deque. Like
+// the locked deque, a full deque only grows past MAX_TASK_CL_DEQUE_SIZE for a
+// task with mutexinoutset locks to take; other tasks are not pushed and the
+// caller executes them immediately.
+static kmp_int32 __kmp_task_cl_push(kmp_info_t *thread,
+                                    kmp_thread_data_t *thread_data,
+                                    kmp_taskdata_t *taskdata) {
+  kmp_int64 bottom = KMP_ATOMIC_LD_RLX(&thread_data->td.td_cl_bottom);
+  kmp_int64 top = KMP_ATOMIC_LD_ACQ(&thread_data->td.td_cl_top);
+  kmp_task_cl_array_t *array = KMP_ATOMIC_LD_RLX(&thread_data->td.td_cl_array);
+
+  if (bottom - top >= array->cla_size) {
+    if (array->cla_size >= MAX_TASK_CL_DEQUE_SIZE &&
+        !__kmp_task_has_mutexinoutset(taskdata))
+      return TASK_NOT_PUSHED;
+    array = __kmp_realloc_task_cl_array(thread, thread_data, array, top,
+                                        bottom);
+  }
+  KMP_ATOMIC_ST_RLX(&array->cla_tasks[bottom & (array->cla_size - 1)],
+                    taskdata);
+  std::atomic_thread_fence(std::memory_order_release);
+  KMP_ATOMIC_ST_RLX(&thread_data->td.td_cl_bottom, bottom + 1);
+  return TASK_SUCCESSFULLY_PUSHED;
+}
+
+// __kmp_task_cl_pop: owner takes the task at the bottom of its deque
+static kmp_taskdata_t *__kmp_task_cl_pop(kmp_info_t *thread, kmp_int32 gtid,
+                                         kmp_thread_data_t *thread_data,
+                                         kmp_int32 is_constrained) {
+  kmp_taskdata_t *taskdata;
+  kmp_int64 bottom = KMP_ATOMIC_LD_RLX(&thread_data->td.td_cl_bottom) - 1;
+  kmp_task_cl_array_t *array = KMP_ATOMIC_LD_RLX(&thread_data->td.td_cl_array);
+
+  KMP_ATOMIC_ST_RLX(&thread_data->td.td_cl_bottom, bottom);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  kmp_int64 top = KMP_ATOMIC_LD_RLX(&thread_data->td.td_cl_top);
+
+  if (top > bottom) { // deque was empty
+    KMP_ATOMIC_ST_RLX(&thread_data->td.td_cl_bottom, bottom + 1);
+    return NULL;
+  }
+  taskdata =
+      KMP_ATOMIC_LD_RLX(&array->cla_tasks[bottom & (array->cla_size - 1)]);
+  if (top == bottom) {
+    // Last task: race against thieves for it
+    if (!thread_data->td.td_cl_top.compare_exchange_strong(
+            top, top + 1, std::memory_order_seq_cst,
+            std::memory_order_relaxed))
+      taskdata = NULL; // a thief won
+    KMP_ATOMIC_ST_RLX(&thread_data->td.td_cl_bottom, bottom + 1);
+  }
+  if (taskdata != NULL && !__kmp_task_is_allowed(gtid, is_constrained,
+                                                 taskdata)) {
+    // The TSC does not allow to execute the task; put it back where it was.
+    // The task can only be inspected once it is ours, since a thief may
+    // otherwise run and free it concurrently. Its slot is still free.
+    __kmp_task_cl_push(thread, thread_data, taskdata);
+    taskdata = NULL;
+  }
+  return taskdata;
+}
+
+// __kmp_task_cl_steal: take the task at the top of victim's lock-free deque
+static kmp_taskdata_t *
+__kmp_task_cl_steal(kmp_int32 gtid, kmp_task_team_t *task_team,
+                    kmp_thread_data_t *victim_td,
+                    std::atomic<kmp_int32> *unfinished_threads,
+                    int *thread_finished, kmp_int32 is_constrained) {
+  kmp_taskdata_t *taskdata;
+  kmp_int64 top = KMP_ATOMIC_LD_ACQ(&victim_td->td.td_cl_top);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  kmp_int64 bottom = KMP_ATOMIC_LD_ACQ(&victim_td->td.td_cl_bottom);
+
+  if (top >= bottom)
+    return NULL;
+
+  kmp_task_cl_array_t *array = KMP_ATOMIC_LD_ACQ(&victim_td->td.td_cl_array);
+  taskdata = KMP_ATOMIC_LD_RLX(&array->cla_tasks[top & (array->cla_size - 1)]);
+
+  // A finished thread must be marked unfinished before the task leaves the
+  // victim's deque, or else other threads might be prematurely released from
+  // the barrier. Undo the increment if the steal fails.
+  if (*thread_finished)
+    KMP_ATOMIC_INC(unfinished_threads);
+  if (!victim_td->td.td_cl_top.compare_exchange_strong(
+          top, top + 1, std::memory_order_seq_cst,
+          std::memory_order_relaxed)) {
+    if (*thread_finished)
+      KMP_ATOMIC_DEC(unfinished_threads);
+    return NULL;
+  }
+  if (*thread_finished) {
+    KA_TRACE(20, ("__kmp_task_cl_steal: T#%d inc unfinished_threads: "
+                  "task_team=%p\n",
+                  gtid, task_team));
+    *thread_finished = FALSE;
+  }
+
+  if (!__kmp_task_is_allowed(gtid, is_constrained, taskdata)) {
+    // The TSC does not allow to execute the stolen task. Only the victim
+    // pushes to its lock-free deque, so return the task to the victim's locked
+    // deque. The tasks returned there are older than those left in the
+    // lock-free one, so the victim still sees them in the order it created
+    // them, which its own TSC check relies on.
+    __kmp_acquire_bootstrap_lock(&victim_td->td.td_deque_lock);
+    if (TCR_4(victim_td->td.td_deque_ntasks) >=
+        TASK_DEQUE_SIZE(victim_td->td)) {
+      __kmp_realloc_task_deque(victim_td->td.td_thr, victim_td);
+    }
+    victim_td->td.td_deque[victim_td->td.td_deque_tail] = taskdata;
+    victim_td->td.td_deque_tail =
+        (victim_td->td.td_deque_tail + 1) & TASK_DEQUE_MASK(victim_td->td);
+    TCW_4(victim_td->td.td_deque_ntasks,
+          TCR_4(victim_td->td.td_deque_ntasks) + 1);
+    __kmp_release_bootstrap_lock(&victim_td->td.td_deque_lock);
+    KA_TRACE(20, ("__kmp_task_cl_steal: T#%d returned task %p to T#%d\n", gtid,
+                  taskdata, __kmp_gtid_from_thread(victim_td->td.td_thr)));
+    return NULL;
+  }
+  return taskdata;
+}
+
+#if OMP_45_ENABLED
+// __kmp_alloc_task_pri_list: allocate a deque for tasks of one priority
+static kmp_task_pri_t *__kmp_alloc_task_pri_list(kmp_int32 pri) {
+  kmp_task_pri_t *l = (kmp_task_pri_t *)__kmp_allocate(sizeof(kmp_task_pri_t));
+  kmp_thread_data_t *thread_data = &l->td;
+  __kmp_init_bootstrap_lock(&thread_data->td.td_deque_lock);
+  thread_data->td.td_deque_last_stolen = -1;
+  KE_TRACE(20, ("__kmp_alloc_task_pri_list: allocating deque[%d] for priority "
+                "%d\n",
+                INITIAL_TASK_DEQUE_SIZE, pri));
+  thread_data->td.td_deque = (kmp_taskdata_t **)__kmp_allocate(
+      INITIAL_TASK_DEQUE_SIZE * sizeof(kmp_taskdata_t *));
+  thread_data->td.td_deque_size = INITIAL_TASK_DEQUE_SIZE;
+  l->priority = pri;
+  return l;
+}
+
+// __kmp_get_priority_deque_data: find the deque for tasks of priority pri in
+// the task team's sorted list, inserting a new one if there is none yet.
+// Must be called with tt_task_pri_lock held.
+static kmp_thread_data_t *
+__kmp_get_priority_deque_data(kmp_task_team_t *task_team, kmp_int32 pri) {
+  kmp_task_pri_t *lst = task_team->tt.tt_task_pri_list;
+  kmp_task_pri_t *list;
+
+  if (lst == NULL || lst->priority < pri) {
+    // All current deques hold tasks with lower priority; new list head
+    list = __kmp_alloc_task_pri_list(pri);
+    list->next = lst;
+    // Readers walk the list without the lock; publish a complete node
+    KMP_MB();
+    TCW_PTR(task_team->tt.tt_task_pri_list, list);
+    return &list->td;
+  }
+  while (lst->priority > pri && lst->next != NULL &&
+         lst->next->priority >= pri)
+    lst = lst->next;
+  if (lst->priority == pri)
+    return &lst->td;
+  // lst->priority > pri && (lst->next == NULL || pri > lst->next->priority)
+  list = __kmp_alloc_task_pri_list(pri);
+  list->next = lst->next;
+  KMP_MB();
+  TCW_PTR(lst->next, list);
+  return &list->td;
+}
+
+// __kmp_push_priority_task: add a task with a non-zero priority to the task
+// team's deque for that priority. Unlike the per-thread deques, priority
+// deques grow when full so that the priority is not lost by executing the
+// task immediately.
+static kmp_int32 __kmp_push_priority_task(kmp_int32 gtid, kmp_info_t *thread,
+                                          kmp_taskdata_t *taskdata,
+                                          kmp_task_team_t *task_team,
+                                          kmp_int32 pri) {
+  kmp_thread_data_t *thread_data;
+  kmp_task_pri_t *lst = (kmp_task_pri_t *)TCR_PTR(task_team->tt.tt_task_pri_list);
+
+  KA_TRACE(20, ("__kmp_push_priority_task: T#%d trying to push task %p, "
+                "pri %d.\n",
+                gtid, taskdata, pri));
+
+  if (lst != NULL && lst->priority == pri) {
+    // Fast path: tasks of the highest priority in use
+    thread_data = &lst->td;
+  } else {
+    __kmp_acquire_bootstrap_lock(&task_team->tt.tt_task_pri_lock);
+    thread_data = __kmp_get_priority_deque_data(task_team, pri);
+    __kmp_release_bootstrap_lock(&task_team->tt.tt_task_pri_lock);
+  }
+  KMP_DEBUG_ASSERT(thread_data != NULL);
+
+  __kmp_acquire_bootstrap_lock(&thread_data->td.td_deque_lock);
+  if (TCR_4(thread_data->td.td_deque_ntasks) >=
+      TASK_DEQUE_SIZE(thread_data->td)) {
+    __kmp_realloc_task_deque(thread, thread_data);
+  }
+  thread_data->td.td_deque[thread_data->td.td_deque_tail] =
+      taskdata; // Push taskdata
+  // Wrap index.
+  thread_data->td.td_deque_tail =
+      (thread_data->td.td_deque_tail + 1) & TASK_DEQUE_MASK(thread_data->td);
+  TCW_4(thread_data->td.td_deque_ntasks,
+        TCR_4(thread_data->td.td_deque_ntasks) + 1); // Adjust task count
+  __kmp_release_bootstrap_lock(&thread_data->td.td_deque_lock);
+
+  // Make the task visible to __kmp_get_priority_task only once it is queued
+  KMP_ATOMIC_INC(&task_team->tt.tt_num_task_pri);
+
+  KA_TRACE(20, ("__kmp_push_priority_task: T#%d returning "
+                "TASK_SUCCESSFULLY_PUSHED: task=%p pri=%d\n",
+                gtid, taskdata, pri));
+  return TASK_SUCCESSFULLY_PUSHED;
+}
+#endif // OMP_45_ENABLED
+
 //  __kmp_push_task: Add a task to the thread's deque
 static kmp_int32 __kmp_push_task(kmp_int32 gtid, kmp_task_t *task) {
   kmp_info_t *thread = __kmp_threads[gtid];
@@ -288,6 +639,15 @@ static kmp_int32 __kmp_push_task(kmp_int32 gtid, kmp_task_t *task) {
   KMP_DEBUG_ASSERT(TCR_4(task_team->tt.tt_found_tasks) == TRUE);
   KMP_DEBUG_ASSERT(TCR_PTR(task_team->tt.tt_threads_data) != NULL);
 
+#if OMP_45_ENABLED
+  if (__kmp_max_task_priority > 0 && taskdata->td_flags.priority_specified &&
+      task->data2.priority > 0) {
+    // Priorities above max-task-priority-var are clamped to it
+    kmp_int32 pri = KMP_MIN(task->data2.priority, __kmp_max_task_priority);
+    return __kmp_push_priority_task(gtid, thread, taskdata, task_team, pri);
+  }
+#endif
+
   // Find tasking deque specific to encountering thread
   thread_data = &task_team->tt.tt_threads_data[tid];
 
@@ -296,9 +656,23 @@ static kmp_int32 __kmp_push_task(kmp_int32 gtid, kmp_task_t *task) {
     __kmp_alloc_task_deque(thread, thread_data);
   }
 
-  // Check if deque is full
-  if (TCR_4(thread_data->td.td_deque_ntasks) >=
-      TASK_DEQUE_SIZE(thread_data->td)) {
+  if (__kmp_task_deque_lockfree) {
+    // Only the owner pushes to the lock-free deque, which grows up to a limit
+    kmp_int32 result = __kmp_task_cl_push(thread, thread_data, taskdata);
+    KA_TRACE(20, ("__kmp_push_task: T#%d returning %s: task=%p (lock-free)\n",
+                  gtid,
+                  result == TASK_NOT_PUSHED ? "TASK_NOT_PUSHED"
+                                            : "TASK_SUCCESSFULLY_PUSHED",
+                  taskdata));
+    return result;
+  }
+
+  // Check if deque is full. A task with mutexinoutset locks to take is not
+  // executed immediately, since its locks can only be tried once it is taken
+  // from a deque; the deque grows instead.
+  bool must_queue = __kmp_task_has_mutexinoutset(taskdata);
+  if (!must_queue && TCR_4(thread_data->td.td_deque_ntasks) >=
+                         TASK_DEQUE_SIZE(thread_data->td)) {
     KA_TRACE(20, ("__kmp_push_task: T#%d deque is full; returning "
                   "TASK_NOT_PUSHED for task %p\n",
                   gtid, taskdata));
@@ -308,6 +682,11 @@ static kmp_int32 __kmp_push_task(kmp_int32 gtid, kmp_task_t *task) {
   // Lock the deque for the task push operation
   __kmp_acquire_bootstrap_lock(&thread_data->td.td_deque_lock);
 
+  if (must_queue && TCR_4(thread_data->td.td_deque_ntasks) >=
+                        TASK_DEQUE_SIZE(thread_data->td)) {
+    __kmp_realloc_task_deque(thread, thread_data);
+  }
+
 #if OMP_45_ENABLED
   // Need to recheck as we can get a proxy task from a thread outside of OpenMP
   if (TCR_4(thread_data->td.td_deque_ntasks) >=
@@ -939,8 +1318,11 @@ void __kmp_init_implicit_task(ident_t *loc_ref, kmp_info_t *this_thr,
 
 #if OMP_40_ENABLED
   task->td_depnode = NULL;
+  task->td_tdg_region = NULL;
+  task->td_tdg = NULL;
 #endif
   task->td_last_tied = task;
+  task->td_rw_reader = 0;
 
   if (set_curr_task) { // only do this init first time thread is created
     KMP_ATOMIC_ST_REL(&task->td_incomplete_child_tasks, 0);
@@ -1148,6 +1530,7 @@ kmp_task_t *__kmp_task_alloc(ident_t *loc_ref, kmp_int32 gtid,
 #endif // OMP_40_ENABLED
 #if OMP_45_ENABLED
   taskdata->td_flags.proxy = flags->proxy;
+  taskdata->td_flags.priority_specified = flags->priority_specified;
   taskdata->td_task_team = thread->th.th_task_team;
   taskdata->td_size_alloc = shareds_offset + sizeof_shareds;
 #endif
@@ -1182,11 +1565,14 @@ kmp_task_t *__kmp_task_alloc(ident_t *loc_ref, kmp_int32 gtid,
       parent_task->td_taskgroup; // task inherits taskgroup from the parent task
   taskdata->td_dephash = NULL;
   taskdata->td_depnode = NULL;
+  taskdata->td_tdg_region = NULL;
+  taskdata->td_tdg = NULL;
 #endif
   if (flags->tiedness == TASK_UNTIED)
     taskdata->td_last_tied = NULL; // will be set when the task is scheduled
   else
     taskdata->td_last_tied = taskdata;
+  taskdata->td_rw_reader = 0;
 
 // Only need to keep track of child task counts if team parallel and tasking not
 // serialized or if it is a proxy task
@@ -2127,6 +2513,18 @@ static kmp_task_t *__kmp_remove_my_task(kmp_info_t *thread, kmp_int32 gtid,
 
   thread_data = &task_team->tt.tt_threads_data[__kmp_tid_from_gtid(gtid)];
 
+  if (__kmp_task_deque_lockfree && thread_data->td.td_deque != NULL) {
+    taskdata = __kmp_task_cl_pop(thread, gtid, thread_data, is_constrained);
+    if (taskdata != NULL) {
+      KA_TRACE(10, ("__kmp_remove_my_task(exit #0): T#%d task %p removed "
+                    "from lock-free deque\n",
+                    gtid, taskdata));
+      return KMP_TASKDATA_TO_TASK(taskdata);
+    }
+    // Fall back to the locked deque, which holds tasks given to this thread
+    // by other threads
+  }
+
   KA_TRACE(10, ("__kmp_remove_my_task(enter): T#%d ntasks=%d head=%u tail=%u\n",
                 gtid, thread_data->td.td_deque_ntasks,
                 thread_data->td.td_deque_head, thread_data->td.td_deque_tail));
@@ -2156,33 +2554,15 @@ static kmp_task_t *__kmp_remove_my_task(kmp_info_t *thread, kmp_int32 gtid,
          TASK_DEQUE_MASK(thread_data->td); // Wrap index.
   taskdata = thread_data->td.td_deque[tail];
 
-  if (is_constrained && (taskdata->td_flags.tiedness == TASK_TIED)) {
-    // we need to check if the candidate obeys task scheduling constraint (TSC)
-    // only descendant of all deferred tied tasks can be scheduled, checking
-    // the last one is enough, as it in turn is the descendant of all others
-    kmp_taskdata_t *current = thread->th.th_current_task->td_last_tied;
-    KMP_DEBUG_ASSERT(current != NULL);
-    // check if last tied task is not suspended on barrier
-    if (current->td_flags.tasktype == TASK_EXPLICIT ||
-        current->td_taskwait_thread > 0) { // <= 0 on barrier
-      kmp_int32 level = current->td_level;
-      kmp_taskdata_t *parent = taskdata->td_parent;
-      while (parent != current && parent->td_level > level) {
-        parent = parent->td_parent; // check generation up to the level of the
-        // current task
-        KMP_DEBUG_ASSERT(parent != NULL);
-      }
-      if (parent != current) {
-        // The TSC does not allow to steal victim task
-        __kmp_release_bootstrap_lock(&thread_data->td.td_deque_lock);
-        KA_TRACE(10, ("__kmp_remove_my_task(exit #2): T#%d No tasks to remove: "
-                      "ntasks=%d head=%u tail=%u\n",
-                      gtid, thread_data->td.td_deque_ntasks,
-                      thread_data->td.td_deque_head,
-                      thread_data->td.td_deque_tail));
-        return NULL;
-      }
-    }
+  if (!__kmp_task_is_allowed(gtid, is_constrained, taskdata)) {
+    // The TSC does not allow to steal victim task
+    __kmp_release_bootstrap_lock(&thread_data->td.td_deque_lock);
+    KA_TRACE(10,
+             ("__kmp_remove_my_task(exit #2): T#%d No tasks to remove: "
+              "ntasks=%d head=%u tail=%u\n",
+              gtid, thread_data->td.td_deque_ntasks,
+              thread_data->td.td_deque_head, thread_data->td.td_deque_tail));
+    return NULL;
   }
 
   thread_data->td.td_deque_tail = tail;
@@ -2209,9 +2589,8 @@ static kmp_task_t *__kmp_steal_task(kmp_info_t *victim_thr, kmp_int32 gtid,
                                     kmp_int32 is_constrained) {
   kmp_task_t *task;
   kmp_taskdata_t *taskdata;
-  kmp_taskdata_t *current;
   kmp_thread_data_t *victim_td, *threads_data;
-  kmp_int32 level, target;
+  kmp_int32 target;
   kmp_int32 victim_tid;
 
   KMP_DEBUG_ASSERT(__kmp_tasking_mode != tskm_immediate_exec);
@@ -2228,6 +2607,20 @@ static kmp_task_t *__kmp_steal_task(kmp_info_t *victim_thr, kmp_int32 gtid,
                 victim_td->td.td_deque_ntasks, victim_td->td.td_deque_head,
                 victim_td->td.td_deque_tail));
 
+  if (__kmp_task_deque_lockfree) {
+    taskdata = __kmp_task_cl_steal(gtid, task_team, victim_td,
+                                   unfinished_threads, thread_finished,
+                                   is_constrained);
+    if (taskdata != NULL) {
+      KMP_COUNT_BLOCK(TASK_stolen);
+      KA_TRACE(10, ("__kmp_steal_task(exit #0): T#%d stole task %p from T#%d "
+                    "(lock-free): task_team=%p\n",
+                    gtid, taskdata, __kmp_gtid_from_thread(victim_thr),
+                    task_team));
+      return KMP_TASKDATA_TO_TASK(taskdata);
+    }
+  }
+
   if (TCR_4(victim_td->td.td_deque_ntasks) == 0) {
     KA_TRACE(10, ("__kmp_steal_task(exit #1): T#%d could not steal from T#%d: "
                   "task_team=%p ntasks=%d head=%u tail=%u\n",
@@ -2253,36 +2646,17 @@ static kmp_task_t *__kmp_steal_task(kmp_info_t *victim_thr, kmp_int32 gtid,
   KMP_DEBUG_ASSERT(victim_td->td.td_deque != NULL);
 
   taskdata = victim_td->td.td_deque[victim_td->td.td_deque_head];
-  if (is_constrained && (taskdata->td_flags.tiedness == TASK_TIED)) {
-    // we need to check if the candidate obeys task scheduling constraint (TSC)
-    // only descendant of all deferred tied tasks can be scheduled, checking
-    // the last one is enough, as it in turn is the descendant of all others
-    current = __kmp_threads[gtid]->th.th_current_task->td_last_tied;
-    KMP_DEBUG_ASSERT(current != NULL);
-    // check if last tied task is not suspended on barrier
-    if (current->td_flags.tasktype == TASK_EXPLICIT ||
-        current->td_taskwait_thread > 0) { // <= 0 on barrier
-      level = current->td_level;
-      kmp_taskdata_t *parent = taskdata->td_parent;
-      while (parent != current && parent->td_level > level) {
-        parent = parent->td_parent; // check generation up to the level of the
-        // current task
-        KMP_DEBUG_ASSERT(parent != NULL);
-      }
-      if (parent != current) {
-        if (!task_team->tt.tt_untied_task_encountered) {
-          // The TSC does not allow to steal victim task
-          __kmp_release_bootstrap_lock(&victim_td->td.td_deque_lock);
-          KA_TRACE(10,
-                   ("__kmp_steal_task(exit #3): T#%d could not steal from "
+  if (!__kmp_task_is_allowed(gtid, is_constrained, taskdata)) {
+    if (!task_team->tt.tt_untied_task_encountered) {
+      // The TSC does not allow to steal victim task
+      __kmp_release_bootstrap_lock(&victim_td->td.td_deque_lock);
+      KA_TRACE(10, ("__kmp_steal_task(exit #3): T#%d could not steal from "
                     "T#%d: task_team=%p ntasks=%d head=%u tail=%u\n",
                     gtid, __kmp_gtid_from_thread(victim_thr), task_team, ntasks,
                     victim_td->td.td_deque_head, victim_td->td.td_deque_tail));
-          return NULL;
-        }
-        taskdata = NULL; // will check other tasks in victim's deque
-      }
+      return NULL;
     }
+    taskdata = NULL; // will check other tasks in victim's deque
   }
   if (taskdata != NULL) {
     // Bump head pointer and Wrap.
@@ -2295,26 +2669,9 @@ static kmp_task_t *__kmp_steal_task(kmp_info_t *victim_thr, kmp_int32 gtid,
     for (i = 1; i < ntasks; ++i) {
       target = (target + 1) & TASK_DEQUE_MASK(victim_td->td);
       taskdata = victim_td->td.td_deque[target];
-      if (taskdata->td_flags.tiedness == TASK_TIED) {
-        // check if the candidate obeys the TSC
-        kmp_taskdata_t *parent = taskdata->td_parent;
-        // check generation up to the level of the current task
-        while (parent != current && parent->td_level > level) {
-          parent = parent->td_parent;
-          KMP_DEBUG_ASSERT(parent != NULL);
-        }
-        if (parent != current) {
-          // The TSC does not allow to steal the candidate
-          taskdata = NULL;
-          continue;
-        } else {
-          // found victim tied task
-          break;
-        }
-      } else {
-        // found victim untied task
-        break;
-      }
+      if (__kmp_task_is_allowed(gtid, is_constrained, taskdata))
+        break; // found victim tied task obeying the TSC, or untied task
+      taskdata = NULL;
     }
     if (taskdata == NULL) {
       // No appropriate candidate to steal found
@@ -2366,6 +2723,210 @@ static kmp_task_t *__kmp_steal_task(kmp_info_t *victim_thr, kmp_int32 gtid,
   return task;
 }
 
+#if OMP_45_ENABLED
+// __kmp_get_priority_task: take the oldest task of the highest priority that
+// the task scheduling constraint allows from the task team's priority deques.
+static kmp_task_t *
+__kmp_get_priority_task(kmp_int32 gtid, kmp_task_team_t *task_team,
+                        std::atomic<kmp_int32> *unfinished_threads,
+                        int *thread_finished, kmp_int32 is_constrained) {
+  kmp_taskdata_t *taskdata = NULL;
+  kmp_thread_data_t *thread_data;
+  kmp_int32 ntasks = KMP_ATOMIC_LD_ACQ(&task_team->tt.tt_num_task_pri);
+
+  // Reserve one of the queued priority tasks, so that threads which cannot
+  // get a ticket do not walk the list
+  do {
+    if (ntasks <= 0)
+      return NULL;
+  } while (!task_team->tt.tt_num_task_pri.compare_exchange_weak(ntasks,
+                                                                ntasks - 1));
+
+  kmp_task_pri_t *list =
+      (kmp_task_pri_t *)TCR_PTR(task_team->tt.tt_task_pri_list);
+  for (; list != NULL; list = list->next) {
+    thread_data = &list->td;
+    if (TCR_4(thread_data->td.td_deque_ntasks) == 0)
+      continue;
+    __kmp_acquire_bootstrap_lock(&thread_data->td.td_deque_lock);
+    kmp_int32 deque_ntasks = TCR_4(thread_data->td.td_deque_ntasks);
+    kmp_uint32 target = thread_data->td.td_deque_head;
+    kmp_int32 i;
+    // Walk from the oldest task; tied tasks are checked against the TSC
+    for (i = 0; i < deque_ntasks; ++i) {
+      taskdata = thread_data->td.td_deque[target];
+      if (__kmp_task_is_allowed(gtid, is_constrained, taskdata))
+        break;
+      taskdata = NULL;
+      if (!task_team->tt.tt_untied_task_encountered)
+        break; // checking the head is enough, as in __kmp_steal_task
+      target = (target + 1) & TASK_DEQUE_MASK(thread_data->td);
+    }
+    if (taskdata == NULL) {
+      __kmp_release_bootstrap_lock(&thread_data->td.td_deque_lock);
+      continue; // try tasks of lower priority
+    }
+    if (i == 0) {
+      // Bump head pointer and Wrap.
+      thread_data->td.td_deque_head =
+          (target + 1) & TASK_DEQUE_MASK(thread_data->td);
+    } else {
+      kmp_uint32 prev = target;
+      for (i = i + 1; i < deque_ntasks; ++i) {
+        // shift remaining tasks in the deque left by 1
+        target = (target + 1) & TASK_DEQUE_MASK(thread_data->td);
+        thread_data->td.td_deque[prev] = thread_data->td.td_deque[target];
+        prev = target;
+      }
+      thread_data->td.td_deque_tail = prev; // tail -= 1 (wrapped)
+    }
+    if (*thread_finished) {
+      // As in __kmp_steal_task, un-mark this thread as finished before the
+      // task leaves the deque so that the barrier is not released early
+      kmp_int32 count = KMP_ATOMIC_INC(unfinished_threads);
+      KA_TRACE(20, ("__kmp_get_priority_task: T#%d inc unfinished_threads to "
+                    "%d: task_team=%p\n",
+                    gtid, count + 1, task_team));
+      *thread_finished = FALSE;
+    }
+    TCW_4(thread_data->td.td_deque_ntasks, deque_ntasks - 1);
+    __kmp_release_bootstrap_lock(&thread_data->td.td_deque_lock);
+
+    KA_TRACE(10, ("__kmp_get_priority_task(exit): T#%d got task %p of "
+                  "priority %d: task_team=%p\n",
+                  gtid, taskdata, list->priority, task_team));
+    return KMP_TASKDATA_TO_TASK(taskdata);
+  }
+
+  // No task allowed by the TSC; give the ticket back
+  KMP_ATOMIC_INC(&task_team->tt.tt_num_task_pri);
+  return NULL;
+}
+
+#endif // OMP_45_ENABLED
+
+// __kmp_steal_ring: bounds of the threads that share hierarchy level "level"
+// with thread "tid" but not level - 1, as two ranges: [*lo, *in_lo) and
+// [*in_hi, *hi). Returns the number of threads in them.
+static inline kmp_int32 __kmp_steal_ring(kmp_task_team_t *task_team,
+                                         kmp_int32 tid, kmp_int32 nthreads,
+                                         kmp_int32 level, kmp_int32 *lo,
+                                         kmp_int32 *in_lo, kmp_int32 *in_hi,
+                                         kmp_int32 *hi) {
+  kmp_int32 size = task_team->tt.tt_steal_skip[level];
+  kmp_int32 in_size = task_team->tt.tt_steal_skip[level - 1];
+
+  *lo = tid - tid % size;
+  *hi = KMP_MIN(*lo + size, nthreads);
+  *in_lo = tid - tid % in_size;
+  *in_hi = KMP_MIN(*in_lo + in_size, nthreads);
+  return (*hi - *lo) - (*in_hi - *in_lo);
+}
+
+// __kmp_select_victim_hierarchical: pick a random victim among the threads
+// closest to the thief in the machine hierarchy that have not been searched in
+// vain yet. Core siblings go first, then threads of the same package, then
+// remote ones; the thief moves out one level after failing as many times as
+// there are threads at the current one.
+static kmp_int32
+__kmp_select_victim_hierarchical(kmp_info_t *thread, kmp_task_team_t *task_team,
+                                 kmp_thread_data_t *thread_data, kmp_int32 tid,
+                                 kmp_int32 nthreads) {
+  kmp_int32 levels = task_team->tt.tt_steal_levels;
+  kmp_int32 level = thread_data->td.td_steal_level;
+  kmp_int32 lo, in_lo, in_hi, hi, count, victim_tid;
+
+  KMP_DEBUG_ASSERT(levels > 1);
+  while (1) {
+    if (level < 1 || level >= levels) {
+      level = 1; // every level has been searched, start over nearby
+      thread_data->td.td_steal_fails = 0;
+    }
+    count = __kmp_steal_ring(task_team, tid, nthreads, level, &lo, &in_lo,
+                             &in_hi, &hi);
+    if (count > 0 && thread_data->td.td_steal_fails < count)
+      break;
+    ++level;
+    thread_data->td.td_steal_fails = 0;
+  }
+  thread_data->td.td_steal_level = level;
+
+  victim_tid = lo + __kmp_get_random(thread) % count;
+  if (victim_tid >= in_lo)
+    victim_tid += in_hi - in_lo; // skip the threads of the inner level
+  KMP_DEBUG_ASSERT(victim_tid != tid && victim_tid < nthreads);
+  return victim_tid;
+}
+
+#if KMP_STATS_ENABLED
+// __kmp_count_steal_locality: record how far in the machine hierarchy the
+// victim of a successful steal was from the thief. The threads are only
+// grouped by the hierarchy under the hierarchical steal policy.
+static void __kmp_count_steal_locality(kmp_task_team_t *task_team,
+                                       kmp_int32 tid, kmp_int32 victim_tid) {
+  kmp_int32 levels = task_team->tt.tt_steal_levels;
+  kmp_int32 level = 1;
+
+  while (level < levels - 1 &&
+         tid / (kmp_int32)task_team->tt.tt_steal_skip[level] !=
+             victim_tid / (kmp_int32)task_team->tt.tt_steal_skip[level])
+    ++level;
+  if (level == 1 && levels > 2) {
+    KMP_COUNT_BLOCK(TASK_stolen_near);
+  } else if (level < levels - 1) {
+    KMP_COUNT_BLOCK(TASK_stolen_mid);
+  } else {
+    KMP_COUNT_BLOCK(TASK_stolen_far);
+  }
+}
+#endif // KMP_STATS_ENABLED
+
+// __kmp_requeue_task: give back a task taken by the thread whose mutexinoutset
+// locks are busy. It goes to the head of the thread's locked deque, away from
+// the end the thread takes its own tasks from, so that the tasks the current
+// lock holders may wait for are not stuck behind it.
+static void __kmp_requeue_task(kmp_info_t *thread, kmp_int32 gtid,
+                               kmp_task_team_t *task_team,
+                               kmp_thread_data_t *thread_data,
+                               kmp_taskdata_t *taskdata) {
+#if OMP_45_ENABLED
+  kmp_task_t *task = KMP_TASKDATA_TO_TASK(taskdata);
+  if (__kmp_max_task_priority > 0 && taskdata->td_flags.priority_specified &&
+      task->data2.priority > 0) {
+    kmp_int32 pri = KMP_MIN(task->data2.priority, __kmp_max_task_priority);
+    __kmp_push_priority_task(gtid, thread, taskdata, task_team, pri);
+    return;
+  }
+#endif
+  // No lock needed since only owner can allocate
+  if (thread_data->td.td_deque == NULL)
+    __kmp_alloc_task_deque(thread, thread_data);
+  __kmp_acquire_bootstrap_lock(&thread_data->td.td_deque_lock);
+  if (TCR_4(thread_data->td.td_deque_ntasks) >=
+      TASK_DEQUE_SIZE(thread_data->td)) {
+    __kmp_realloc_task_deque(thread, thread_data);
+  }
+  thread_data->td.td_deque_head =
+      (thread_data->td.td_deque_head - 1) & TASK_DEQUE_MASK(thread_data->td);
+  thread_data->td.td_deque[thread_data->td.td_deque_head] = taskdata;
+  TCW_4(thread_data->td.td_deque_ntasks,
+        TCR_4(thread_data->td.td_deque_ntasks) + 1);
+  __kmp_release_bootstrap_lock(&thread_data->td.td_deque_lock);
+  KA_TRACE(20, ("__kmp_requeue_task: T#%d requeued task %p\n", gtid,
+                taskdata));
+}
+
+// __kmp_flush_task_continuation: schedule the successor kept for this thread
+// by __kmp_release_deps the normal way, so that other threads can steal it
+static inline void __kmp_flush_task_continuation(kmp_info_t *thread,
+                                                 kmp_int32 gtid) {
+  kmp_taskdata_t *next = thread->th.th_task_continuation;
+  if (next != NULL) {
+    thread->th.th_task_continuation = NULL;
+    __kmp_omp_task(gtid, KMP_TASKDATA_TO_TASK(next), false);
+  }
+}
+
 // __kmp_execute_tasks_template: Choose and execute tasks until either the
 // condition is statisfied (return true) or there are none left (return false).
 //
@@ -2416,7 +2977,29 @@ static inline int __kmp_execute_tasks_template(
     // getting tasks from target constructs
     while (1) { // Inner loop to find a task and execute it
       task = NULL;
-      if (use_own_tasks) { // check on own queue first
+      if (thread->th.th_task_continuation != NULL) {
+        // Run the successor released by the last task first, while the data it
+        // shares with that task is still in cache
+        kmp_taskdata_t *next = thread->th.th_task_continuation;
+        if (__kmp_task_is_allowed(gtid, is_constrained, next)) {
+          thread->th.th_task_continuation = NULL;
+          task = KMP_TASKDATA_TO_TASK(next);
+          KMP_COUNT_BLOCK(TASK_continued);
+        } else {
+          __kmp_flush_task_continuation(thread, gtid);
+        }
+      }
+#if OMP_45_ENABLED
+      if (task == NULL &&
+          KMP_ATOMIC_LD_RLX(&task_team->tt.tt_num_task_pri) > 0) {
+        // Tasks with a priority go before all others
+        task = __kmp_get_priority_task(gtid, task_team, unfinished_threads,
+                                       thread_finished, is_constrained);
+      }
+      if (task == NULL && use_own_tasks) { // check on own queue next
+#else
+      if (task == NULL && use_own_tasks) { // check on own queue next
+#endif
         task = __kmp_remove_my_task(thread, gtid, task_team, is_constrained);
       }
       if ((task == NULL) && (nthreads > 1)) { // Steal a task
@@ -2434,12 +3017,17 @@ static inline int __kmp_execute_tasks_template(
         } else if (!new_victim) { // no recent steals and we haven't already
           // used a new victim; select a random thread
           do { // Find a different thread to steal work from.
-            // Pick a random thread. Initial plan was to cycle through all the
-            // threads, and only return if we tried to steal from every thread,
-            // and failed.  Arch says that's not such a great idea.
-            victim_tid = __kmp_get_random(thread) % (nthreads - 1);
-            if (victim_tid >= tid) {
-              ++victim_tid; // Adjusts random distribution to exclude self
+            if (__kmp_task_steal_policy == steal_hierarchical) {
+              victim_tid = __kmp_select_victim_hierarchical(
+                  thread, task_team, &threads_data[tid], tid, nthreads);
+            } else {
+              // Pick a random thread. Initial plan was to cycle through all
+              // the threads, and only return if we tried to steal from every
+              // thread, and failed.  Arch says that's not such a great idea.
+              victim_tid = __kmp_get_random(thread) % (nthreads - 1);
+              if (victim_tid >= tid) {
+                ++victim_tid; // Adjusts random distribution to exclude self
+              }
             }
             // Found a potential victim
             other_thread = threads_data[victim_tid].td.td_thr;
@@ -2476,6 +3064,13 @@ static inline int __kmp_execute_tasks_template(
                                   is_constrained);
         }
         if (task != NULL) { // set last stolen to victim
+#if KMP_STATS_ENABLED
+          if (__kmp_task_steal_policy == steal_hierarchical)
+            __kmp_count_steal_locality(task_team, tid, victim_tid);
+#endif
+          // Next time the search starts over at the nearest level
+          threads_data[tid].td.td_steal_level = 1;
+          threads_data[tid].td.td_steal_fails = 0;
           if (threads_data[tid].td.td_deque_last_stolen != victim_tid) {
             threads_data[tid].td.td_deque_last_stolen = victim_tid;
             // The pre-refactored code did not try more than 1 successful new
@@ -2484,6 +3079,8 @@ static inline int __kmp_execute_tasks_template(
             new_victim = 1;
           }
         } else { // No tasks found; unset last_stolen
+          if (!asleep && threads_data[tid].td.td_deque_last_stolen == -1)
+            threads_data[tid].td.td_steal_fails++;
           KMP_CHECK_UPDATE(threads_data[tid].td.td_deque_last_stolen, -1);
           victim_tid = -2; // no successful victim found
         }
@@ -2492,6 +3089,21 @@ static inline int __kmp_execute_tasks_template(
       if (task == NULL) // break out of tasking loop
         break;
 
+      if (!__kmp_task_acquire_mutexinoutset(gtid,
+                                            KMP_TASK_TO_TASKDATA(task))) {
+        // A task of the same mutexinoutset set runs, possibly lower on this
+        // thread's stack; queue the task again and let the caller check its
+        // condition before looking for tasks again
+        if (*thread_finished) {
+          KMP_ATOMIC_INC(unfinished_threads);
+          *thread_finished = FALSE;
+        }
+        __kmp_requeue_task(thread, gtid, task_team, &threads_data[tid],
+                           KMP_TASK_TO_TASKDATA(task));
+        __kmp_flush_task_continuation(thread, gtid);
+        return FALSE;
+      }
+
 // Found a task; execute it
 #if USE_ITT_BUILD && USE_ITT_NOTIFY
       if (__itt_sync_create_ptr || KMP_ITT_DEBUG) {
@@ -2502,7 +3114,15 @@ static inline int __kmp_execute_tasks_template(
         __kmp_itt_task_starting(itt_sync_obj);
       }
 #endif /* USE_ITT_BUILD && USE_ITT_NOTIFY */
-      __kmp_invoke_task(gtid, task, current_task);
+      if (__kmp_task_continuation) {
+        // Let __kmp_release_deps keep a successor of this task for us
+        kmp_taskdata_t *src = thread->th.th_task_continuation_src;
+        thread->th.th_task_continuation_src = KMP_TASK_TO_TASKDATA(task);
+        __kmp_invoke_task(gtid, task, current_task);
+        thread->th.th_task_continuation_src = src;
+      } else {
+        __kmp_invoke_task(gtid, task, current_task);
+      }
 #if USE_ITT_BUILD
       if (itt_sync_obj != NULL)
         __kmp_itt_task_finished(itt_sync_obj);
@@ -2517,16 +3137,18 @@ static inline int __kmp_execute_tasks_template(
             15,
             ("__kmp_execute_tasks_template: T#%d spin condition satisfied\n",
              gtid));
+        __kmp_flush_task_continuation(thread, gtid);
         return TRUE;
       }
       if (thread->th.th_task_team == NULL) {
+        __kmp_flush_task_continuation(thread, gtid);
         break;
       }
       // Yield before executing next task
       KMP_YIELD(__kmp_library == library_throughput);
       // If execution of a stolen task results in more tasks being placed on our
       // run queue, reset use_own_tasks
-      if (!use_own_tasks && TCR_4(threads_data[tid].td.td_deque_ntasks) != 0) {
+      if (!use_own_tasks && __kmp_task_deque_ntasks(&threads_data[tid]) != 0) {
         KA_TRACE(20, ("__kmp_execute_tasks_template: T#%d stolen task spawned "
                       "other tasks, restart\n",
                       gtid));
@@ -2758,6 +3380,14 @@ static void __kmp_alloc_task_deque(kmp_info_t *thread,
   thread_data->td.td_deque = (kmp_taskdata_t **)__kmp_allocate(
       INITIAL_TASK_DEQUE_SIZE * sizeof(kmp_taskdata_t *));
   thread_data->td.td_deque_size = INITIAL_TASK_DEQUE_SIZE;
+
+  if (__kmp_task_deque_lockfree) {
+    KMP_DEBUG_ASSERT(thread_data->td.td_cl_array == NULL);
+    KMP_ATOMIC_ST_RLX(&thread_data->td.td_cl_top, 0);
+    KMP_ATOMIC_ST_RLX(&thread_data->td.td_cl_bottom, 0);
+    KMP_ATOMIC_ST_REL(&thread_data->td.td_cl_array,
+                      __kmp_alloc_task_cl_array(INITIAL_TASK_DEQUE_SIZE));
+  }
 }
 
 // __kmp_realloc_task_deque:
@@ -2801,6 +3431,14 @@ static void __kmp_free_task_deque(kmp_thread_data_t *thread_data) {
     __kmp_release_bootstrap_lock(&thread_data->td.td_deque_lock);
   }
 
+  kmp_task_cl_array_t *array = KMP_ATOMIC_LD_RLX(&thread_data->td.td_cl_array);
+  while (array != NULL) {
+    kmp_task_cl_array_t *retired = array->cla_retired;
+    __kmp_free(array);
+    array = retired;
+  }
+  KMP_ATOMIC_ST_RLX(&thread_data->td.td_cl_array, NULL);
+
 #ifdef BUILD_TIED_TASK_STACK
   // GEH: Figure out what to do here for td_susp_tied_tasks
   if (thread_data->td.td_susp_tied_tasks.ts_entries != TASK_STACK_EMPTY) {
@@ -2898,10 +3536,18 @@ static int __kmp_realloc_task_threads_data(kmp_info_t *thread,
       KMP_DEBUG_ASSERT(*threads_data_p != NULL);
     }
 
+    // Group the threads by the machine hierarchy for victim selection. This
+    // assumes thread i runs on the i-th place, as the hierarchical barrier does
+    if (__kmp_task_steal_policy == steal_hierarchical)
+      task_team->tt.tt_steal_levels = __kmp_get_hierarchy_groups(
+          nthreads, task_team->tt.tt_steal_skip, KMP_TASK_STEAL_MAX_LEVELS);
+
     // initialize threads_data pointers back to thread_info structures
     for (i = 0; i < nthreads; i++) {
       kmp_thread_data_t *thread_data = &(*threads_data_p)[i];
       thread_data->td.td_thr = team->t.t_threads[i];
+      thread_data->td.td_steal_level = 1;
+      thread_data->td.td_steal_fails = 0;
 
       if (thread_data->td.td_deque_last_stolen >= nthreads) {
         // The last stolen field survives across teams / barrier, and the number
@@ -2935,6 +3581,23 @@ static void __kmp_free_task_threads_data(kmp_task_team_t *task_team) {
   __kmp_release_bootstrap_lock(&task_team->tt.tt_threads_lock);
 }
 
+#if OMP_45_ENABLED
+// __kmp_free_task_pri_list: deallocate the priority deques of a task team.
+// Happens at library deallocation.
+static void __kmp_free_task_pri_list(kmp_task_team_t *task_team) {
+  __kmp_acquire_bootstrap_lock(&task_team->tt.tt_task_pri_lock);
+  kmp_task_pri_t *list = task_team->tt.tt_task_pri_list;
+  task_team->tt.tt_task_pri_list = NULL;
+  while (list != NULL) {
+    kmp_task_pri_t *next = list->next;
+    __kmp_free_task_deque(&list->td);
+    __kmp_free(list);
+    list = next;
+  }
+  __kmp_release_bootstrap_lock(&task_team->tt.tt_task_pri_lock);
+}
+#endif // OMP_45_ENABLED
+
 // __kmp_allocate_task_team:
 // Allocates a task team associated with a specific team, taking it from
 // the global task team free list if possible.  Also initializes data
@@ -2967,6 +3630,9 @@ static kmp_task_team_t *__kmp_allocate_task_team(kmp_info_t *thread,
     // kmp_reap_task_team( ).
     task_team = (kmp_task_team_t *)__kmp_allocate(sizeof(kmp_task_team_t));
     __kmp_init_bootstrap_lock(&task_team->tt.tt_threads_lock);
+#if OMP_45_ENABLED
+    __kmp_init_bootstrap_lock(&task_team->tt.tt_task_pri_lock);
+#endif
     // AC: __kmp_allocate zeroes returned memory
     // task_team -> tt.tt_threads_data = NULL;
     // task_team -> tt.tt_max_threads = 0;
@@ -3025,6 +3691,11 @@ void __kmp_reap_task_teams(void) {
       if (task_team->tt.tt_threads_data != NULL) {
         __kmp_free_task_threads_data(task_team);
       }
+#if OMP_45_ENABLED
+      if (task_team->tt.tt_task_pri_list != NULL) {
+        __kmp_free_task_pri_list(task_team);
+      }
+#endif
       __kmp_free(task_team);
     }
     __kmp_release_bootstrap_lock(&__kmp_task_team_lock);
@@ -3193,6 +3864,15 @@ void __kmp_task_team_wait(
   KMP_DEBUG_ASSERT(__kmp_tasking_mode != tskm_immediate_exec);
   KMP_DEBUG_ASSERT(task_team == this_thr->th.th_task_team);
 
+  if (__kmp_task_deque_lockfree) {
+    // All threads have arrived at this barrier, so none of them still spins
+    // on the task team of the previous one: its retired arrays can go.
+    kmp_task_team_t *other_team =
+        team->t.t_task_team[1 - this_thr->th.th_task_state];
+    if (other_team != NULL)
+      __kmp_free_retired_task_cl_arrays(other_team);
+  }
+
   if ((task_team != NULL) && KMP_TASKING_ENABLED(task_team)) {
     if (wait) {
       KA_TRACE(20, ("__kmp_task_team_wait: Master T#%d waiting for all tasks "
@@ -283,6 +283,55 @@ void __kmp_affinity_determine_capable(const char *env_var) {
   }
 }
 
+#ifndef MPOL_MF_MOVE
+#define MPOL_MF_MOVE (1 << 1)
+#endif
+
+/* The descriptor of a worker, and with it all of its barrier flags, is
+   allocated and zeroed by the thread that forks it, so first touch puts it on
+   that thread's NUMA node. Once th is bound, it calls this to move those pages
+   to the node it runs on. The hierarchical barrier's flags for a subtree live
+   in the subtree root's descriptor, so they follow it to the subtree's node.
+   Nothing is done on single node machines, and failures are ignored. */
+static int __kmp_numa_os_node(int node);
+
+void __kmp_localize_thread_state(kmp_info_t *th) {
+#if defined(__NR_move_pages)
+  enum { max_pages = 8 };
+  void *pages[max_pages];
+  int nodes[max_pages], status[max_pages];
+  int node;
+  size_t page_size = KMP_GET_PAGE_SIZE();
+  int n, i;
+  long rc;
+
+  // Only threads bound to a place stay on a node.
+  if (!__kmp_numa_local_state || !KMP_AFFINITY_CAPABLE() ||
+      __kmp_affinity_type == affinity_none ||
+      __kmp_affinity_type == affinity_balanced)
+    return;
+#if OMP_40_ENABLED
+  if (th->th.th_current_place < 0) // all places, or not bound yet
+    return;
+#endif
+  if (__kmp_num_numa_nodes < 2 || !PAGE_ALIGNED(th))
+    return;
+  node = __kmp_numa_os_node(__kmp_get_numa_node());
+  n = (sizeof(kmp_info_t) + page_size - 1) / page_size;
+  if (n > max_pages)
+    n = max_pages;
+  for (i = 0; i < n; ++i) {
+    pages[i] = (char *)th + i * page_size;
+    nodes[i] = node;
+    status[i] = 0;
+  }
+  rc = syscall(__NR_move_pages, 0, n, pages, nodes, status, MPOL_MF_MOVE);
+  KA_TRACE(20, ("__kmp_localize_thread_state: T#%d moving %d pages of %p to "
+                "node %d: rc=%ld status[0]=%d\n",
+                th->th.th_info.ds.ds_gtid, n, th, node, rc, status[0]));
+#endif
+}
+
 #endif // KMP_OS_LINUX && KMP_AFFINITY_SUPPORTED
 
 #if KMP_USE_FUTEX
@@ -519,8 +568,13 @@ static void *__kmp_launch_worker(void *thr) {
   __kmp_itt_thread_name(gtid);
 #endif /* USE_ITT_BUILD */
 
+  // Create the workers left to this one while it still has the affinity of
+  // the thread that created it.
+  __kmp_spawn_children((kmp_info_t *)thr);
+
 #if KMP_AFFINITY_SUPPORTED
   __kmp_affinity_set_init_mask(gtid, FALSE);
+  __kmp_localize_thread_state((kmp_info_t *)thr);
 #endif
 
 #ifdef KMP_CANCEL_THREADS
@@ -1408,6 +1462,109 @@ void __kmp_suspend_uninitialize_thread(kmp_info_t *th) {
   }
 }
 
+#if KMP_USE_FUTEX
+/* With KMP_FUTEX_SLEEP a thread waiting on a barrier flag sleeps on the flag
+   word itself: the sleep bit is in its low 32 bits (all KMP_USE_FUTEX targets
+   are little endian), so any release or resume changes the futex word and no
+   wake-up is lost. A waker given the flag needs neither the mutex nor the
+   condition variable of the thread. A resume without a flag finds the word in
+   th_sleep_word; barrier flags live in the barrier state of the threads, so
+   the word stays valid after the sleeper returns. The flag object in
+   th_sleep_loc does not, so such a resume only checks that th_sleep_loc is
+   set and lets the sleep bit of the word tell whether the thread sleeps on it;
+   at worst it wakes a thread that goes back to sleep after rechecking. Other
+   flags keep using the condition variable. */
+template <class C>
+static inline void __kmp_suspend_futex(int th_gtid, C *flag) {
+  KMP_TIME_DEVELOPER_PARTITIONED_BLOCK(USER_suspend);
+  kmp_info_t *th = __kmp_threads[th_gtid];
+  volatile kmp_int32 *word = RCAST(volatile kmp_int32 *, flag->get());
+  typename C::flag_t old_spin;
+  kmp_int32 val;
+  int deactivated = FALSE;
+
+  TCW_PTR(th->th.th_sleep_word, flag->get());
+  old_spin = flag->set_sleeping();
+  KF_TRACE(5, ("__kmp_suspend_futex: T#%d set sleep bit for spin(%p)==%x,"
+               " was %x\n",
+               th_gtid, flag->get(), flag->load(), old_spin));
+  if (flag->done_check_val(old_spin)) {
+    flag->unset_sleeping();
+    KF_TRACE(5, ("__kmp_suspend_futex: T#%d false alarm, reset sleep bit "
+                 "for spin(%p)\n",
+                 th_gtid, flag->get()));
+    return;
+  }
+  TCW_PTR(th->th.th_sleep_loc, (void *)flag);
+
+  while ((val = *word) & KMP_BARRIER_SLEEP_STATE) {
+    if (!deactivated) {
+      th->th.th_active = FALSE;
+      if (th->th.th_active_in_pool) {
+        th->th.th_active_in_pool = FALSE;
+        KMP_ATOMIC_DEC(&__kmp_thread_pool_active_nth);
+        KMP_DEBUG_ASSERT(TCR_4(__kmp_thread_pool_active_nth) >= 0);
+      }
+      deactivated = TRUE;
+    }
+#if USE_SUSPEND_TIMEOUT
+    int msecs = (4 * __kmp_dflt_blocktime) + 200;
+    struct timespec timeout = {msecs / 1000, (msecs % 1000) * 1000000L};
+    struct timespec *ptimeout = &timeout;
+#else
+    struct timespec *ptimeout = NULL;
+#endif
+    KF_TRACE(15, ("__kmp_suspend_futex: T#%d about to perform futex wait on "
+                  "spin(%p)==%x\n",
+                  th_gtid, word, val));
+    // EAGAIN: the word changed before we slept, EINTR: a signal; recheck both
+    if (syscall(__NR_futex, word, FUTEX_WAIT, val, ptimeout, NULL, 0) != 0 &&
+        errno != EAGAIN && errno != EINTR && errno != ETIMEDOUT) {
+      KMP_SYSFAIL("futex", errno);
+    }
+  }
+  TCW_PTR(th->th.th_sleep_loc, NULL);
+
+  if (deactivated) {
+    th->th.th_active = TRUE;
+    if (TCR_4(th->th.th_in_pool)) {
+      KMP_ATOMIC_INC(&__kmp_thread_pool_active_nth);
+      th->th.th_active_in_pool = TRUE;
+    }
+  }
+  KF_TRACE(30, ("__kmp_suspend_futex: T#%d exit\n", th_gtid));
+}
+
+template <class C>
+static inline void __kmp_resume_futex(int target_gtid, C *flag) {
+  KMP_TIME_DEVELOPER_PARTITIONED_BLOCK(USER_resume);
+  kmp_info_t *th = __kmp_threads[target_gtid];
+  typedef decltype(flag->get()) loc_t;
+  // Coming from __kmp_null_resume_wrapper: the flag object may be gone, so
+  // do not look into it; the sleep bit of th_sleep_word decides below.
+  if (!flag && TCR_PTR(th->th.th_sleep_loc) == NULL)
+    return;
+  loc_t loc = flag ? flag->get()
+                   : RCAST(loc_t, CCAST(void *, TCR_PTR(th->th.th_sleep_word)));
+  if (loc == NULL)
+    return;
+  C sleep_flag(loc);
+  typename C::flag_t old_spin = sleep_flag.unset_sleeping();
+  if (!sleep_flag.is_sleeping_val(old_spin)) {
+    KF_TRACE(5, ("__kmp_resume_futex: thread T#%d already awake: flag(%p): "
+                 "%u => %u\n",
+                 target_gtid, loc, old_spin, sleep_flag.load()));
+    return;
+  }
+  KF_TRACE(5, ("__kmp_resume_futex: waking up T#%d, reset sleep bit for "
+               "flag's loc(%p): %u => %u\n",
+               target_gtid, loc, old_spin, sleep_flag.load()));
+  // Wake every thread asleep on the word; the ones still waiting go back
+  // to sleep after they recheck their flag.
+  syscall(__NR_futex, loc, FUTEX_WAKE, KMP_MAX_NTH, NULL, NULL, 0);
+}
+#endif // KMP_USE_FUTEX
+
 /* This routine puts the calling thread to sleep after setting the
    sleep bit for the indicated flag variable to true. */
 template <class C>
@@ -1541,9 +1698,21 @@ void __kmp_suspend_32(int th_gtid, kmp_flag_32 *flag) {
   __kmp_suspend_template(th_gtid, flag);
 }
 void __kmp_suspend_64(int th_gtid, kmp_flag_64 *flag) {
+#if KMP_USE_FUTEX
+  if (__kmp_futex_sleep) {
+    __kmp_suspend_futex(th_gtid, flag);
+    return;
+  }
+#endif
   __kmp_suspend_template(th_gtid, flag);
 }
 void __kmp_suspend_oncore(int th_gtid, kmp_flag_oncore *flag) {
+#if KMP_USE_FUTEX
+  if (__kmp_futex_sleep) {
+    __kmp_suspend_futex(th_gtid, flag);
+    return;
+  }
+#endif
   __kmp_suspend_template(th_gtid, flag);
 }
 
@@ -1624,9 +1793,21 @@ void __kmp_resume_32(int target_gtid, kmp_flag_32 *flag) {
   __kmp_resume_template(target_gtid, flag);
 }
 void __kmp_resume_64(int target_gtid, kmp_flag_64 *flag) {
+#if KMP_USE_FUTEX
+  if (__kmp_futex_sleep) {
+    __kmp_resume_futex(target_gtid, flag);
+    return;
+  }
+#endif
   __kmp_resume_template(target_gtid, flag);
 }
 void __kmp_resume_oncore(int target_gtid, kmp_flag_oncore *flag) {
+#if KMP_USE_FUTEX
+  if (__kmp_futex_sleep) {
+    __kmp_resume_futex(target_gtid, flag);
+    return;
+  }
+#endif
   __kmp_resume_template(target_gtid, flag);
 }
 
@@ -1811,6 +1992,85 @@ int __kmp_read_from_file(char const *path, char const *format, ...) {
   return result;
 }
 
+#if KMP_OS_LINUX
+/* Dense NUMA node index of each OS processor. Only filled in when the machine
+   has more than one node, otherwise every thread is on node 0. */
+static kmp_int16 *__kmp_proc_numa_node = NULL;
+static int __kmp_proc_numa_node_size = 0;
+static int __kmp_numa_node_ids[KMP_MAX_NUMA_NODES]; // OS id of each index
+
+static int __kmp_scan_numa_node(char const *path, int *id) {
+  DIR *dir = opendir(path);
+  struct dirent *entry;
+  int found = 0;
+  if (dir == NULL)
+    return 0;
+  while (!found && (entry = readdir(dir)) != NULL)
+    found = sscanf(entry->d_name, "node%d", id) == 1;
+  closedir(dir);
+  return found;
+}
+
+static void __kmp_numa_initialize(void) {
+  int nprocs = sysconf(_SC_NPROCESSORS_CONF);
+  int *node_ids = __kmp_numa_node_ids;
+  int num_nodes = 0, proc, id, i;
+  char path[64];
+  DIR *dir;
+  struct dirent *entry;
+
+  __kmp_num_numa_nodes = 1;
+  dir = opendir("/sys/devices/system/node");
+  if (dir == NULL)
+    return;
+  while ((entry = readdir(dir)) != NULL)
+    if (sscanf(entry->d_name, "node%d", &id) == 1)
+      ++num_nodes;
+  closedir(dir);
+  if (num_nodes < 2 || num_nodes > KMP_MAX_NUMA_NODES || nprocs <= 0)
+    return;
+
+  __kmp_proc_numa_node =
+      (kmp_int16 *)__kmp_allocate(nprocs * sizeof(kmp_int16));
+  __kmp_proc_numa_node_size = nprocs;
+  num_nodes = 0;
+  for (proc = 0; proc < nprocs; ++proc) {
+    KMP_SNPRINTF(path, sizeof(path), "/sys/devices/system/cpu/cpu%d", proc);
+    if (!__kmp_scan_numa_node(path, &id))
+      continue;
+    for (i = 0; i < num_nodes && node_ids[i] != id; ++i)
+      ;
+    if (i == num_nodes) {
+      if (num_nodes == KMP_MAX_NUMA_NODES)
+        continue;
+      node_ids[num_nodes++] = id;
+    }
+    __kmp_proc_numa_node[proc] = (kmp_int16)i;
+  }
+  __kmp_num_numa_nodes = num_nodes > 1 ? num_nodes : 1;
+  KA_TRACE(10, ("__kmp_numa_initialize: %d procs on %d nodes\n", nprocs,
+                __kmp_num_numa_nodes));
+}
+
+#if KMP_AFFINITY_SUPPORTED
+// __kmp_numa_os_node: OS id of a node index returned by __kmp_get_numa_node
+static int __kmp_numa_os_node(int node) {
+  return __kmp_num_numa_nodes > 1 ? __kmp_numa_node_ids[node] : 0;
+}
+#endif
+#endif // KMP_OS_LINUX
+
+int __kmp_get_numa_node(void) {
+#if KMP_OS_LINUX
+  if (__kmp_num_numa_nodes > 1) {
+    int proc = sched_getcpu();
+    if (proc >= 0 && proc < __kmp_proc_numa_node_size)
+      return __kmp_proc_numa_node[proc];
+  }
+#endif
+  return 0;
+}
+
 void __kmp_runtime_initialize(void) {
   int status;
   pthread_mutexattr_t mutex_attr;
@@ -1827,6 +2087,9 @@ void __kmp_runtime_initialize(void) {
 #endif /* KMP_ARCH_X86 || KMP_ARCH_X86_64 */
 
   __kmp_xproc = __kmp_get_xproc();
+#if KMP_OS_LINUX
+  __kmp_numa_initialize();
+#endif
 
   if (sysconf(_SC_THREADS)) {
 
@@ -1893,6 +2156,14 @@ void __kmp_runtime_destroy(void) {
 #if KMP_AFFINITY_SUPPORTED
   __kmp_affinity_uninitialize();
 #endif
+#if KMP_OS_LINUX
+  if (__kmp_proc_numa_node != NULL) {
+    __kmp_free(__kmp_proc_numa_node);
+    __kmp_proc_numa_node = NULL;
+    __kmp_proc_numa_node_size = 0;
+  }
+  __kmp_num_numa_nodes = 1;
+#endif
 
   __kmp_init_runtime = FALSE;
 }
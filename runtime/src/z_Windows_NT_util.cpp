@@ -527,6 +527,9 @@ void __kmp_affinity_bind_thread(int proc) {
   }
 }
 
+// Descriptors are not migrated between NUMA nodes on Windows* OS.
+void __kmp_localize_thread_state(kmp_info_t *th) {}
+
 void __kmp_affinity_determine_capable(const char *env_var) {
 // All versions of Windows* OS (since Win '95) support SetThreadAffinityMask().
 
@@ -583,6 +586,9 @@ int __kmp_read_system_info(struct kmp_sys_info *info) {
   return 1;
 }
 
+// NUMA nodes are not detected on Windows* OS, __kmp_num_numa_nodes stays 1.
+int __kmp_get_numa_node(void) { return 0; }
+
 void __kmp_runtime_initialize(void) {
   SYSTEM_INFO info;
   kmp_str_buf_t path;
@@ -907,6 +913,10 @@ void *__stdcall __kmp_launch_worker(void *arg) {
   __kmp_itt_thread_name(gtid);
 #endif /* USE_ITT_BUILD */
 
+  // Create the workers left to this one while it still has the affinity of
+  // the thread that created it.
+  __kmp_spawn_children(this_thr);
+
   __kmp_affinity_set_init_mask(gtid, FALSE);
 
 #if KMP_ARCH_X86 || KMP_ARCH_X86_64
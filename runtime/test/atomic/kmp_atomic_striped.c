@@ -0,0 +1,81 @@
+// RUN: %libomp-compile-and-run
+// RUN: env KMP_ATOMIC_MODE=1 %libomp-run
+#include <stdio.h>
+#include <complex.h>
+#include "omp_testsuite.h"
+
+/*
+ * Atomics without a lock-free implementation (long double, complex) take a
+ * lock chosen by the address of the operand: updates of the same location
+ * must still exclude each other, whichever element the other threads update.
+ */
+
+typedef struct ident ident_t;
+#ifdef __cplusplus
+extern "C" {
+#endif
+extern int __kmpc_global_thread_num(ident_t *);
+extern void __kmpc_atomic_float10_add(ident_t *, int gtid, long double *lhs,
+                                      long double rhs);
+extern long double __kmpc_atomic_float10_rd(ident_t *, int gtid,
+                                            long double *loc);
+extern void __kmpc_atomic_cmplx8_add(ident_t *, int gtid,
+                                     double _Complex *lhs, double _Complex rhs);
+#ifdef __cplusplus
+}
+#endif
+
+#define NELEMS 67 /* not a divisor of the lock table size */
+#define NITERS 500
+
+int test_atomic_striped() {
+  long double ld[NELEMS];
+  double _Complex cx[NELEMS];
+  int nthreads = 0;
+  int errors = 0;
+  int i;
+
+  for (i = 0; i < NELEMS; i++) {
+    ld[i] = 0.0L;
+    cx[i] = 0.0;
+  }
+  #pragma omp parallel reduction(+:errors)
+  {
+    int gtid = __kmpc_global_thread_num(NULL);
+    int tid = omp_get_thread_num();
+    int j, k;
+    #pragma omp single
+    nthreads = omp_get_num_threads();
+    for (j = 0; j < NITERS; j++) {
+      for (k = 0; k < NELEMS; k++) {
+        // Walk the elements in a different order in every thread
+        int e = (k + tid * 7) % NELEMS;
+        __kmpc_atomic_float10_add(NULL, gtid, &ld[e], 1.0L);
+        __kmpc_atomic_cmplx8_add(NULL, gtid, &cx[e], 1.0 + 2.0 * I);
+      }
+      if (__kmpc_atomic_float10_rd(NULL, gtid, &ld[tid % NELEMS]) < 0.0L)
+        errors++;
+    }
+  }
+  for (i = 0; i < NELEMS; i++) {
+    if (ld[i] != (long double)(nthreads * NITERS))
+      errors++;
+    if (creal(cx[i]) != nthreads * NITERS ||
+        cimag(cx[i]) != 2.0 * nthreads * NITERS)
+      errors++;
+  }
+  return errors == 0;
+}
+
+int main() {
+  int i;
+  int num_failed = 0;
+
+  for (i = 0; i < REPETITIONS; i++) {
+    if (!test_atomic_striped())
+      num_failed++;
+  }
+  if (num_failed)
+    printf("failed %d\n", num_failed);
+  return num_failed;
+}
@@ -0,0 +1,77 @@
+// RUN: %libomp-compile-and-run
+// RUN: env KMP_REDUCTION_BARRIER_PATTERN=dist,dist %libomp-run
+// RUN: env KMP_REDUCTION_BARRIER_PATTERN=linear,linear %libomp-run
+#include <stdio.h>
+#include "omp_testsuite.h"
+
+/*
+ * Scalar reductions fused into the barrier: every thread must get the sum,
+ * min and max over the team for each type, also when they are done back to
+ * back.
+ */
+
+typedef struct ident ident_t;
+#ifdef __cplusplus
+extern "C" {
+#endif
+extern int __kmpc_global_thread_num(ident_t *);
+extern void __kmpc_barrier_reduce(ident_t *, int gtid, int type, int op,
+                                  void *data);
+#ifdef __cplusplus
+}
+#endif
+
+enum { RED_INT32, RED_FLOAT, RED_DOUBLE };
+enum { RED_SUM, RED_MIN, RED_MAX };
+
+#define NREDUCTIONS 100
+
+int test_barrier_reduce(int nthreads) {
+  int errors = 0;
+
+  #pragma omp parallel num_threads(nthreads) reduction(+:errors)
+  {
+    int gtid = __kmpc_global_thread_num(NULL);
+    int n = omp_get_num_threads();
+    int me = omp_get_thread_num();
+    int r;
+
+    for (r = 0; r < NREDUCTIONS; r++) {
+      int isum = me + r, imin = me - r, imax = me * r;
+      float fsum = 0.5f * me;
+      double dmin = (double)me + 0.25, dmax = -(double)me;
+
+      __kmpc_barrier_reduce(NULL, gtid, RED_INT32, RED_SUM, &isum);
+      __kmpc_barrier_reduce(NULL, gtid, RED_INT32, RED_MIN, &imin);
+      __kmpc_barrier_reduce(NULL, gtid, RED_INT32, RED_MAX, &imax);
+      __kmpc_barrier_reduce(NULL, gtid, RED_FLOAT, RED_SUM, &fsum);
+      __kmpc_barrier_reduce(NULL, gtid, RED_DOUBLE, RED_MIN, &dmin);
+      __kmpc_barrier_reduce(NULL, gtid, RED_DOUBLE, RED_MAX, &dmax);
+      if (isum != n * (n - 1) / 2 + n * r)
+        errors++;
+      if (imin != -r || imax != (n - 1) * r)
+        errors++;
+      if (fsum != 0.25f * n * (n - 1))
+        errors++;
+      if (dmin != 0.25 || dmax != 0.0)
+        errors++;
+    }
+  }
+  return errors == 0;
+}
+
+int main() {
+  int i, n;
+  int num_failed = 0;
+
+  omp_set_dynamic(0);
+  for (i = 0; i < REPETITIONS; i++) {
+    for (n = 1; n <= 9; n++) {
+      if (!test_barrier_reduce(n))
+        num_failed++;
+    }
+  }
+  if (num_failed)
+    printf("failed %d\n", num_failed);
+  return num_failed;
+}
@@ -0,0 +1,96 @@
+// RUN: %libomp-compile
+// RUN: env KMP_BARRIER_TUNING=1 %libomp-run
+// RUN: env KMP_BARRIER_TUNING=4 OMP_WAIT_POLICY=passive %libomp-run
+// RUN: env KMP_BARRIER_TUNING=2 KMP_HOT_TEAMS_MAX_LEVEL=2 %libomp-run
+// RUN: env KMP_BARRIER_TUNING=2 KMP_PLAIN_BARRIER_PATTERN=dist,dist %libomp-run
+#include <stdio.h>
+#include "omp_testsuite.h"
+
+/*
+ * Online barrier tuning: a team tries every candidate pattern, the dissemination
+ * barrier among them, then keeps the fastest, which later teams of the same
+ * size reuse. Barriers must stay correct while tuning, once a pattern has been
+ * chosen, when the team size changes between regions and in nested teams.
+ */
+
+#define NBARRIERS 200 // enough to finish tuning at the largest setting
+
+int run_barriers(int nbarriers) {
+  int n = omp_get_num_threads();
+  int errors = 0;
+  int b;
+  static int slots[3][NBARRIERS];
+  int *my_slots;
+
+  // Nested teams run concurrently; each outer thread owns a row for its team
+  my_slots =
+      slots[omp_get_level() > 1 ? 1 + omp_get_ancestor_thread_num(1) : 0];
+  #pragma omp single
+  for (b = 0; b < nbarriers; b++)
+    my_slots[b] = 0;
+  for (b = 0; b < nbarriers; b++) {
+    #pragma omp atomic
+    my_slots[b]++;
+    #pragma omp barrier
+    if (my_slots[b] != n)
+      errors++;
+  }
+  return errors;
+}
+
+int test_barrier_tuning(int nthreads) {
+  int errors = 0;
+  int sum = 0;
+
+  #pragma omp parallel num_threads(nthreads) reduction(+:errors, sum)
+  {
+    errors += run_barriers(NBARRIERS);
+    sum += omp_get_thread_num();
+  }
+  return errors == 0 && sum == nthreads * (nthreads - 1) / 2;
+}
+
+int test_barrier_tuning_nested(int nthreads) {
+  int errors = 0;
+
+  #pragma omp parallel num_threads(2) reduction(+:errors)
+  {
+    int sum = 0;
+    #pragma omp parallel num_threads(nthreads) reduction(+:errors, sum)
+    {
+      errors += run_barriers(NBARRIERS);
+      sum += omp_get_thread_num();
+    }
+    if (sum != nthreads * (nthreads - 1) / 2)
+      errors++;
+    errors += run_barriers(NBARRIERS / 4);
+  }
+  return errors == 0;
+}
+
+int main() {
+  int i, n;
+  int num_failed = 0;
+
+  omp_set_dynamic(0);
+  omp_set_nested(1);
+  omp_set_max_active_levels(2);
+  for (i = 0; i < REPETITIONS; i++) {
+    // Tune for each size, then go back to sizes that are already tuned
+    for (n = 1; n <= 8; n++) {
+      if (!test_barrier_tuning(n))
+        num_failed++;
+    }
+    for (n = 8; n >= 1; n -= 3) {
+      if (!test_barrier_tuning(n))
+        num_failed++;
+    }
+    for (n = 1; n <= 4; n++) {
+      if (!test_barrier_tuning_nested(n))
+        num_failed++;
+    }
+  }
+  if (num_failed)
+    printf("failed %d\n", num_failed);
+  return num_failed;
+}
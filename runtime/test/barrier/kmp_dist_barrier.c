@@ -0,0 +1,117 @@
+// RUN: %libomp-compile
+// RUN: env KMP_PLAIN_BARRIER_PATTERN=dist,dist \
+// RUN:     KMP_FORKJOIN_BARRIER_PATTERN=dist,dist \
+// RUN:     KMP_REDUCTION_BARRIER_PATTERN=dist,dist %libomp-run
+// RUN: env KMP_PLAIN_BARRIER_PATTERN=dist,hyper \
+// RUN:     KMP_FORKJOIN_BARRIER_PATTERN=hyper,dist \
+// RUN:     KMP_REDUCTION_BARRIER_PATTERN=dist,linear %libomp-run
+// RUN: env KMP_PLAIN_BARRIER_PATTERN=dist,dist \
+// RUN:     KMP_FORKJOIN_BARRIER_PATTERN=dist,dist \
+// RUN:     OMP_WAIT_POLICY=passive %libomp-run
+// RUN: env KMP_BARRIER_TUNING=1 %libomp-run
+// RUN: env KMP_BARRIER_TUNING=2 OMP_WAIT_POLICY=passive %libomp-run
+// RUN: env KMP_FUTEX_SLEEP=1 KMP_BLOCKTIME=0 %libomp-run
+// RUN: env KMP_PLAIN_BARRIER_PATTERN=dist,dist \
+// RUN:     KMP_FORKJOIN_BARRIER_PATTERN=dist,dist \
+// RUN:     KMP_REDUCTION_BARRIER_PATTERN=dist,dist \
+// RUN:     KMP_HOT_TEAMS_MAX_LEVEL=2 %libomp-run
+#include <stdio.h>
+#include "omp_testsuite.h"
+
+/*
+ * Dissemination barrier: all threads must see the writes made before the
+ * barrier, reductions must combine every thread, and the ICVs must reach the
+ * workers, for team sizes that are and are not powers of two. Nested teams
+ * run barriers while their masters are part of the outer team.
+ */
+
+#define NBARRIERS 100
+
+int test_dist_barrier(int nthreads) {
+  int slots[NBARRIERS];
+  int errors = 0;
+  int sum = 0;
+  int i;
+
+  for (i = 0; i < NBARRIERS; i++)
+    slots[i] = 0;
+  omp_set_schedule(omp_sched_dynamic, nthreads);
+
+  #pragma omp parallel num_threads(nthreads) reduction(+:sum, errors)
+  {
+    int n = omp_get_num_threads();
+    omp_sched_t kind;
+    int chunk, b;
+
+    for (b = 0; b < NBARRIERS; b++) {
+      #pragma omp atomic
+      slots[b]++;
+      #pragma omp barrier
+      if (slots[b] != n)
+        errors++;
+    }
+    sum += omp_get_thread_num();
+    omp_get_schedule(&kind, &chunk);
+    if (kind != omp_sched_dynamic || chunk != nthreads)
+      errors++;
+  }
+  return errors == 0 && sum == nthreads * (nthreads - 1) / 2;
+}
+
+int test_dist_barrier_nested(int nthreads) {
+  int errors = 0;
+
+  #pragma omp parallel num_threads(2) reduction(+:errors)
+  {
+    int outer = omp_get_thread_num();
+    int slots[NBARRIERS];
+    int sum = 0;
+    int b;
+
+    for (b = 0; b < NBARRIERS; b++)
+      slots[b] = 0;
+    #pragma omp parallel num_threads(nthreads) shared(slots) \
+        reduction(+:sum, errors)
+    {
+      int n = omp_get_num_threads();
+      int k;
+      for (k = 0; k < NBARRIERS; k++) {
+        #pragma omp atomic
+        slots[k]++;
+        #pragma omp barrier
+        if (slots[k] != n)
+          errors++;
+      }
+      sum += omp_get_thread_num() + outer;
+    }
+    if (sum != nthreads * (nthreads - 1) / 2 + nthreads * outer)
+      errors++;
+    // The outer team meets while the inner teams are gone
+    #pragma omp barrier
+  }
+  return errors == 0;
+}
+
+int main() {
+  int i, n;
+  int num_failed = 0;
+
+  omp_set_dynamic(0);
+  for (i = 0; i < REPETITIONS; i++) {
+    for (n = 1; n <= 9; n++) {
+      if (!test_dist_barrier(n))
+        num_failed++;
+    }
+  }
+  omp_set_nested(1);
+  omp_set_max_active_levels(2);
+  for (i = 0; i < REPETITIONS; i++) {
+    for (n = 1; n <= 5; n++) {
+      if (!test_dist_barrier_nested(n))
+        num_failed++;
+    }
+  }
+  if (num_failed)
+    printf("failed %d\n", num_failed);
+  return num_failed;
+}
@@ -0,0 +1,82 @@
+// RUN: %libomp-compile
+// RUN: env KMP_FORKJOIN_BARRIER_PATTERN=linear,linear %libomp-run
+// RUN: env KMP_FORKJOIN_BARRIER_PATTERN=tree,tree %libomp-run
+// RUN: env KMP_FORKJOIN_BARRIER_PATTERN=hyper,hyper %libomp-run
+// RUN: env KMP_FORKJOIN_BARRIER_PATTERN=hierarchical,hierarchical %libomp-run
+// RUN: env KMP_FORKJOIN_BARRIER_PATTERN=hierarchical,hierarchical \
+// RUN:     KMP_BLOCKTIME=infinite %libomp-run
+#include <stdio.h>
+#include "omp_testsuite.h"
+
+/*
+ * The fork barrier hands the master's ICVs to the workers and skips the copy
+ * when they did not change since the last fork of the team. Every worker must
+ * still see the ICVs the master set right before each region: changed ones,
+ * unchanged ones, and ones set back to values of an earlier region.
+ */
+
+#define NSTEPS 12
+
+typedef struct {
+  omp_sched_t kind;
+  int chunk;
+  int dynamic;
+  int max_active_levels;
+} icvs_t;
+
+static const icvs_t steps[NSTEPS] = {
+    {omp_sched_static, 1, 0, 1},  {omp_sched_static, 1, 0, 1},
+    {omp_sched_dynamic, 4, 0, 1}, {omp_sched_dynamic, 4, 1, 1},
+    {omp_sched_dynamic, 4, 1, 3}, {omp_sched_guided, 2, 1, 3},
+    {omp_sched_guided, 2, 1, 3},  {omp_sched_static, 1, 0, 1},
+    {omp_sched_auto, 1, 0, 2},    {omp_sched_dynamic, 4, 0, 2},
+    {omp_sched_dynamic, 7, 0, 2}, {omp_sched_static, 1, 0, 1}};
+
+int test_fork_icvs(int nthreads) {
+  int errors = 0;
+  int s;
+
+  for (s = 0; s < NSTEPS; s++) {
+    const icvs_t *want = &steps[s];
+    int seen = 0;
+    omp_set_schedule(want->kind, want->chunk);
+    omp_set_dynamic(want->dynamic);
+    omp_set_max_active_levels(want->max_active_levels);
+    #pragma omp parallel num_threads(nthreads) reduction(+:errors, seen)
+    {
+      omp_sched_t kind;
+      int chunk;
+      omp_get_schedule(&kind, &chunk);
+      if (kind != want->kind || (kind != omp_sched_auto && chunk != want->chunk))
+        errors++;
+      if (omp_get_dynamic() != want->dynamic)
+        errors++;
+      if (omp_get_max_active_levels() != want->max_active_levels)
+        errors++;
+      seen++;
+    }
+    if (!seen)
+      errors++;
+  }
+  return errors == 0;
+}
+
+int main() {
+  int i, n;
+  int num_failed = 0;
+
+  for (i = 0; i < REPETITIONS; i++) {
+    // Grow, then shrink the team between the runs
+    for (n = 1; n <= 6; n++) {
+      if (!test_fork_icvs(n))
+        num_failed++;
+    }
+    for (n = 5; n >= 2; n--) {
+      if (!test_fork_icvs(n))
+        num_failed++;
+    }
+  }
+  if (num_failed)
+    printf("failed %d\n", num_failed);
+  return num_failed;
+}
@@ -0,0 +1,95 @@
+// RUN: %libomp-compile
+// RUN: env KMP_FUTEX_SLEEP=1 KMP_BLOCKTIME=0 %libomp-run
+// RUN: env KMP_FUTEX_SLEEP=1 KMP_BLOCKTIME=0 \
+// RUN:     KMP_PLAIN_BARRIER_PATTERN=hierarchical,hierarchical \
+// RUN:     KMP_FORKJOIN_BARRIER_PATTERN=hierarchical,hierarchical %libomp-run
+// RUN: env KMP_FUTEX_SLEEP=1 KMP_BLOCKTIME=0 \
+// RUN:     KMP_PLAIN_BARRIER_PATTERN=dist,dist \
+// RUN:     KMP_FORKJOIN_BARRIER_PATTERN=dist,dist %libomp-run
+// RUN: env KMP_FUTEX_SLEEP=1 KMP_BLOCKTIME=1 OMP_WAIT_POLICY=passive \
+// RUN:     %libomp-run
+// REQUIRES: linux
+#include <stdio.h>
+#include "omp_testsuite.h"
+#include "omp_my_sleep.h"
+
+/*
+ * With KMP_FUTEX_SLEEP threads sleep on the barrier flag word. With a zero
+ * blocktime the workers go to sleep as soon as they wait: at barriers one
+ * thread is late, between regions they sleep in the fork barrier, and tasks
+ * created while they sleep in a barrier wake them up without the flag they
+ * sleep on. Every barrier and task must still complete with the right
+ * results.
+ */
+
+#define NBARRIERS 20
+#define NTASKS 64
+
+int test_late_arrivals(int nthreads) {
+  int slots[NBARRIERS];
+  int errors = 0;
+  int b;
+
+  for (b = 0; b < NBARRIERS; b++)
+    slots[b] = 0;
+  #pragma omp parallel num_threads(nthreads) reduction(+:errors)
+  {
+    int n = omp_get_num_threads();
+    int k;
+    for (k = 0; k < NBARRIERS; k++) {
+      // Let the others fall asleep before the last one arrives
+      if (omp_get_thread_num() == k % n)
+        my_sleep(0.001);
+      #pragma omp atomic
+      slots[k]++;
+      #pragma omp barrier
+      if (slots[k] != n)
+        errors++;
+    }
+  }
+  return errors == 0;
+}
+
+int test_tasks_wake_sleepers(int nthreads) {
+  int done = 0;
+  int errors = 0;
+
+  #pragma omp parallel num_threads(nthreads) reduction(+:errors)
+  {
+    if (omp_get_thread_num() == 0) {
+      int i;
+      // The workers are asleep in the barrier below by now
+      my_sleep(0.01);
+      for (i = 0; i < NTASKS; i++) {
+        #pragma omp task shared(done)
+        {
+          my_sleep(0.0005);
+          #pragma omp atomic
+          done++;
+        }
+      }
+    }
+    #pragma omp barrier
+    if (done != NTASKS)
+      errors++;
+  }
+  return errors == 0;
+}
+
+int main() {
+  int i, n;
+  int num_failed = 0;
+
+  omp_set_dynamic(0);
+  for (i = 0; i < REPETITIONS; i++) {
+    for (n = 1; n <= 6; n++) {
+      if (!test_late_arrivals(n))
+        num_failed++;
+      if (!test_tasks_wake_sleepers(n))
+        num_failed++;
+    }
+  }
+  if (num_failed)
+    printf("failed %d\n", num_failed);
+  return num_failed;
+}
@@ -0,0 +1,106 @@
+// RUN: %libomp-compile-and-run
+// RUN: env KMP_BLOCKTIME=0 %libomp-run
+#include <stdio.h>
+#include "omp_testsuite.h"
+#include "omp_my_sleep.h"
+
+/*
+ * Split-phase barrier used like a halo exchange: each thread publishes its
+ * value, arrives, does work that does not depend on the others, and waits
+ * before it reads the values of its neighbours. Tasks created before arriving
+ * must have finished when the wait returns.
+ */
+
+typedef struct ident ident_t;
+#ifdef __cplusplus
+extern "C" {
+#endif
+extern int __kmpc_global_thread_num(ident_t *);
+extern void __kmpc_barrier_arrive(ident_t *, int gtid);
+extern void __kmpc_barrier_wait(ident_t *, int gtid);
+#ifdef __cplusplus
+}
+#endif
+
+#define NSTEPS 200
+#define MAX_THREADS 64
+#define NTASKS 8
+
+int test_split_barrier(int nthreads) {
+  int halo[2][MAX_THREADS];
+  int errors = 0;
+
+  #pragma omp parallel num_threads(nthreads) reduction(+:errors)
+  {
+    int gtid = __kmpc_global_thread_num(NULL);
+    int n = omp_get_num_threads();
+    int me = omp_get_thread_num();
+    int left = (me + n - 1) % n, right = (me + 1) % n;
+    int step, i;
+    volatile int interior = 0;
+
+    for (step = 0; step < NSTEPS; step++) {
+      int *buf = halo[step % 2];
+      buf[me] = me * NSTEPS + step;
+      __kmpc_barrier_arrive(NULL, gtid);
+      for (i = 0; i < (me + step) % 50; i++)
+        interior++;
+      __kmpc_barrier_wait(NULL, gtid);
+      if (buf[left] != left * NSTEPS + step ||
+          buf[right] != right * NSTEPS + step)
+        errors++;
+    }
+  }
+  return errors == 0;
+}
+
+int test_split_barrier_tasks(int nthreads) {
+  int done = 0;
+  int errors = 0;
+
+  #pragma omp parallel num_threads(nthreads) shared(done) reduction(+:errors)
+  {
+    int gtid = __kmpc_global_thread_num(NULL);
+    int n = omp_get_num_threads();
+    int step, i;
+
+    for (step = 0; step < 4; step++) {
+      for (i = 0; i < NTASKS; i++) {
+        #pragma omp task shared(done)
+        {
+          my_sleep(0.001);
+          #pragma omp atomic
+          done++;
+        }
+      }
+      __kmpc_barrier_arrive(NULL, gtid);
+      __kmpc_barrier_wait(NULL, gtid);
+      int d;
+      #pragma omp atomic read
+      d = done;
+      if (d < (step + 1) * n * NTASKS)
+        errors++;
+      __kmpc_barrier_arrive(NULL, gtid);
+      __kmpc_barrier_wait(NULL, gtid);
+    }
+  }
+  return errors == 0;
+}
+
+int main() {
+  int i, n;
+  int num_failed = 0;
+
+  omp_set_dynamic(0);
+  for (i = 0; i < REPETITIONS; i++) {
+    for (n = 1; n <= 9; n++) {
+      if (!test_split_barrier(n))
+        num_failed++;
+      if (!test_split_barrier_tasks(n))
+        num_failed++;
+    }
+  }
+  if (num_failed)
+    printf("failed %d\n", num_failed);
+  return num_failed;
+}
@@ -0,0 +1,100 @@
+// RUN: %libomp-compile
+// RUN: env KMP_LOCK_PROFILE=1 %libomp-run 2>&1 | FileCheck %s
+// RUN: env KMP_LOCK_PROFILE=1 KMP_LOCK_KIND=queuing %libomp-run 2>&1 \
+// RUN:     | FileCheck %s
+// RUN: env KMP_LOCK_PROFILE=1 KMP_CONSISTENCY_CHECK=all %libomp-run 2>&1 \
+// RUN:     | FileCheck %s
+// RUN: %libomp-run
+#include <stdio.h>
+#include <stdlib.h>
+#include "omp_testsuite.h"
+
+/*
+ * Lock contention profiler (KMP_LOCK_PROFILE): every outermost acquisition of
+ * a critical section, lock or nestable lock is counted once, both in the
+ * report printed on demand and in the one printed at exit. Destroyed locks
+ * free their entries, so creating and destroying many more distinct locks than
+ * the table holds still reports all of them. Locks that are alive at the same
+ * time and do not fit are counted as not profiled.
+ */
+
+#define NTHREADS 4
+#define NITERS 100
+#define TABLE_SIZE 4096 // KMP_LOCK_PROF_TABLE_SIZE
+#define NLOCKS (3 * TABLE_SIZE) // distinct locks, at least a table more
+
+// Distinct locks, one alive at a time, all created at the same site.
+void churn_locks(omp_lock_t *locks) {
+  int i;
+  for (i = 0; i < NLOCKS; i++) {
+    omp_init_lock(&locks[i]);
+    omp_set_lock(&locks[i]);
+    omp_unset_lock(&locks[i]);
+    omp_destroy_lock(&locks[i]);
+  }
+}
+
+// Distinct locks, all alive at the same time: more than the table holds.
+void fill_table(omp_lock_t *locks) {
+  int i;
+  for (i = 0; i < NLOCKS; i++)
+    omp_init_lock(&locks[i]);
+  for (i = 0; i < NLOCKS; i++) {
+    omp_set_lock(&locks[i]);
+    omp_unset_lock(&locks[i]);
+  }
+  for (i = 0; i < NLOCKS; i++)
+    omp_destroy_lock(&locks[i]);
+}
+
+int main() {
+  omp_lock_t *locks = (omp_lock_t *)malloc(NLOCKS * sizeof(omp_lock_t));
+  omp_lock_t lck;
+  omp_nest_lock_t nlck;
+  int sum = 0;
+
+  omp_init_lock(&lck);
+  omp_init_nest_lock(&nlck);
+  #pragma omp parallel num_threads(NTHREADS) shared(sum)
+  {
+    int i;
+    for (i = 0; i < NITERS; i++) {
+      #pragma omp critical
+      sum++;
+      omp_set_lock(&lck);
+      sum++;
+      omp_unset_lock(&lck);
+      omp_set_nest_lock(&nlck);
+      omp_set_nest_lock(&nlck);
+      sum++;
+      omp_unset_nest_lock(&nlck);
+      omp_unset_nest_lock(&nlck);
+    }
+  }
+  omp_destroy_nest_lock(&nlck);
+  omp_destroy_lock(&lck);
+  churn_locks(locks);
+  kmp_print_lock_profile();
+  fprintf(stderr, "end of parallel work\n");
+  fill_table(locks);
+  free(locks);
+  if (sum != 3 * NTHREADS * NITERS) {
+    printf("failed: sum = %d\n", sum);
+    return 1;
+  }
+  return 0;
+}
+
+// CHECK: Lock contention profile
+// CHECK-DAG: {{^}}critical 1 400
+// CHECK-DAG: {{^}}lock 1 400 {{.*}} initialized from 0x
+// CHECK-DAG: {{^}}nest_lock 1 400 {{.*}} initialized from 0x
+// CHECK-DAG: {{^}}lock 12288 12288 {{.*}} initialized from 0x
+// CHECK-NOT: not profiled
+// CHECK: end of parallel work
+// CHECK: Lock contention profile
+// CHECK-DAG: {{^}}critical 1 400
+// CHECK-DAG: {{^}}lock 1 400
+// CHECK-DAG: {{^}}nest_lock 1 400
+// CHECK-DAG: {{^}}lock 12288 12288
+// CHECK: {{^[1-9][0-9]*}} lock operations were not profiled (table full)
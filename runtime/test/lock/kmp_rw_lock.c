@@ -0,0 +1,128 @@
+// RUN: %libomp-compile-and-run
+// RUN: env KMP_CONSISTENCY_CHECK=all %libomp-run
+// RUN: env KMP_LOCK_KIND=rw %libomp-run
+#include <stdio.h>
+#include "omp_testsuite.h"
+
+/*
+ * Reader-writer lock (kmp_lock_hint_read_mostly): readers take the lock with
+ * __kmpc_set_lock_shared and must never see a half-done update of a writer;
+ * writers exclude each other and all readers. An untied task may release its
+ * shared hold on another thread than it took it on; writers must still get in
+ * afterwards.
+ */
+
+typedef struct ident ident_t;
+#ifdef __cplusplus
+extern "C" {
+#endif
+extern int __kmpc_global_thread_num(ident_t *);
+extern void __kmpc_set_lock_shared(ident_t *, int gtid, void **lock);
+extern void __kmpc_unset_lock_shared(ident_t *, int gtid, void **lock);
+#ifdef __cplusplus
+}
+#endif
+
+#define NITERS 2000
+#define NTASKS 200
+
+int test_rw_lock(omp_lock_t *lck) {
+  volatile int a = 0, b = 0;
+  int errors = 0;
+  int writes = 0;
+
+  #pragma omp parallel reduction(+:errors, writes)
+  {
+    int gtid = __kmpc_global_thread_num(NULL);
+    int i;
+    for (i = 0; i < NITERS; i++) {
+      if (i % 16 == omp_get_thread_num() % 16) {
+        omp_set_lock(lck);
+        a++;
+        b++;
+        writes++;
+        omp_unset_lock(lck);
+      } else if (i % 5 == 0) {
+        if (omp_test_lock(lck)) {
+          if (a != b)
+            errors++;
+          omp_unset_lock(lck);
+        }
+      } else {
+        __kmpc_set_lock_shared(NULL, gtid, (void **)lck);
+        if (a != b)
+          errors++;
+        __kmpc_unset_lock_shared(NULL, gtid, (void **)lck);
+      }
+    }
+  }
+  if (a != writes || b != writes)
+    errors++;
+  return errors == 0;
+}
+
+int test_rw_lock_untied(omp_lock_t *lck) {
+  volatile int a = 0, b = 0;
+  int errors = 0;
+
+  #pragma omp parallel reduction(+:errors)
+  #pragma omp single
+  {
+    int i;
+    for (i = 0; i < NTASKS; i++) {
+      #pragma omp task untied shared(errors)
+      {
+        __kmpc_set_lock_shared(NULL, __kmpc_global_thread_num(NULL),
+                               (void **)lck);
+        // Another thread may resume the task after this point
+        #pragma omp taskyield
+        if (a != b) {
+          #pragma omp atomic
+          errors++;
+        }
+        __kmpc_unset_lock_shared(NULL, __kmpc_global_thread_num(NULL),
+                                 (void **)lck);
+      }
+      if (i % 8 == 0) {
+        #pragma omp task
+        {
+          omp_set_lock(lck);
+          a++;
+          b++;
+          omp_unset_lock(lck);
+        }
+      }
+    }
+  }
+  // Would hang if a reader slot were left counted
+  omp_set_lock(lck);
+  if (a != (NTASKS + 7) / 8 || b != a)
+    errors++;
+  omp_unset_lock(lck);
+  return errors == 0;
+}
+
+int main() {
+  int i;
+  int num_failed = 0;
+  omp_lock_t lck;
+
+  omp_init_lock_with_hint(&lck, kmp_lock_hint_read_mostly);
+  for (i = 0; i < REPETITIONS; i++) {
+    if (!test_rw_lock(&lck))
+      num_failed++;
+    if (!test_rw_lock_untied(&lck))
+      num_failed++;
+  }
+  omp_destroy_lock(&lck);
+  // Shared acquisition of a lock without a shared mode is exclusive.
+  omp_init_lock(&lck);
+  for (i = 0; i < REPETITIONS; i++) {
+    if (!test_rw_lock(&lck))
+      num_failed++;
+  }
+  omp_destroy_lock(&lck);
+  if (num_failed)
+    printf("failed %d\n", num_failed);
+  return num_failed;
+}
@@ -1,6 +1,12 @@
 // RUN: %libomp-compile-and-run
 // RUN: env KMP_LOCK_KIND=tas KMP_SPIN_BACKOFF_PARAMS=2048,200 %libomp-run
 // RUN: env KMP_LOCK_KIND=futex %libomp-run
+// RUN: env KMP_LOCK_KIND=cohort %libomp-run
+// RUN: env KMP_LOCK_KIND=cohort KMP_COHORT_LOCK_BATCH=1 %libomp-run
+// RUN: env KMP_LOCK_KIND=rw %libomp-run
+// RUN: env KMP_LOCK_KIND=morph %libomp-run
+// RUN: env KMP_LOCK_KIND=morph KMP_MORPH_LOCK_UPGRADE=1 \
+// RUN:     KMP_MORPH_LOCK_DOWNGRADE=4 %libomp-run
 #include <stdio.h>
 #include "omp_testsuite.h"
 
@@ -0,0 +1,76 @@
+// RUN: %libomp-compile
+// RUN: env KMP_HOT_TEAMS_ADAPTIVE=2 KMP_HOT_TEAMS_BUDGET=64 %libomp-run
+// RUN: env KMP_HOT_TEAMS_ADAPTIVE=1 KMP_HOT_TEAMS_MODE=1 \
+// RUN:     KMP_HOT_TEAMS_BUDGET=64 %libomp-run
+// RUN: env KMP_HOT_TEAMS_ADAPTIVE=2 KMP_HOT_TEAMS_BUDGET=5 %libomp-run
+// RUN: env KMP_HOT_TEAMS_ADAPTIVE=2 KMP_HOT_TEAMS_BUDGET=64 \
+// RUN:     KMP_FORKJOIN_BARRIER_PATTERN=dist,dist \
+// RUN:     KMP_PLAIN_BARRIER_PATTERN=dist,dist %libomp-run
+// RUN: env KMP_HOT_TEAMS_MAX_LEVEL=3 KMP_FORKJOIN_BARRIER_PATTERN=dist,dist \
+// RUN:     %libomp-run
+#include <stdio.h>
+#include "omp_testsuite.h"
+
+/*
+ * Adaptive hot teams: nested teams kept hot after repeated forks must behave
+ * like freshly allocated ones, also when the inner team grows beyond the
+ * budget and loses its hot team.
+ */
+
+#define NITERS 200
+
+int test_hot_teams_adaptive() {
+  int errors = 0;
+  int it;
+
+  omp_set_dynamic(0);
+  omp_set_nested(1);
+  omp_set_max_active_levels(3);
+  for (it = 0; it < NITERS; it++) {
+    int inner = (it % 10 == 9) ? 4 : 3;
+    #pragma omp parallel num_threads(2) reduction(+:errors)
+    {
+      int outer_tid = omp_get_thread_num();
+      #pragma omp parallel num_threads(inner) reduction(+:errors)
+      {
+        int mid_tid = omp_get_thread_num();
+        int count = 0;
+        if (omp_get_num_threads() != inner)
+          errors++;
+        #pragma omp parallel num_threads(2) reduction(+:errors, count)
+        {
+          if (omp_get_level() != 3 || omp_get_active_level() != 3)
+            errors++;
+          if (omp_get_ancestor_thread_num(1) != outer_tid ||
+              omp_get_ancestor_thread_num(2) != mid_tid)
+            errors++;
+          #pragma omp task shared(errors)
+          {
+            if (omp_get_level() != 3) {
+              #pragma omp atomic
+              errors++;
+            }
+          }
+          #pragma omp barrier
+          count++;
+        }
+        if (count != 2)
+          errors++;
+      }
+    }
+  }
+  return errors == 0;
+}
+
+int main() {
+  int i;
+  int num_failed = 0;
+
+  for (i = 0; i < REPETITIONS; i++) {
+    if (!test_hot_teams_adaptive())
+      num_failed++;
+  }
+  if (num_failed)
+    printf("failed %d\n", num_failed);
+  return num_failed;
+}
@@ -0,0 +1,55 @@
+// RUN: %libomp-compile
+// RUN: env KMP_SPAWN_BRANCH=0 %libomp-run
+// RUN: env KMP_SPAWN_BRANCH=1 %libomp-run
+// RUN: env KMP_SPAWN_BRANCH=4 %libomp-run
+// RUN: env KMP_SPAWN_BRANCH=2 KMP_PRESPAWN=1 OMP_NUM_THREADS=12 %libomp-run
+#include <stdio.h>
+#include "omp_testsuite.h"
+
+/*
+ * Workers created by other workers (KMP_SPAWN_BRANCH) or ahead of the first
+ * parallel region (KMP_PRESPAWN) must all join their teams, also when the
+ * teams grow and shrink and when nested teams create threads concurrently.
+ */
+
+int test_spawn_branch(int rep) {
+  int errors = 0;
+  int r;
+
+  omp_set_dynamic(0);
+  omp_set_nested(1);
+  omp_set_max_active_levels(2);
+  for (r = 0; r < 20; r++) {
+    int n = 1 + (r * 7 + rep) % 24;
+    int count = 0;
+    #pragma omp parallel num_threads(n) reduction(+:count)
+    {
+      count++;
+      #pragma omp barrier
+    }
+    if (count != n)
+      errors++;
+  }
+  #pragma omp parallel num_threads(3) reduction(+:errors)
+  {
+    int count = 0;
+    #pragma omp parallel num_threads(5) reduction(+:count)
+    count++;
+    if (count != 5)
+      errors++;
+  }
+  return errors == 0;
+}
+
+int main() {
+  int i;
+  int num_failed = 0;
+
+  for (i = 0; i < REPETITIONS; i++) {
+    if (!test_spawn_branch(i))
+      num_failed++;
+  }
+  if (num_failed)
+    printf("failed %d\n", num_failed);
+  return num_failed;
+}
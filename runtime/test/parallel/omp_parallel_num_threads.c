@@ -1,4 +1,5 @@
-// RUN: %libomp-compile-and-run
+// RUN: %libomp-compile && %libomp-run
+// RUN: env KMP_NUMA_LOCAL_STATE=1 OMP_PROC_BIND=close %libomp-run
 #include <stdio.h>
 #include "omp_testsuite.h"
 
@@ -0,0 +1,49 @@
+// RUN: %libomp-compile && env KMP_TASK_CONTINUATION=1 %libomp-run
+// RUN: env KMP_TASK_CONTINUATION=1 KMP_TASK_DEQUE_LOCKFREE=1 %libomp-run
+// RUN: env KMP_TASK_CONTINUATION=0 %libomp-run
+#include <stdio.h>
+#include <omp.h>
+
+/*
+ * Pipelines of dependent tasks: one task releases the first stage of every
+ * chain at once, then each stage of a chain is released by the one before
+ * it. With continuations, the thread finishing a task runs one successor
+ * itself while the remaining successors stay stealable.
+ */
+
+#define NUM_CHAINS 64
+#define NUM_STAGES 50
+
+int start, data[NUM_CHAINS];
+
+int main() {
+  int i, j, errors = 0;
+
+  #pragma omp parallel
+  #pragma omp single
+  {
+    #pragma omp task depend(out: start)
+    start = 1;
+    for (i = 0; i < NUM_CHAINS; i++) {
+      #pragma omp task depend(in: start) depend(out: data[i]) firstprivate(i)
+      data[i] = start;
+      for (j = 1; j < NUM_STAGES; j++) {
+        #pragma omp task depend(inout: data[i]) firstprivate(i, j)
+        {
+          if (data[i] == j)
+            data[i]++;
+        }
+      }
+    }
+  }
+
+  for (i = 0; i < NUM_CHAINS; i++)
+    if (data[i] != NUM_STAGES)
+      errors++;
+  if (errors) {
+    printf("failed: %d chains out of order\n", errors);
+    return 1;
+  }
+  printf("passed\n");
+  return 0;
+}
@@ -0,0 +1,79 @@
+// RUN: %libomp-compile && env KMP_TASK_DEQUE_LOCKFREE=1 %libomp-run
+// RUN: env KMP_TASK_DEQUE_LOCKFREE=0 %libomp-run
+#include <stdio.h>
+#include <omp.h>
+#include "omp_my_sleep.h"
+
+/*
+ * A single producer creates many more tasks than fit in the initial task
+ * deque while the other threads steal them, so the lock-free deque has to
+ * grow under concurrent stealing, up to its limit, after which the tasks run
+ * immediately. Tasks with a mutexinoutset dependence are taken from the same
+ * deques and must still never overlap.
+ */
+
+#define NUM_TASKS 100000
+#define NUM_MTX_TASKS 1000
+
+int mtx, inside, overlaps;
+
+static int fib(int n) {
+  int a, b;
+  if (n < 2)
+    return n;
+  #pragma omp task shared(a)
+  a = fib(n - 1);
+  #pragma omp task shared(b)
+  b = fib(n - 2);
+  #pragma omp taskwait
+  return a + b;
+}
+
+int main() {
+  int i, count = 0, f = 0;
+
+  #pragma omp parallel
+  {
+    #pragma omp single
+    {
+      for (i = 0; i < NUM_TASKS; i++) {
+        #pragma omp task shared(count)
+        {
+          #pragma omp atomic
+          count++;
+        }
+      }
+    }
+  }
+
+  #pragma omp parallel
+  #pragma omp single
+  f = fib(20);
+
+  #pragma omp parallel
+  #pragma omp single
+  for (i = 0; i < NUM_MTX_TASKS; i++) {
+    #pragma omp task depend(mutexinoutset: mtx)
+    {
+      int v;
+      #pragma omp atomic capture
+      v = ++inside;
+      if (v != 1) {
+        #pragma omp atomic
+        overlaps++;
+      }
+      mtx++;
+      my_sleep(0.0001);
+      #pragma omp atomic
+      inside--;
+    }
+  }
+
+  if (count != NUM_TASKS || f != 6765 || mtx != NUM_MTX_TASKS || overlaps) {
+    printf("failed: count = %d, fib(20) = %d, mtx = %d, overlaps = %d\n",
+           count, f, mtx, overlaps);
+    return 1;
+  }
+  printf("passed\n");
+  return 0;
+}
@@ -0,0 +1,140 @@
+// RUN: %libomp-compile-and-run
+#include <stdio.h>
+#include <omp.h>
+#include "omp_my_sleep.h"
+
+/*
+ * A region that creates the same tasks with the same dependences on every
+ * iteration is recorded once and replayed afterwards. Some iterations create
+ * fewer tasks or different dependences than recorded, including the same
+ * number of dependences on other addresses; the result must match the serial
+ * computation in all cases. The second region records a graph without edges,
+ * then once orders its tasks with dependences of the same number: they must
+ * not be replayed from the recording. The third region records mutexinoutset
+ * tasks, which must not overlap in any iteration.
+ */
+
+typedef struct ident ident_t;
+#ifdef __cplusplus
+extern "C" {
+#endif
+extern int __kmpc_global_thread_num(ident_t *);
+extern int __kmpc_start_record_task(ident_t *, int, int, int);
+extern void __kmpc_end_record_task(ident_t *, int, int, int);
+#ifdef __cplusplus
+}
+#endif
+
+#define NB 32
+#define ITERS 100
+
+double A[NB], R[NB];
+int C[NB], done[NB];
+int M, inside;
+
+static void step(double *a, int b, int d) {
+  double l = b >= d ? a[b - d] : 0.0;
+  double r = b < NB - d ? a[b + d] : 0.0;
+  a[b] = 0.5 * a[b] + 0.25 * (l + r) + 1.0;
+}
+
+// iteration 30 creates fewer tasks, iteration 60 has one more dependence
+static int nblocks(int it) { return it == 30 ? NB / 2 : NB; }
+// iteration 80 reads other neighbors
+static int dist(int it) { return it == 80 ? 2 : 1; }
+
+int main() {
+  int it, b, errors = 0;
+
+  for (b = 0; b < NB; b++)
+    A[b] = R[b] = b;
+  for (it = 0; it < ITERS; it++)
+    for (b = 0; b < nblocks(it); b++)
+      step(R, b, dist(it));
+
+  #pragma omp parallel
+  #pragma omp single
+  for (it = 0; it < ITERS; it++) {
+    int gtid = __kmpc_global_thread_num(NULL);
+    __kmpc_start_record_task(NULL, gtid, 0, 1);
+    int d = dist(it);
+    for (b = 0; b < nblocks(it); b++) {
+      int l = b >= d ? b - d : b;
+      int r = b < NB - d ? b + d : b;
+      if (it == 60 && b == NB / 2) {
+        #pragma omp task depend(inout: A[b]) depend(in: A[l], A[r], A[0]) \
+            firstprivate(b, d)
+        step(A, b, d);
+      } else {
+        #pragma omp task depend(inout: A[b]) depend(in: A[l], A[r]) \
+            firstprivate(b, d)
+        step(A, b, d);
+      }
+    }
+    __kmpc_end_record_task(NULL, gtid, 0, 1);
+  }
+
+  #pragma omp parallel
+  #pragma omp single
+  for (it = 0; it < 10; it++) {
+    int gtid = __kmpc_global_thread_num(NULL);
+    int chain = it == 5;
+    for (b = 0; b < NB; b++)
+      done[b] = 0;
+    __kmpc_start_record_task(NULL, gtid, 0, 2);
+    for (b = 0; b < NB; b++) {
+      int p = chain && b > 0 ? b - 1 : b;
+      #pragma omp task depend(inout: C[b]) depend(in: C[p]) firstprivate(b, p)
+      {
+        int d;
+        #pragma omp atomic read
+        d = done[p];
+        if (p != b && !d) {
+          #pragma omp atomic
+          errors++;
+        }
+        #pragma omp atomic write
+        done[b] = 1;
+      }
+    }
+    __kmpc_end_record_task(NULL, gtid, 0, 2);
+  }
+  if (errors)
+    printf("failed: tasks ran out of dependence order\n");
+
+  #pragma omp parallel
+  #pragma omp single
+  for (it = 0; it < 10; it++) {
+    int gtid = __kmpc_global_thread_num(NULL);
+    __kmpc_start_record_task(NULL, gtid, 0, 3);
+    for (b = 0; b < 8; b++) {
+      #pragma omp task depend(mutexinoutset: M)
+      {
+        int v;
+        #pragma omp atomic capture
+        v = ++inside;
+        if (v != 1) {
+          #pragma omp atomic
+          errors++;
+        }
+        my_sleep(0.001);
+        #pragma omp atomic
+        inside--;
+      }
+    }
+    __kmpc_end_record_task(NULL, gtid, 0, 3);
+  }
+  if (errors)
+    printf("failed: mutexinoutset tasks overlapped\n");
+
+  for (b = 0; b < NB; b++) {
+    if (A[b] != R[b]) {
+      printf("failed: A[%d] = %g, expected %g\n", b, A[b], R[b]);
+      errors++;
+    }
+  }
+  if (errors)
+    return 1;
+  printf("passed\n");
+  return 0;
+}
@@ -0,0 +1,43 @@
+// RUN: %libomp-compile && env KMP_TASK_STEAL_POLICY=hierarchical %libomp-run
+// RUN: env KMP_TASK_STEAL_POLICY=hierarchical KMP_TASK_DEQUE_LOCKFREE=1 %libomp-run
+// RUN: env KMP_TASK_STEAL_POLICY=random %libomp-run
+#include <stdio.h>
+#include <omp.h>
+
+/*
+ * Tasks created by one thread must be stolen by the others, with victims
+ * picked level by level in the machine hierarchy. Different team sizes give
+ * hierarchy groups that are only partially filled.
+ */
+
+#define NUM_TASKS 10000
+
+int main() {
+  int nthreads, errors = 0;
+
+  for (nthreads = 2; nthreads <= 8; nthreads += 3) {
+    int i, count = 0;
+    #pragma omp parallel num_threads(nthreads)
+    {
+      #pragma omp single
+      {
+        for (i = 0; i < NUM_TASKS; i++) {
+          #pragma omp task shared(count)
+          {
+            #pragma omp atomic
+            count++;
+          }
+        }
+      }
+    }
+    if (count != NUM_TASKS) {
+      printf("failed with %d threads: count = %d\n", nthreads, count);
+      errors++;
+    }
+  }
+
+  if (errors)
+    return 1;
+  printf("passed\n");
+  return 0;
+}
@@ -0,0 +1,225 @@
+// RUN: %libomp-compile-and-run
+#include <stdio.h>
+#include <omp.h>
+#include "omp_my_sleep.h"
+
+/*
+ * Mutexinoutset and inoutset dependences, set up through the runtime
+ * interface as a compiler would. Mutexinoutset tasks on an address must not
+ * overlap but come after the preceding writer; inoutset tasks come after all
+ * of them, and readers after all inoutset tasks.
+ *
+ * Then a mutexinoutset task yields until an untied task releases more tasks of
+ * the same set than a task deque holds: the thread that holds the lock may run
+ * the untied task and must not wait for the lock itself.
+ */
+
+// Compiler-generated code (emulation)
+typedef long kmp_intptr_t;
+typedef int kmp_int32;
+
+typedef char bool;
+
+typedef struct ident {
+  kmp_int32 reserved_1;
+  kmp_int32 flags;
+  kmp_int32 reserved_2;
+  kmp_int32 reserved_3;
+  char const *psource;
+} ident_t;
+
+typedef struct kmp_depend_info {
+  kmp_intptr_t base_addr;
+  size_t len;
+  struct {
+    bool in : 1;
+    bool out : 1;
+    bool mtx : 1;
+    bool set : 1;
+  } flags;
+} kmp_depend_info_t;
+
+struct kmp_task;
+typedef kmp_int32 (*kmp_routine_entry_t)(kmp_int32, struct kmp_task *);
+
+typedef struct kmp_task {
+  void *shareds;
+  kmp_routine_entry_t routine;
+  kmp_int32 part_id;
+} kmp_task_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+kmp_int32 __kmpc_global_thread_num(ident_t *);
+kmp_task_t *__kmpc_omp_task_alloc(ident_t *loc_ref, kmp_int32 gtid,
+                                  kmp_int32 flags, size_t sizeof_kmp_task_t,
+                                  size_t sizeof_shareds,
+                                  kmp_routine_entry_t task_entry);
+kmp_int32 __kmpc_omp_taskyield(ident_t *loc_ref, kmp_int32 gtid, int end_part);
+kmp_int32 __kmpc_omp_task_with_deps(ident_t *loc_ref, kmp_int32 gtid,
+                                    kmp_task_t *new_task, kmp_int32 ndeps,
+                                    kmp_depend_info_t *dep_list,
+                                    kmp_int32 ndeps_noalias,
+                                    kmp_depend_info_t *noalias_dep_list);
+#ifdef __cplusplus
+}
+#endif
+
+#define NMTX 8
+#define NSET 4
+#define NIN 4
+#define NMANY 600 // more than a task deque holds
+
+int x, y;
+int value, inside, set_done, in_done, errors;
+int released;
+
+// User's code
+kmp_int32 writer(kmp_int32 gtid, kmp_task_t *task) {
+  my_sleep(0.02);
+  value = 100;
+  return 0;
+}
+
+kmp_int32 mutex_update(kmp_int32 gtid, kmp_task_t *task) {
+  int v;
+  #pragma omp atomic capture
+  v = ++inside;
+  if (v != 1 || value < 100) {
+    #pragma omp atomic
+    errors++;
+  }
+  v = value;
+  my_sleep(0.001);
+  value = v + 1;
+  #pragma omp atomic
+  inside--;
+  return 0;
+}
+
+kmp_int32 set_update(kmp_int32 gtid, kmp_task_t *task) {
+  if (value != 100 + NMTX) {
+    #pragma omp atomic
+    errors++;
+  }
+  my_sleep(0.005);
+  #pragma omp atomic
+  set_done++;
+  return 0;
+}
+
+kmp_int32 reader(kmp_int32 gtid, kmp_task_t *task) {
+  if (set_done != NSET) {
+    #pragma omp atomic
+    errors++;
+  }
+  #pragma omp atomic
+  in_done++;
+  return 0;
+}
+
+kmp_int32 yielding_update(kmp_int32 gtid, kmp_task_t *task) {
+  int v;
+  #pragma omp atomic capture
+  v = ++inside;
+  if (v != 1) {
+    #pragma omp atomic
+    errors++;
+  }
+  while (1) {
+    #pragma omp atomic read
+    v = released;
+    if (v)
+      break;
+    __kmpc_omp_taskyield(NULL, gtid, 0);
+  }
+  value++;
+  #pragma omp atomic
+  inside--;
+  return 0;
+}
+
+kmp_int32 releaser(kmp_int32 gtid, kmp_task_t *task) {
+  my_sleep(0.01);
+  #pragma omp atomic write
+  released = 1;
+  return 0;
+}
+
+static void spawn_deps(kmp_int32 gtid, kmp_routine_entry_t entry, int tied,
+                       int ndeps, kmp_depend_info_t *deps) {
+  kmp_task_t *task =
+      __kmpc_omp_task_alloc(NULL, gtid, tied, sizeof(kmp_task_t), 0, entry);
+  __kmpc_omp_task_with_deps(NULL, gtid, task, ndeps, deps, 0, NULL);
+}
+
+static void set_dep(kmp_depend_info_t *dep, int *addr, int in, int out,
+                    int mtx, int set) {
+  dep->base_addr = (kmp_intptr_t)addr;
+  dep->len = sizeof(*addr);
+  dep->flags.in = in;
+  dep->flags.out = out;
+  dep->flags.mtx = mtx;
+  dep->flags.set = set;
+}
+
+static void spawn(kmp_int32 gtid, kmp_routine_entry_t entry, int in, int out,
+                  int mtx, int set) {
+  kmp_depend_info_t dep;
+  set_dep(&dep, &x, in, out, mtx, set);
+  spawn_deps(gtid, entry, 1, 1, &dep);
+}
+
+int main() {
+  int rep, i;
+
+  for (rep = 0; rep < 5; rep++) {
+    value = 0;
+    set_done = 0;
+    in_done = 0;
+    #pragma omp parallel num_threads(4)
+    #pragma omp single
+    {
+      kmp_int32 gtid = __kmpc_global_thread_num(NULL);
+      spawn(gtid, writer, 1, 1, 0, 0);
+      for (i = 0; i < NMTX; i++)
+        spawn(gtid, mutex_update, 0, 0, 1, 0);
+      for (i = 0; i < NSET; i++)
+        spawn(gtid, set_update, 0, 0, 0, 1);
+      for (i = 0; i < NIN; i++)
+        spawn(gtid, reader, 1, 0, 0, 0);
+      #pragma omp taskwait
+    }
+    if (value != 100 + NMTX || in_done != NIN)
+      errors++;
+  }
+
+  for (rep = 0; rep < 5; rep++) {
+    value = 100; // as if after the writer, for mutex_update
+    released = 0;
+    #pragma omp parallel num_threads(4)
+    #pragma omp single
+    {
+      kmp_int32 gtid = __kmpc_global_thread_num(NULL);
+      kmp_depend_info_t deps[2];
+      set_dep(&deps[0], &y, 1, 1, 0, 0);
+      spawn_deps(gtid, releaser, 0, 1, deps); // untied
+      set_dep(&deps[0], &x, 0, 0, 1, 0);
+      spawn_deps(gtid, yielding_update, 1, 1, deps);
+      set_dep(&deps[1], &y, 1, 0, 0, 0);
+      for (i = 0; i < NMANY; i++)
+        spawn_deps(gtid, mutex_update, 1, 2, deps);
+      #pragma omp taskwait
+    }
+    if (value != 100 + NMANY + 1)
+      errors++;
+  }
+
+  if (errors) {
+    printf("failed: %d errors\n", errors);
+    return 1;
+  }
+  printf("passed\n");
+  return 0;
+}
@@ -0,0 +1,68 @@
+// RUN: %libomp-compile && env KMP_TASK_RANGE_DEPS=1 %libomp-run
+// GCC only passes the start address of an array section to the runtime.
+// UNSUPPORTED: gcc
+#include <stdio.h>
+#include <omp.h>
+#include "omp_my_sleep.h"
+
+/*
+ * Dependences on overlapping array sections with different base addresses.
+ * A task writing the whole array must be waited for by every block task, the
+ * blocks shifted by half a block overlap two of the others, and a final task
+ * reading the whole array must see all of them.
+ */
+
+#define N 1024
+#define B 64
+
+int A[N];
+
+int main() {
+  int rep, i, errors = 0;
+
+  #pragma omp parallel
+  #pragma omp single
+  for (rep = 0; rep < 3; rep++) {
+    long sum = -1;
+    #pragma omp task depend(out: A[0:N])
+    {
+      int k;
+      my_sleep(0.01);
+      for (k = 0; k < N; k++)
+        A[k] = 1;
+    }
+    for (i = 0; i < N / B; i++) {
+      #pragma omp task depend(inout: A[i * B:B]) firstprivate(i)
+      {
+        int k;
+        for (k = i * B; k < (i + 1) * B; k++)
+          A[k]++;
+      }
+    }
+    for (i = 0; i < N / B - 1; i++) {
+      #pragma omp task depend(inout: A[i * B + B / 2:B]) firstprivate(i)
+      {
+        int k;
+        for (k = i * B + B / 2; k < (i + 1) * B + B / 2; k++)
+          A[k]++;
+      }
+    }
+    #pragma omp task depend(in: A[0:N]) shared(sum)
+    {
+      int k;
+      sum = 0;
+      for (k = 0; k < N; k++)
+        sum += A[k];
+    }
+    #pragma omp taskwait
+    if (sum != 2 * N + N - B) {
+      printf("failed: sum = %ld, expected %d\n", sum, 2 * N + N - B);
+      errors++;
+    }
+  }
+
+  if (errors)
+    return 1;
+  printf("passed\n");
+  return 0;
+}
@@ -0,0 +1,44 @@
+// RUN: %libomp-compile-and-run
+#include <stdio.h>
+#include <omp.h>
+
+/*
+ * Chains of dependent tasks on many more distinct addresses than the initial
+ * dependence hash has buckets, so that it grows while the chains are built.
+ * Every task in a chain must see the update of the previous one.
+ */
+
+#define NUM_ADDRS 20000
+#define CHAIN_LEN 4
+
+int data[NUM_ADDRS];
+
+int main() {
+  int i, j, errors = 0;
+
+  #pragma omp parallel
+  #pragma omp single
+  {
+    for (j = 0; j < CHAIN_LEN; j++) {
+      for (i = 0; i < NUM_ADDRS; i++) {
+        #pragma omp task depend(inout: data[i]) firstprivate(i, j)
+        {
+          if (data[i] != j)
+            data[i] = -1;
+          else
+            data[i] = j + 1;
+        }
+      }
+    }
+  }
+
+  for (i = 0; i < NUM_ADDRS; i++)
+    if (data[i] != CHAIN_LEN)
+      errors++;
+  if (errors) {
+    printf("failed: %d chains out of order\n", errors);
+    return 1;
+  }
+  printf("passed\n");
+  return 0;
+}
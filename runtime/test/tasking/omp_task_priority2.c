@@ -0,0 +1,62 @@
+// RUN: %libomp-compile && env OMP_MAX_TASK_PRIORITY=9 %libomp-run
+// RUN: env OMP_MAX_TASK_PRIORITY=9 KMP_TASK_DEQUE_LOCKFREE=1 %libomp-run
+// Test that tasks with a higher priority are scheduled before those with a
+// lower priority, once they are all queued.
+#include <stdio.h>
+#include <omp.h>
+
+#define NUM_LOW 200
+#define NUM_HIGH 10
+
+int main(void) {
+  int i, nthreads = 0, failed = 0;
+  int order = 0, ready = 0;
+  int high_order[NUM_HIGH];
+
+  #pragma omp parallel num_threads(4)
+  {
+    #pragma omp single
+    {
+      nthreads = omp_get_num_threads();
+      // Low priority tasks first, so that they are older than the others
+      for (i = 0; i < NUM_LOW; i++) {
+        #pragma omp task priority(0)
+        {
+          int r;
+          do {
+            #pragma omp atomic read
+            r = ready;
+          } while (!r);
+          #pragma omp atomic
+          order++;
+        }
+      }
+      for (i = 0; i < NUM_HIGH; i++) {
+        int myi = i;
+        #pragma omp task priority(9) firstprivate(myi)
+        {
+          #pragma omp atomic capture
+          high_order[myi] = order++;
+        }
+      }
+      #pragma omp atomic write
+      ready = 1;
+    }
+  }
+
+  // Only low priority tasks already started before all tasks were queued may
+  // run ahead of the high priority ones
+  for (i = 0; i < NUM_HIGH; i++) {
+    if (high_order[i] >= NUM_HIGH + nthreads) {
+      printf("high priority task %d executed at position %d\n", i,
+             high_order[i]);
+      failed = 1;
+    }
+  }
+  if (failed) {
+    printf("failed\n");
+    return 1;
+  }
+  printf("passed\n");
+  return 0;
+}